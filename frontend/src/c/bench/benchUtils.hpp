@@ -0,0 +1,31 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+
+namespace kayo {
+namespace bench {
+
+using Clock = std::chrono::steady_clock;
+
+inline double millisecondsSince(Clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/**
+ * The argument at index or the fallback if it is missing.
+ */
+inline uint32_t argument(int argc, char** argv, int index, uint32_t fallback) {
+	return index < argc ? uint32_t(std::strtoul(argv[index], nullptr, 10)) : fallback;
+}
+
+/**
+ * Keeps the compiler from dropping a computation whose result is unused.
+ */
+template <typename T>
+inline void keep(const T& value) {
+	asm volatile("" : : "g"(&value) : "memory");
+}
+
+} // namespace bench
+} // namespace kayo
\ No newline at end of file
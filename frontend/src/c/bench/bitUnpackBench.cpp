@@ -0,0 +1,77 @@
+#include "benchUtils.hpp"
+#include "minecraft/bitUnpack.hpp"
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace kayo;
+using namespace kayo::minecraft;
+
+static std::vector<uint64_t> pack(const std::vector<uint16_t>& indices, uint8_t bits, PackedLayout layout) {
+	std::vector<uint64_t> data(packedLongCount(bits, layout, uint32_t(indices.size())));
+	uint32_t perLong = 64u / bits;
+	for (size_t i = 0; i < indices.size(); i++) {
+		uint64_t value = indices[i];
+		if (layout == PackedLayout::Padded) {
+			data[i / perLong] |= value << (i % perLong * bits);
+			continue;
+		}
+		uint64_t bit = uint64_t(i) * bits;
+		data[bit / 64] |= value << (bit % 64);
+		if (bit % 64 + bits > 64)
+			data[bit / 64 + 1] |= value >> (64 - bit % 64);
+	}
+	return data;
+}
+
+/**
+ * Times {@link unpackIndices} against {@link unpackIndicesScalar} on block state sections of 4096 indices
+ * for the widths 4 to 15 in both layouts, which covers every palette size of a block section.
+ * Usage: bitUnpackBench [sections] [repeats]
+ */
+int main(int argc, char** argv) {
+	uint32_t sections = bench::argument(argc, argv, 1, 256);
+	uint32_t repeats = bench::argument(argc, argv, 2, 20);
+	constexpr uint32_t count = 4096;
+
+	std::mt19937 random(5);
+	std::vector<uint16_t> scalar(count), simd(count);
+	std::printf("bits layout  scalar ns  simd ns  speedup  (per section)\n");
+	for (uint8_t bits = 4; bits <= 15; bits++) {
+		for (PackedLayout layout : {PackedLayout::Padded, PackedLayout::Tight}) {
+			std::vector<std::vector<uint64_t>> packed(sections);
+			for (std::vector<uint64_t>& data : packed) {
+				std::vector<uint16_t> indices(count);
+				for (uint16_t& index : indices)
+					index = uint16_t(random() & ((1u << bits) - 1));
+				data = pack(indices, bits, layout);
+			}
+
+			bench::Clock::time_point start = bench::Clock::now();
+			for (uint32_t r = 0; r < repeats; r++) {
+				for (const std::vector<uint64_t>& data : packed) {
+					unpackIndicesScalar(data.data(), bits, layout, scalar.data(), 0, count);
+					bench::keep(scalar);
+				}
+			}
+			double scalarTime = bench::millisecondsSince(start);
+
+			start = bench::Clock::now();
+			for (uint32_t r = 0; r < repeats; r++) {
+				for (const std::vector<uint64_t>& data : packed) {
+					unpackIndices(data.data(), bits, layout, simd.data(), count);
+					bench::keep(simd);
+				}
+			}
+			double simdTime = bench::millisecondsSince(start);
+
+			if (scalar != simd) {
+				std::printf("%u bit %s unpacking differs from the scalar version\n", bits, layout == PackedLayout::Padded ? "padded" : "tight");
+				return 1;
+			}
+			double perSection = 1e6 / (double(sections) * repeats);
+			std::printf("%4u %-6s %10.1f %8.1f %7.1fx\n", bits, layout == PackedLayout::Padded ? "padded" : "tight", scalarTime * perSection, simdTime * perSection, scalarTime / simdTime);
+		}
+	}
+	return 0;
+}
\ No newline at end of file
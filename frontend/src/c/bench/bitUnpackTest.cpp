@@ -0,0 +1,61 @@
+#include "minecraft/bitUnpack.hpp"
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace kayo::minecraft;
+
+/**
+ * Packs random indices of every width and layout and checks that {@link unpackIndices} matches {@link unpackIndicesScalar}
+ * for the sizes of block state and biome sections, odd counts and unaligned sources.
+ */
+static std::vector<uint64_t> pack(const std::vector<uint16_t>& indices, uint8_t bits, PackedLayout layout) {
+	std::vector<uint64_t> data(packedLongCount(bits, layout, uint32_t(indices.size())));
+	uint32_t perLong = 64u / bits;
+	for (size_t i = 0; i < indices.size(); i++) {
+		uint64_t value = indices[i];
+		if (layout == PackedLayout::Padded) {
+			data[i / perLong] |= value << (i % perLong * bits);
+			continue;
+		}
+		uint64_t bit = uint64_t(i) * bits;
+		data[bit / 64] |= value << (bit % 64);
+		if (bit % 64 + bits > 64)
+			data[bit / 64 + 1] |= value >> (64 - bit % 64);
+	}
+	return data;
+}
+
+int main() {
+	std::mt19937 random(11);
+	const uint32_t counts[] = {0, 1, 7, 63, 64, 65, 255, 4096, 4097};
+	uint32_t failures = 0;
+	uint32_t checked = 0;
+	for (uint8_t bits = 1; bits <= 16; bits++) {
+		for (PackedLayout layout : {PackedLayout::Padded, PackedLayout::Tight}) {
+			for (uint32_t count : counts) {
+				std::vector<uint16_t> indices(count);
+				for (uint16_t& index : indices)
+					index = uint16_t(random() & ((1u << bits) - 1));
+				std::vector<uint64_t> packed = pack(indices, bits, layout);
+
+				// Copy the longs one byte past an 8 byte boundary, the kernels must not rely on alignment.
+				std::vector<uint8_t> unaligned(packed.size() * 8 + 8);
+				std::memcpy(unaligned.data() + 1, packed.data(), packed.size() * 8);
+				const uint64_t* data = reinterpret_cast<const uint64_t*>(unaligned.data() + 1);
+
+				std::vector<uint16_t> scalar(count), simd(count);
+				unpackIndicesScalar(packed.data(), bits, layout, scalar.data(), 0, count);
+				unpackIndices(data, bits, layout, simd.data(), count);
+				checked++;
+				if (scalar != indices || simd != indices) {
+					failures++;
+					std::printf("%s layout with %u bits and %u indices: scalar %s, simd %s\n", layout == PackedLayout::Padded ? "padded" : "tight", bits, count, scalar == indices ? "ok" : "wrong", simd == indices ? "ok" : "wrong");
+				}
+			}
+		}
+	}
+	std::printf("%u of %u unpack cases correct\n", checked - failures, checked);
+	return failures == 0 ? 0 : 1;
+}
\ No newline at end of file
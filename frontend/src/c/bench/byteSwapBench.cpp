@@ -0,0 +1,89 @@
+#include "benchUtils.hpp"
+#include "utils/byteSwap.hpp"
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace kayo;
+
+#if defined(__AVX2__)
+static const char* simdPath = "avx2";
+#elif defined(__SSSE3__)
+static const char* simdPath = "ssse3";
+#else
+static const char* simdPath = "scalar";
+#endif
+
+/**
+ * The ctest return code of skipped tests.
+ */
+constexpr int skipped = 77;
+
+/**
+ * Checks {@link byteSwap::copyBigEndian32} and {@link byteSwap::copyBigEndian64} against their scalar versions
+ * for unaligned sources and every tail length, then times both on arrays of the given number of values.
+ * The vector path is the one the target was compiled for, byteSwapBenchAvx2 measures the AVX2 path.
+ * Usage: byteSwapBench [values] [repeats]
+ */
+template <typename T>
+static bool check(void (*simd)(const uint8_t*, T*, size_t), void (*scalar)(const uint8_t*, T*, size_t), const std::vector<uint8_t>& bytes) {
+	for (size_t offset = 0; offset < sizeof(T); offset++) {
+		for (size_t count = 0; count < 64; count++) {
+			std::vector<T> expected(count), actual(count);
+			scalar(bytes.data() + offset, expected.data(), count);
+			simd(bytes.data() + offset, actual.data(), count);
+			if (expected != actual) {
+				std::printf("%zu bit swap differs for offset %zu and %zu values\n", sizeof(T) * 8, offset, count);
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+template <typename T>
+static double time(void (*copy)(const uint8_t*, T*, size_t), const std::vector<uint8_t>& bytes, std::vector<T>& out, uint32_t repeats) {
+	bench::Clock::time_point start = bench::Clock::now();
+	for (uint32_t r = 0; r < repeats; r++) {
+		copy(bytes.data(), out.data(), out.size());
+		bench::keep(out);
+	}
+	return bench::millisecondsSince(start) / repeats;
+}
+
+/**
+ * The throughput in GB/s of reading count values of size bytes and writing them back in milliseconds.
+ */
+static double gigabytesPerSecond(size_t count, size_t size, double milliseconds) {
+	return double(count) * double(size) / (milliseconds * 1e6);
+}
+
+int main(int argc, char** argv) {
+#if defined(__AVX2__) && (defined(__x86_64__) || defined(__i386__))
+	if (!__builtin_cpu_supports("avx2")) {
+		std::printf("The CPU does not support AVX2\n");
+		return skipped;
+	}
+#endif
+	uint32_t values = bench::argument(argc, argv, 1, 1 << 20);
+	uint32_t repeats = bench::argument(argc, argv, 2, 50);
+
+	std::mt19937_64 random(7);
+	std::vector<uint8_t> bytes(size_t(values) * 8 + 64);
+	for (uint8_t& byte : bytes)
+		byte = uint8_t(random());
+
+	if (!check(&byteSwap::copyBigEndian32, &byteSwap::copyBigEndian32Scalar, bytes) || !check(&byteSwap::copyBigEndian64, &byteSwap::copyBigEndian64Scalar, bytes))
+		return 1;
+
+	std::vector<int32_t> ints(values);
+	std::vector<int64_t> longs(values);
+	double scalar32 = time(&byteSwap::copyBigEndian32Scalar, bytes, ints, repeats);
+	double simd32 = time(&byteSwap::copyBigEndian32, bytes, ints, repeats);
+	double scalar64 = time(&byteSwap::copyBigEndian64Scalar, bytes, longs, repeats);
+	double simd64 = time(&byteSwap::copyBigEndian64, bytes, longs, repeats);
+	std::printf("%u values, %s path:\n", values, simdPath);
+	std::printf("  int32 scalar %.3f ms (%.2f GB/s), %s %.3f ms (%.2f GB/s), %.1fx\n", scalar32, gigabytesPerSecond(values, 4, scalar32), simdPath, simd32, gigabytesPerSecond(values, 4, simd32), scalar32 / simd32);
+	std::printf("  int64 scalar %.3f ms (%.2f GB/s), %s %.3f ms (%.2f GB/s), %.1fx\n", scalar64, gigabytesPerSecond(values, 8, scalar64), simdPath, simd64, gigabytesPerSecond(values, 8, simd64), scalar64 / simd64);
+	return 0;
+}
\ No newline at end of file
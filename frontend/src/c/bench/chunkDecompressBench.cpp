@@ -0,0 +1,160 @@
+#include "benchUtils.hpp"
+#include "minecraft/chunkCompression.hpp"
+#include "regionChunks.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <zlib.h>
+
+using namespace kayo;
+
+/**
+ * A greedy LZ4 block compressor with a single hash table, which matches the output of lz4 at its fast level closely
+ * enough for decoding benchmarks. Follows the end of block rules: the last 5 bytes are literals and the last match
+ * starts at least 12 bytes before the end.
+ */
+static void compressLZ4Block(const uint8_t* input, size_t length, std::vector<uint8_t>& out) {
+	constexpr size_t hashBits = 12;
+	std::vector<uint32_t> table(size_t(1) << hashBits, UINT32_MAX);
+	auto hash = [&](size_t position) {
+		uint32_t value;
+		std::memcpy(&value, input + position, 4);
+		return (value * 2654435761u) >> (32 - hashBits);
+	};
+	auto writeLength = [&](size_t value) {
+		for (; value >= 255; value -= 255)
+			out.push_back(255);
+		out.push_back(uint8_t(value));
+	};
+	auto writeSequence = [&](size_t literalStart, size_t literalEnd, size_t offset, size_t match) {
+		size_t literals = literalEnd - literalStart;
+		size_t matchCode = match > 0 ? match - 4 : 0;
+		out.push_back(uint8_t((literals >= 15 ? 15 : literals) << 4 | (matchCode >= 15 ? 15 : matchCode)));
+		if (literals >= 15)
+			writeLength(literals - 15);
+		out.insert(out.end(), input + literalStart, input + literalEnd);
+		if (match == 0)
+			return;
+		out.push_back(uint8_t(offset));
+		out.push_back(uint8_t(offset >> 8));
+		if (matchCode >= 15)
+			writeLength(matchCode - 15);
+	};
+
+	size_t anchor = 0;
+	size_t position = 0;
+	size_t matchLimit = length >= 5 ? length - 5 : 0;
+	while (length >= 13 && position + 12 <= length) {
+		uint32_t h = hash(position);
+		uint32_t candidate = table[h];
+		table[h] = uint32_t(position);
+		if (candidate == UINT32_MAX || position - candidate > 65535 || std::memcmp(input + candidate, input + position, 4) != 0) {
+			position++;
+			continue;
+		}
+		size_t match = 4;
+		while (position + match < matchLimit && input[candidate + match] == input[position + match])
+			match++;
+		writeSequence(anchor, position, position - candidate, match);
+		position += match;
+		anchor = position;
+	}
+	writeSequence(anchor, length, 0, 0);
+}
+
+/**
+ * Compresses a chunk with the LZ4BlockOutputStream framing Minecraft uses for compression type 4: blocks of 64 KiB,
+ * each with a 21 byte header, followed by an empty block. The checksums are left 0, they are not verified.
+ */
+static std::vector<uint8_t> compressLZ4Chunk(const std::vector<uint8_t>& chunk) {
+	constexpr size_t blockSize = 1 << 16;
+	std::vector<uint8_t> out, block;
+	auto writeHeader = [&](uint8_t token, size_t compressed, size_t decompressed) {
+		static const char magic[] = "LZ4Block";
+		out.insert(out.end(), magic, magic + 8);
+		out.push_back(token);
+		for (size_t value : {compressed, decompressed, size_t(0)}) {
+			for (int shift = 0; shift < 32; shift += 8)
+				out.push_back(uint8_t(value >> shift));
+		}
+	};
+	for (size_t start = 0; start < chunk.size(); start += blockSize) {
+		size_t length = std::min(blockSize, chunk.size() - start);
+		block.clear();
+		compressLZ4Block(chunk.data() + start, length, block);
+		// The token combines the method with the compression level, log2 of the block size minus 10.
+		if (block.size() < length) {
+			writeHeader(0x20 | 6, block.size(), length);
+			out.insert(out.end(), block.begin(), block.end());
+		} else {
+			writeHeader(0x10 | 6, length, length);
+			out.insert(out.end(), chunk.begin() + start, chunk.begin() + start + length);
+		}
+	}
+	writeHeader(0x10 | 6, 0, 0);
+	return out;
+}
+
+static std::vector<uint8_t> compressZlibChunk(const std::vector<uint8_t>& chunk) {
+	uLongf length = compressBound(uLong(chunk.size()));
+	std::vector<uint8_t> out(length);
+	if (compress2(out.data(), &length, chunk.data(), uLong(chunk.size()), Z_DEFAULT_COMPRESSION) != Z_OK)
+		return {};
+	out.resize(length);
+	return out;
+}
+
+/**
+ * Decompresses all chunks with {@link minecraft::decompressChunk} and checks the output against the original NBT.
+ */
+static double time(uint8_t compression, const std::vector<std::vector<uint8_t>>& compressed, const std::vector<std::vector<uint8_t>>& chunks, uint32_t repeats, bool& valid) {
+	bench::Clock::time_point start = bench::Clock::now();
+	for (uint32_t r = 0; r < repeats; r++) {
+		for (size_t i = 0; i < chunks.size(); i++) {
+			size_t length = 0;
+			uint8_t* out = minecraft::decompressChunk(compression, compressed[i].data(), compressed[i].size(), &length);
+			if (r == 0)
+				valid = valid && out && length == chunks[i].size() && std::memcmp(out, chunks[i].data(), length) == 0;
+			bench::keep(out);
+			std::free(out);
+		}
+	}
+	return bench::millisecondsSince(start) / repeats;
+}
+
+/**
+ * Compresses the same chunks with zlib (compression type 2, which Minecraft writes by default)
+ * and with LZ4 (type 4), then times decoding both through {@link minecraft::decompressChunk}.
+ * The chunks come from a region file given as argument or are generated.
+ * Usage: chunkDecompressBench [repeats] [region.mca]
+ */
+int main(int argc, char** argv) {
+	uint32_t repeats = bench::argument(argc, argv, 1, 10);
+	std::vector<std::vector<uint8_t>> chunks = bench::benchmarkChunks(argc, argv, 2, 256);
+	if (chunks.empty())
+		return 1;
+
+	std::vector<std::vector<uint8_t>> zlibChunks, lz4Chunks;
+	size_t bytes = 0, zlibBytes = 0, lz4Bytes = 0;
+	for (const std::vector<uint8_t>& chunk : chunks) {
+		zlibChunks.push_back(compressZlibChunk(chunk));
+		lz4Chunks.push_back(compressLZ4Chunk(chunk));
+		bytes += chunk.size();
+		zlibBytes += zlibChunks.back().size();
+		lz4Bytes += lz4Chunks.back().size();
+	}
+
+	bool valid = true;
+	double zlibTime = time(minecraft::chunk_compression_zlib, zlibChunks, chunks, repeats, valid);
+	double lz4Time = time(minecraft::chunk_compression_lz4, lz4Chunks, chunks, repeats, valid);
+	if (!valid) {
+		std::printf("Decompressed chunks differ from the original NBT\n");
+		return 1;
+	}
+
+	double megabytes = double(bytes) / (1 << 20);
+	std::printf("%.1f MiB of NBT: zlib %.1f%% %.3f ms (%.0f MiB/s), lz4 %.1f%% %.3f ms (%.0f MiB/s), %.1fx\n", megabytes, 100.0 * double(zlibBytes) / double(bytes), zlibTime, megabytes * 1000.0 / zlibTime, 100.0 * double(lz4Bytes) / double(bytes), lz4Time, megabytes * 1000.0 / lz4Time, zlibTime / lz4Time);
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include "benchUtils.hpp"
+#include "mesh/mesh.hpp"
+#include <cstdio>
+#include <vector>
+
+using namespace kayo;
+using namespace kayo::mesh;
+
+/**
+ * Builds a grid of quads and times the common traversals of the Mesh: the corners of all triangles,
+ * the Edges of all Faces through the handles, the one ring of every SharedVertex and the Faces at every SharedEdge.
+ * Every traversal has to visit the number of elements the grid topology implies.
+ * Usage: meshTraversalBench [quads per side] [repeats]
+ */
+int main(int argc, char** argv) {
+	uint32_t side = bench::argument(argc, argv, 1, 500);
+	uint32_t repeats = bench::argument(argc, argv, 2, 20);
+	uint32_t row = side + 1;
+
+	bench::Clock::time_point start = bench::Clock::now();
+	Mesh mesh;
+	for (uint32_t z = 0; z <= side; z++) {
+		for (uint32_t x = 0; x <= side; x++)
+			mesh.addVertex(FixedPoint::vec3f(float(x), float((x * z) % 7), float(z)));
+	}
+	std::vector<uint32_t> vertices;
+	vertices.reserve(size_t(side) * side * 4);
+	for (uint32_t z = 0; z < side; z++) {
+		for (uint32_t x = 0; x < side; x++) {
+			uint32_t quad[4] = {z * row + x, z * row + x + 1, (z + 1) * row + x + 1, (z + 1) * row + x};
+			vertices.insert(vertices.end(), quad, quad + 4);
+		}
+	}
+	std::vector<uint32_t> sizes(size_t(side) * side, 4);
+	mesh.fillFaces(vertices.data(), sizes.data(), uint32_t(sizes.size()));
+	double build = bench::millisecondsSince(start);
+
+	uint64_t triangleCorners = 0, faceEdges = 0, oneRing = 0, edgeFaces = 0;
+	float sum = 0.0f;
+
+	start = bench::Clock::now();
+	for (uint32_t r = 0; r < repeats; r++) {
+		for (uint32_t corner : mesh.triangles) {
+			const FixedPoint::vec3f& p = mesh.positions[mesh.corner_vertices[corner]];
+			sum += p.x + p.y + p.z;
+			triangleCorners++;
+		}
+	}
+	double triangles = bench::millisecondsSince(start) / repeats;
+
+	start = bench::Clock::now();
+	for (uint32_t r = 0; r < repeats; r++) {
+		for (Face face : mesh.getFaces()) {
+			for (Edge edge : face.edges()) {
+				const FixedPoint::vec3f& p = edge.out().sharedVertex().position();
+				sum += p.x + p.y + p.z;
+				faceEdges++;
+			}
+		}
+	}
+	double faces = bench::millisecondsSince(start) / repeats;
+
+	start = bench::Clock::now();
+	for (uint32_t r = 0; r < repeats; r++) {
+		for (uint32_t v = 0; v < mesh.numSharedVertices(); v++) {
+			for (uint32_t e = mesh.vertex_edges[v]; e != invalid_index;) {
+				uint32_t end = mesh.edge_vertices[2 * e] == v ? 0 : 1;
+				const FixedPoint::vec3f& p = mesh.positions[mesh.edge_vertices[2 * e + 1 - end]];
+				sum += p.x + p.y + p.z;
+				oneRing++;
+				e = mesh.edge_next[2 * e + end];
+			}
+		}
+	}
+	double rings = bench::millisecondsSince(start) / repeats;
+
+	start = bench::Clock::now();
+	for (uint32_t r = 0; r < repeats; r++) {
+		for (uint32_t e = 0; e < mesh.numSharedEdges(); e++) {
+			for (uint32_t c = mesh.edge_corners[e]; c != invalid_index; c = mesh.corner_next_at_edge[c]) {
+				sum += float(mesh.face_materials[mesh.corner_faces[c]] + mesh.nextCorner(c));
+				edgeFaces++;
+			}
+		}
+	}
+	double edges = bench::millisecondsSince(start) / repeats;
+	bench::keep(sum);
+
+	uint64_t quads = uint64_t(side) * side;
+	uint64_t sharedEdges = 2 * uint64_t(side) * row;
+	bool correct = mesh.numFaces() == quads && mesh.numSharedEdges() == sharedEdges && triangleCorners == 6 * quads * repeats &&
+				   faceEdges == 4 * quads * repeats && oneRing == 2 * sharedEdges * repeats && edgeFaces == 4 * quads * repeats;
+	std::printf("%ux%u quads, build %.1f ms: triangle corners %.3f ms, face edges %.3f ms, one rings %.3f ms, edge faces %.3f ms\n", side, side, build, triangles, faces, rings, edges);
+	if (!correct)
+		std::printf("the traversals visited the wrong number of elements\n");
+	return correct ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include "benchUtils.hpp"
+#include "minecraft/nbt.hpp"
+#include "minecraft/nbtTable.hpp"
+#include "regionChunks.hpp"
+#include <cstdio>
+#include <string_view>
+#include <vector>
+
+using namespace kayo;
+
+/**
+ * Compares the structure of a parsed tree with a table entry: ids, the names of compound entries,
+ * the lengths of arrays, strings and containers and, recursively, all children.
+ */
+static bool matches(const NBT::NBTBase* tag, const NBT::TagTable& table, const NBT::FlatTag* flat, bool named) {
+	if (tag->id != flat->id || (named && tag->name != flat->name))
+		return false;
+	switch (flat->id) {
+	case 7:
+		return static_cast<const NBT::ByteArrayTag*>(tag)->value.size() == flat->length;
+	case 8:
+		return static_cast<const NBT::StringTag*>(tag)->value == flat->get<std::string_view>();
+	case 11:
+		return static_cast<const NBT::IntArrayTag*>(tag)->value.size() == flat->length;
+	case 12:
+		return static_cast<const NBT::LongArrayTag*>(tag)->value.size() == flat->length;
+	case 9:
+	case 10: {
+		const std::vector<NBT::NBTBase*>& children = static_cast<const NBT::NBTContainer*>(tag)->value;
+		if (children.size() != flat->length)
+			return false;
+		const NBT::FlatTag* child = table.firstChild(flat);
+		for (const NBT::NBTBase* treeChild : children) {
+			if (!child || !matches(treeChild, table, child, flat->id == 10))
+				return false;
+			child = table.nextSibling(child);
+		}
+		return true;
+	}
+	default:
+		return true;
+	}
+}
+
+/**
+ * Times {@link NBT::parseNamedNBT}, which builds a tree of heap allocated tags, against {@link NBT::TagTable},
+ * which indexes the buffer in place, on the decompressed chunks of a region file or on generated chunks.
+ * Both have to consume every chunk completely and yield the same structure.
+ * Usage: nbtParseBench [repeats] [region.mca]
+ */
+int main(int argc, char** argv) {
+	uint32_t repeats = bench::argument(argc, argv, 1, 10);
+	std::vector<std::vector<uint8_t>> chunks = bench::benchmarkChunks(argc, argv, 2, 1024);
+	if (chunks.empty())
+		return 1;
+	size_t bytes = 0;
+	for (const std::vector<uint8_t>& chunk : chunks)
+		bytes += chunk.size();
+
+	NBT::TagTable table;
+	for (const std::vector<uint8_t>& chunk : chunks) {
+		size_t progress = 0;
+		NBT::NBTBase* tree = NBT::parseNamedNBT(chunk.data(), progress);
+		table.parse(chunk.data(), chunk.size());
+		bool same = progress == chunk.size() && matches(tree, table, table.root(), true);
+		delete tree;
+		if (!same) {
+			std::printf("Tree and table differ for a chunk of %zu bytes\n", chunk.size());
+			return 1;
+		}
+	}
+
+	bench::Clock::time_point start = bench::Clock::now();
+	for (uint32_t r = 0; r < repeats; r++) {
+		for (const std::vector<uint8_t>& chunk : chunks) {
+			size_t progress = 0;
+			NBT::NBTBase* tree = NBT::parseNamedNBT(chunk.data(), progress);
+			bench::keep(tree);
+			delete tree;
+		}
+	}
+	double treeTime = bench::millisecondsSince(start) / repeats;
+
+	start = bench::Clock::now();
+	for (uint32_t r = 0; r < repeats; r++) {
+		for (const std::vector<uint8_t>& chunk : chunks) {
+			table.parse(chunk.data(), chunk.size());
+			bench::keep(table);
+		}
+	}
+	double tableTime = bench::millisecondsSince(start) / repeats;
+
+	double megabytes = double(bytes) / (1 << 20);
+	std::printf("%.1f MiB of NBT: tree %.3f ms (%.0f MiB/s), table %.3f ms (%.0f MiB/s), %.1fx\n", megabytes, treeTime, megabytes * 1000.0 / treeTime, tableTime, megabytes * 1000.0 / tableTime, treeTime / tableTime);
+	return 0;
+}
\ No newline at end of file
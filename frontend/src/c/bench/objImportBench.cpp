@@ -0,0 +1,69 @@
+#include "benchUtils.hpp"
+#include "mesh/mesh.hpp"
+#include "parser/objParser.hpp"
+#include <cstdio>
+#include <string>
+
+using namespace kayo;
+
+/**
+ * Generates OBJ files of triangulated grids with normals and uvs and times parsing them and building the Meshes,
+ * the work of an OBJ import before the upload.
+ * Usage: objImportBench [faces...], 10k, 100k and 1M faces by default.
+ */
+static std::string gridObj(uint32_t numFaces) {
+	uint32_t side = 1;
+	while (2 * side * side < numFaces)
+		side++;
+	uint32_t row = side + 1;
+	std::string obj = "o grid\n";
+	obj.reserve(size_t(numFaces) * 64);
+	char line[96];
+	for (uint32_t z = 0; z <= side; z++) {
+		for (uint32_t x = 0; x <= side; x++) {
+			std::snprintf(line, sizeof(line), "v %u %.3f %u\nvt %.4f %.4f\n", x, float((x * z) % 13) * 0.125f, z, float(x) / float(side), float(z) / float(side));
+			obj += line;
+		}
+	}
+	obj += "vn 0 1 0\nusemtl ground\n";
+	for (uint32_t face = 0; face < numFaces; face++) {
+		uint32_t x = face / 2 % side, z = face / 2 / side;
+		uint32_t a = z * row + x + 1, b = a + 1, c = a + row + 1, d = a + row;
+		if (face % 2 == 0)
+			std::snprintf(line, sizeof(line), "f %u/%u/1 %u/%u/1 %u/%u/1\n", a, a, b, b, c, c);
+		else
+			std::snprintf(line, sizeof(line), "f %u/%u/1 %u/%u/1 %u/%u/1\n", a, a, c, c, d, d);
+		obj += line;
+	}
+	return obj;
+}
+
+int main(int argc, char** argv) {
+	std::vector<uint32_t> sizes;
+	for (int i = 1; i < argc; i++)
+		sizes.push_back(bench::argument(argc, argv, i, 0));
+	if (sizes.empty())
+		sizes = {10000, 100000, 1000000};
+
+	for (uint32_t numFaces : sizes) {
+		std::string obj = gridObj(numFaces);
+		bench::Clock::time_point start = bench::Clock::now();
+		parser::OBJ::ParseResult parsed = parser::OBJ::parseObj(obj);
+		double parse = bench::millisecondsSince(start);
+		start = bench::Clock::now();
+		std::vector<mesh::Mesh*> meshes = parser::OBJ::objBinaryToMesh(parsed);
+		double build = bench::millisecondsSince(start);
+
+		uint32_t faces = 0;
+		for (mesh::Mesh* mesh : meshes) {
+			faces += mesh->numFaces();
+			delete mesh;
+		}
+		std::printf("%u faces (%.1f MB): parse %.1f ms, build meshes %.1f ms, total %.1f ms\n", numFaces, double(obj.size()) / (1 << 20), parse, build, parse + build);
+		if (faces != numFaces) {
+			std::printf("imported %u faces instead of %u\n", faces, numFaces);
+			return 1;
+		}
+	}
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,215 @@
+#pragma once
+#include "minecraft/chunkCompression.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace kayo {
+namespace bench {
+
+/**
+ * Writes big endian NBT, just enough to generate chunks in the layout of the current Anvil format.
+ */
+class NBTWriter {
+  public:
+	std::vector<uint8_t> bytes;
+
+	void u8(uint8_t value) { bytes.push_back(value); }
+	void u16(uint16_t value) {
+		u8(uint8_t(value >> 8));
+		u8(uint8_t(value));
+	}
+	void u32(uint32_t value) {
+		u16(uint16_t(value >> 16));
+		u16(uint16_t(value));
+	}
+	void u64(uint64_t value) {
+		u32(uint32_t(value >> 32));
+		u32(uint32_t(value));
+	}
+	void string(const std::string& value) {
+		u16(uint16_t(value.size()));
+		bytes.insert(bytes.end(), value.begin(), value.end());
+	}
+	void name(int8_t id, const std::string& tagName) {
+		u8(uint8_t(id));
+		string(tagName);
+	}
+
+	void byteTag(const std::string& tagName, int8_t value) {
+		name(1, tagName);
+		u8(uint8_t(value));
+	}
+	void intTag(const std::string& tagName, int32_t value) {
+		name(3, tagName);
+		u32(uint32_t(value));
+	}
+	void longTag(const std::string& tagName, int64_t value) {
+		name(4, tagName);
+		u64(uint64_t(value));
+	}
+	void stringTag(const std::string& tagName, const std::string& value) {
+		name(8, tagName);
+		string(value);
+	}
+	void byteArrayTag(const std::string& tagName, const std::vector<uint8_t>& values) {
+		name(7, tagName);
+		u32(uint32_t(values.size()));
+		bytes.insert(bytes.end(), values.begin(), values.end());
+	}
+	void longArrayTag(const std::string& tagName, const std::vector<uint64_t>& values) {
+		name(12, tagName);
+		u32(uint32_t(values.size()));
+		for (uint64_t value : values)
+			u64(value);
+	}
+	void beginCompound(const std::string& tagName) { name(10, tagName); }
+	void beginList(const std::string& tagName, int8_t elementId, uint32_t length) {
+		name(9, tagName);
+		u8(uint8_t(elementId));
+		u32(length);
+	}
+	void end() { u8(0); }
+};
+
+/**
+ * Generates the uncompressed NBT of a chunk with 24 sections: block palettes of up to 12 entries with properties,
+ * packed block and biome indices, light arrays and heightmaps. The contents compress roughly like those of terrain.
+ */
+inline std::vector<uint8_t> generateChunk(int32_t chunkX, int32_t chunkZ, std::mt19937_64& random) {
+	static const char* blocks[] = {"minecraft:stone", "minecraft:deepslate", "minecraft:dirt", "minecraft:grass_block", "minecraft:water", "minecraft:oak_log", "minecraft:oak_leaves", "minecraft:coal_ore", "minecraft:iron_ore", "minecraft:gravel", "minecraft:andesite", "minecraft:granite"};
+	NBTWriter writer;
+	writer.beginCompound("");
+	writer.intTag("DataVersion", 3953);
+	writer.intTag("xPos", chunkX);
+	writer.intTag("yPos", -4);
+	writer.intTag("zPos", chunkZ);
+	writer.stringTag("Status", "minecraft:full");
+	writer.longTag("LastUpdate", int64_t(random() % 100000));
+	writer.longTag("InhabitedTime", 0);
+	writer.beginList("sections", 10, 24);
+	for (int32_t y = -4; y < 20; y++) {
+		writer.byteTag("Y", int8_t(y));
+		writer.beginCompound("block_states");
+		uint32_t paletteSize = y >= 8 ? 1 : uint32_t(2 + random() % 11);
+		writer.beginList("palette", 10, paletteSize);
+		for (uint32_t i = 0; i < paletteSize; i++) {
+			writer.stringTag("Name", y >= 8 ? "minecraft:air" : blocks[i]);
+			if (i == 5 || i == 6) {
+				writer.beginCompound("Properties");
+				writer.stringTag("axis", "y");
+				if (i == 6) {
+					writer.stringTag("distance", "7");
+					writer.stringTag("persistent", "false");
+				}
+				writer.end();
+			}
+			writer.end();
+		}
+		if (paletteSize > 1) {
+			uint32_t bits = 4;
+			while ((1u << bits) < paletteSize)
+				bits++;
+			// Mostly horizontal layers with scattered ores, so the indices compress like those of terrain.
+			uint32_t perLong = 64 / bits;
+			std::vector<uint64_t> data((4096 + perLong - 1) / perLong);
+			for (uint32_t block = 0; block < 4096; block++) {
+				uint64_t index = random() % 8 == 0 ? random() % paletteSize : (block >> 8) * paletteSize / 16;
+				data[block / perLong] |= index << (block % perLong * bits);
+			}
+			writer.longArrayTag("data", data);
+		}
+		writer.end();
+		writer.beginCompound("biomes");
+		writer.beginList("palette", 8, 2);
+		writer.string("minecraft:plains");
+		writer.string("minecraft:forest");
+		writer.longArrayTag("data", {random()});
+		writer.end();
+		std::vector<uint8_t> blockLight(2048), skyLight(2048, y >= 4 ? 0xFF : 0);
+		for (size_t i = 0; i < blockLight.size(); i += 1 + random() % 64)
+			blockLight[i] = uint8_t(random());
+		writer.byteArrayTag("BlockLight", blockLight);
+		writer.byteArrayTag("SkyLight", skyLight);
+		writer.end();
+	}
+	writer.beginCompound("Heightmaps");
+	for (const char* heightmap : {"MOTION_BLOCKING", "MOTION_BLOCKING_NO_LEAVES", "OCEAN_FLOOR", "WORLD_SURFACE"}) {
+		std::vector<uint64_t> data(37);
+		for (uint64_t& value : data)
+			value = random();
+		writer.longArrayTag(heightmap, data);
+	}
+	writer.end();
+	writer.beginList("block_entities", 0, 0);
+	writer.beginList("entities", 0, 0);
+	writer.end();
+	return std::move(writer.bytes);
+}
+
+/**
+ * Generates the uncompressed NBT of the given number of chunks.
+ */
+inline std::vector<std::vector<uint8_t>> generateChunks(uint32_t count, uint64_t seed) {
+	std::mt19937_64 random(seed);
+	std::vector<std::vector<uint8_t>> chunks;
+	chunks.reserve(count);
+	for (uint32_t i = 0; i < count; i++)
+		chunks.push_back(generateChunk(int32_t(i % 32), int32_t(i / 32), random));
+	return chunks;
+}
+
+/**
+ * Reads and decompresses all chunks of a region file which are stored inside the region.
+ * Chunks in external .mcc files and corrupt chunks are skipped.
+ */
+inline std::vector<std::vector<uint8_t>> loadRegionChunks(const char* path) {
+	std::vector<std::vector<uint8_t>> chunks;
+	FILE* file = std::fopen(path, "rb");
+	if (!file)
+		return chunks;
+	std::vector<uint8_t> region;
+	uint8_t buffer[1 << 16];
+	size_t read;
+	while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+		region.insert(region.end(), buffer, buffer + read);
+	std::fclose(file);
+	if (region.size() < 8192)
+		return chunks;
+
+	for (size_t i = 0; i < 1024; i++) {
+		size_t offset = ((size_t(region[i * 4]) << 16) | (size_t(region[i * 4 + 1]) << 8) | region[i * 4 + 2]) * 4096;
+		if (offset == 0 || offset + 5 > region.size())
+			continue;
+		size_t length = (size_t(region[offset]) << 24) | (size_t(region[offset + 1]) << 16) | (size_t(region[offset + 2]) << 8) | region[offset + 3];
+		uint8_t compression = region[offset + 4];
+		if (length < 1 || offset + 4 + length > region.size() || (compression & minecraft::chunk_compression_external))
+			continue;
+		size_t decompressedLength = 0;
+		uint8_t* decompressed = minecraft::decompressChunk(compression, region.data() + offset + 5, length - 1, &decompressedLength);
+		if (!decompressed)
+			continue;
+		chunks.emplace_back(decompressed, decompressed + decompressedLength);
+		std::free(decompressed);
+	}
+	return chunks;
+}
+
+/**
+ * The chunks of the region file given as argument or generated chunks if there is none.
+ */
+inline std::vector<std::vector<uint8_t>> benchmarkChunks(int argc, char** argv, int index, uint32_t generated) {
+	if (index < argc) {
+		std::vector<std::vector<uint8_t>> chunks = loadRegionChunks(argv[index]);
+		std::printf("%zu chunks from %s\n", chunks.size(), argv[index]);
+		return chunks;
+	}
+	std::printf("%u generated chunks\n", generated);
+	return generateChunks(generated, 7);
+}
+
+} // namespace bench
+} // namespace kayo
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+#include "val.h"
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <tuple>
+
+/**
+ * Registers nothing, so the sources with bindings compile for the native benchmarks.
+ * Includes the standard headers the sources get through the real embind headers.
+ */
+namespace emscripten {
+struct return_value_policy {
+	struct reference {};
+	struct take_ownership {};
+};
+struct allow_raw_pointers {};
+template <typename... T>
+struct base {};
+template <typename T, typename... B>
+struct class_ {
+	explicit class_(const char*) {}
+	template <typename... A, typename... P>
+	class_& constructor(P...) { return *this; }
+	template <typename... A>
+	class_& function(const char*, A...) { return *this; }
+	template <typename... A>
+	class_& class_function(const char*, A...) { return *this; }
+	template <typename... A>
+	class_& property(const char*, A...) { return *this; }
+};
+template <typename T>
+struct value_object {
+	explicit value_object(const char*) {}
+	template <typename... A>
+	value_object& field(const char*, A...) { return *this; }
+};
+template <typename T>
+struct value_array {
+	explicit value_array(const char*) {}
+	template <typename... A>
+	value_array& element(A...) { return *this; }
+};
+template <typename T>
+struct enum_ {
+	explicit enum_(const char*) {}
+	enum_& value(const char*, T) { return *this; }
+};
+template <typename... A>
+void function(const char*, A...) {}
+template <typename T>
+void register_vector(const char*) {}
+template <typename K, typename V>
+void register_map(const char*) {}
+} // namespace emscripten
+
+#define EMSCRIPTEN_BINDINGS(name) [[maybe_unused]] static void embind_init_##name()
\ No newline at end of file
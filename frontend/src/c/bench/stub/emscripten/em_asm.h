@@ -0,0 +1,8 @@
+#pragma once
+
+/**
+ * The JS snippets are dropped, which only skips the completion callbacks of tasks.
+ */
+#define EM_ASM(...) ((void)0)
+#define MAIN_THREAD_EM_ASM(...) ((void)0)
+#define MAIN_THREAD_ASYNC_EM_ASM(...) ((void)0)
\ No newline at end of file
@@ -0,0 +1,4 @@
+#pragma once
+#include "em_asm.h"
+
+#define EMSCRIPTEN_KEEPALIVE
\ No newline at end of file
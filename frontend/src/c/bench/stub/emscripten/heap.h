@@ -0,0 +1,4 @@
+#pragma once
+#include <cstddef>
+
+inline size_t emscripten_get_heap_size() { return 0; }
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+/**
+ * An inert val, JS is not reachable from the native benchmarks.
+ */
+namespace emscripten {
+class val {
+  public:
+	template <typename... A>
+	explicit val(A&&...) {}
+	static val global(const char* = nullptr) { return val(); }
+	static val object() { return val(); }
+	static val array() { return val(); }
+	static val null() { return val(); }
+	static val undefined() { return val(); }
+	template <typename T>
+	T as() const { return T(); }
+	template <typename R = val, typename... A>
+	R call(const char*, A&&...) const { return R(); }
+	template <typename K, typename V>
+	void set(const K&, const V&) {}
+	val operator[](const char*) const { return val(); }
+	template <typename... A>
+	val operator()(A&&...) const { return val(); }
+	bool isUndefined() const { return false; }
+	bool isNull() const { return false; }
+};
+template <typename T>
+struct memory_view {
+	size_t size;
+	const T* data;
+};
+template <typename T>
+memory_view<T> typed_memory_view(size_t size, const T* data) { return {size, data}; }
+} // namespace emscripten
\ No newline at end of file
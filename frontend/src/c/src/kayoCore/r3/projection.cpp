@@ -2,6 +2,10 @@
 #include <emscripten/bind.h>
 
 namespace kayo {
+const FixedPoint::mat4f& kayo::Projection::getMatrix() const {
+	return this->matrix;
+}
+
 kayo::memUtils::KayoPointer kayo::Projection::getProjectionMatrixJS() {
 	return kayo::memUtils::KayoPointer{reinterpret_cast<uintptr_t>(&this->matrix), sizeof(this->matrix)};
 }
@@ -12,6 +12,7 @@ class Projection {
 
   public:
 	virtual ~Projection() = default;
+	const FixedPoint::mat4f& getMatrix() const;
 	kayo::memUtils::KayoPointer getProjectionMatrixJS();
 	void setNearJS(FixedPoint::NumberWire near);
 	FixedPoint::NumberWire getNearJS();
@@ -0,0 +1,34 @@
+#include "buildRealtimeDataTask.hpp"
+#include "../task/workerPool.hpp"
+#include <emscripten/bind.h>
+#include <emscripten/em_asm.h>
+
+namespace kayo {
+namespace mesh {
+
+BuildRealtimeDataTask::BuildRealtimeDataTask(uint32_t task_id, Mesh* mesh) : Task(task_id), mesh(mesh) {}
+
+void BuildRealtimeDataTask::run() {
+	WorkerPool::shared().submit([this] {
+		realtime_data = std::make_unique<RealtimeData>(mesh, true);
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdollar-in-identifier-extension"
+		MAIN_THREAD_ASYNC_EM_ASM({ window.kayo.taskQueue.wasmTaskFinished($0, {numVertices : $1, numIndices : $2}); }, task_id, realtime_data->position.num_vertices, realtime_data->indices.num_indices);
+#pragma GCC diagnostic pop
+	});
+}
+
+RealtimeData* BuildRealtimeDataTask::takeRealtimeData() {
+	return realtime_data.release();
+}
+
+} // namespace mesh
+} // namespace kayo
+
+using namespace emscripten;
+EMSCRIPTEN_BINDINGS(KayoMeshRealtimeTasks) {
+	class_<kayo::mesh::BuildRealtimeDataTask, base<kayo::Task>>("WasmBuildRealtimeDataTask")
+		.constructor<uint32_t, kayo::mesh::Mesh*>()
+		.function("run", &kayo::mesh::BuildRealtimeDataTask::run)
+		.function("takeRealtimeData", &kayo::mesh::BuildRealtimeDataTask::takeRealtimeData, return_value_policy::take_ownership());
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+#include "../task/task.hpp"
+#include "realtimeVertexBuffers.hpp"
+#include <memory>
+
+namespace kayo {
+namespace mesh {
+
+/**
+ * Builds the indexed {@link RealtimeData} of a Mesh on the {@link WorkerPool}, for meshes where
+ * {@link RealtimeData::indexInTask} says the build would stall the main thread.
+ * The Mesh must not be modified until the task finished.
+ */
+class BuildRealtimeDataTask : public Task {
+  public:
+	Mesh* mesh;
+	std::unique_ptr<RealtimeData> realtime_data;
+	BuildRealtimeDataTask(uint32_t task_id, Mesh* mesh);
+	void run() override;
+	/**
+	 * Hands the built RealtimeData to the caller, who has to delete it.
+	 */
+	RealtimeData* takeRealtimeData();
+};
+
+} // namespace mesh
+} // namespace kayo
\ No newline at end of file
@@ -5,92 +5,265 @@
 namespace kayo {
 namespace mesh {
 
-bool Mesh::addSharedVertex(SharedVertex* sv) {
-	if (!sv)
-		return false;
-	auto it = std::find(shared_vertices.begin(), shared_vertices.end(), sv);
-	if (it != shared_vertices.end())
-		return false;
-	shared_vertices.push_back(sv);
-	return true;
+Mesh::~Mesh() {
+	for (UvMap* uv_map : uv_maps)
+		delete uv_map;
 }
 
-bool Mesh::addSharedEdge(SharedEdge* e) {
-	if (!e)
-		return false;
-	auto it = std::find(shared_edges.begin(), shared_edges.end(), e);
-	if (it != shared_edges.end())
-		return false;
-	shared_edges.push_back(e);
-	return true;
+uint32_t Mesh::ensureVertexAttribute(const std::string& attrib_name, AttributeType type) {
+	return vertex_attributes.ensure(attrib_name, type);
 }
 
-bool Mesh::addFace(Face* f) {
-	if (!f)
-		return false;
-	auto it = std::find(faces.begin(), faces.end(), f);
-	if (it != faces.end())
+uint32_t Mesh::ensureEdgeAttribute(const std::string& attrib_name, AttributeType type) {
+	return edge_attributes.ensure(attrib_name, type);
+}
+
+uint32_t Mesh::ensureFaceAttribute(const std::string& attrib_name, AttributeType type) {
+	return face_attributes.ensure(attrib_name, type);
+}
+
+emscripten::val Mesh::getVertexAttribute(const std::string& attrib_name) const {
+	return vertex_attributes.view(attrib_name);
+}
+
+emscripten::val Mesh::getEdgeAttribute(const std::string& attrib_name) const {
+	return edge_attributes.view(attrib_name);
+}
+
+emscripten::val Mesh::getFaceAttribute(const std::string& attrib_name) const {
+	return face_attributes.view(attrib_name);
+}
+
+uint32_t Mesh::addVertex(const FixedPoint::vec3f& position) {
+	positions.push_back(position);
+	vertex_edges.push_back(invalid_index);
+	vertex_corners.push_back(invalid_index);
+	return uint32_t(positions.size() - 1);
+}
+
+uint32_t Mesh::findEdge(uint32_t a, uint32_t b) const {
+	for (uint32_t e = vertex_edges[a]; e != invalid_index;) {
+		uint32_t side = edge_vertices[2 * e] == a ? 0 : 1;
+		if (edge_vertices[2 * e + 1 - side] == b)
+			return e;
+		e = edge_next[2 * e + side];
+	}
+	return invalid_index;
+}
+
+uint32_t Mesh::addSharedEdge(uint32_t v1, uint32_t v2) {
+	uint32_t e = numSharedEdges();
+	edge_vertices.push_back(v1);
+	edge_vertices.push_back(v2);
+	edge_next.push_back(vertex_edges[v1]);
+	edge_next.push_back(vertex_edges[v2]);
+	vertex_edges[v1] = e;
+	vertex_edges[v2] = e;
+	edge_corners.push_back(invalid_index);
+	edge_attributes.resize(e + 1);
+	return e;
+}
+
+uint32_t Mesh::connectVertices(uint32_t a, uint32_t b) {
+	if (a == b)
+		return invalid_index;
+	uint32_t e = findEdge(a, b);
+	return e != invalid_index ? e : addSharedEdge(a, b);
+}
+
+static bool isValidFace(const uint32_t* vertices, uint32_t num_vertices) {
+	if (num_vertices <= 2)
 		return false;
-	faces.push_back(f);
+	for (uint32_t i = 0; i < num_vertices; ++i) {
+		if (vertices[i] == vertices[(i + 1) % num_vertices])
+			return false;
+	}
 	return true;
 }
 
-uint32_t Mesh::ensureVertexAttribute(const std::string& attrib_name) {
-	auto it = vertex_attributes.find(attrib_name);
-	if (it != vertex_attributes.end())
-		return it->second;
-	uint32_t idx = static_cast<uint32_t>(vertex_attributes.size());
-	vertex_attributes.emplace(attrib_name, idx);
-	return idx;
+uint32_t Mesh::addFace(uint32_t first_corner, uint32_t num_vertices) {
+	uint32_t face = numFaces();
+	face_corners.push_back(first_corner);
+	face_sizes.push_back(num_vertices);
+	face_materials.push_back(0);
+	return face;
 }
 
-uint32_t Mesh::ensureEdgeAttribute(const std::string& attrib_name) {
-	auto it = edge_attributes.find(attrib_name);
-	if (it != edge_attributes.end())
-		return it->second;
-	uint32_t idx = static_cast<uint32_t>(edge_attributes.size());
-	edge_attributes.emplace(attrib_name, idx);
-	return idx;
+void Mesh::addCorner(uint32_t face, uint32_t vertex, uint32_t edge) {
+	uint32_t corner = numCorners();
+	corner_vertices.push_back(vertex);
+	corner_edges.push_back(edge);
+	corner_faces.push_back(face);
+	corner_next_at_vertex.push_back(vertex_corners[vertex]);
+	vertex_corners[vertex] = corner;
+	corner_next_at_edge.push_back(edge_corners[edge]);
+	edge_corners[edge] = corner;
 }
 
-uint32_t Mesh::ensureFaceAttribute(const std::string& attrib_name) {
-	auto it = face_attributes.find(attrib_name);
-	if (it != face_attributes.end())
-		return it->second;
-	uint32_t idx = static_cast<uint32_t>(face_attributes.size());
-	face_attributes.emplace(attrib_name, idx);
-	return idx;
+/**
+ * Grows the per corner and per Face data that is not written while linking Faces.
+ */
+void Mesh::resizeCornerData() {
+	uint32_t num_corners = numCorners();
+	corner_normals.resize(num_corners, FixedPoint::vec3f(0.0f));
+	vertex_attributes.resize(num_corners);
+	for (UvMap* uv_map : uv_maps)
+		uv_map->corner_uvs.resize(num_corners, invalid_index);
+	face_attributes.resize(numFaces());
 }
 
-SharedEdge* Mesh::connectSharedVertices(SharedVertex* a, SharedVertex* b) {
-	if (!a || !b || a == b)
-		return nullptr;
+uint32_t Mesh::fillVertices(const uint32_t* vertices, uint32_t num_vertices) {
+	if (!isValidFace(vertices, num_vertices))
+		return invalid_index;
 
-	for (SharedEdge* e : a->shared_edges)
-		if (e->other(a) == b)
-			return e;
+	uint32_t face = addFace(numCorners(), num_vertices);
+	for (uint32_t i = 0; i < num_vertices; ++i)
+		addCorner(face, vertices[i], connectVertices(vertices[i], vertices[(i + 1) % num_vertices]));
+	resizeCornerData();
+	triangulateFaces(face);
+	return face;
+}
+
+namespace {
+/**
+ * A SharedEdge lookup by its two SharedVertices for {@link Mesh::fillFaces}, with open addressing and linear probing.
+ */
+class EdgeTable {
+  private:
+	static constexpr uint64_t empty_key = UINT64_MAX;
+	struct Slot {
+		uint64_t key = empty_key;
+		uint32_t edge;
+	};
+	std::vector<Slot> slots;
+	size_t count = 0;
+	size_t mask;
+
+	static uint64_t key(uint32_t a, uint32_t b) {
+		return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+	}
+	size_t probe(uint64_t k) const {
+		size_t i = size_t((k * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+		while (slots[i].key != k && slots[i].key != empty_key)
+			i = (i + 1) & mask;
+		return i;
+	}
+	void rehash(size_t num_slots) {
+		std::vector<Slot> old(num_slots);
+		old.swap(slots);
+		mask = num_slots - 1;
+		for (const Slot& slot : old) {
+			if (slot.key != empty_key)
+				slots[probe(slot.key)] = slot;
+		}
+	}
+
+  public:
+	/**
+	 * @param expected The expected number of SharedEdges, the table grows beyond it to keep its load factor at or below 1/2.
+	 */
+	explicit EdgeTable(size_t expected) {
+		size_t size = 16;
+		while (size < 2 * expected)
+			size *= 2;
+		rehash(size);
+	}
+	uint32_t find(uint32_t a, uint32_t b) const {
+		const Slot& slot = slots[probe(key(a, b))];
+		return slot.key == empty_key ? invalid_index : slot.edge;
+	}
+	void insert(uint32_t a, uint32_t b, uint32_t edge) {
+		if (2 * (count + 1) > slots.size())
+			rehash(2 * slots.size());
+		uint64_t k = key(a, b);
+		Slot& slot = slots[probe(k)];
+		count += slot.key == empty_key;
+		slot = {k, edge};
+	}
+};
+} // namespace
+
+std::vector<uint32_t> Mesh::fillFaces(const uint32_t* vertices, const uint32_t* sizes, uint32_t num_faces) {
+	std::vector<uint32_t> faces(num_faces, invalid_index);
+	size_t num_new_corners = 0;
+	size_t offset = 0;
+	for (uint32_t f = 0; f < num_faces; f++) {
+		if (isValidFace(vertices + offset, sizes[f]))
+			num_new_corners += sizes[f];
+		offset += sizes[f];
+	}
+
+	for (std::vector<uint32_t>* corner_data : {&corner_vertices, &corner_edges, &corner_faces, &corner_next_at_vertex, &corner_next_at_edge})
+		corner_data->reserve(numCorners() + num_new_corners);
+
+	// Faces of a closed manifold share every SharedEdge with one other Face.
+	EdgeTable edge_table(numSharedEdges() + num_new_corners / 2);
+	for (uint32_t e = 0; e < numSharedEdges(); e++)
+		edge_table.insert(edge_vertices[2 * e], edge_vertices[2 * e + 1], e);
+
+	uint32_t first_face = numFaces();
+	offset = 0;
+	for (uint32_t f = 0; f < num_faces; f++) {
+		const uint32_t* face_vertices = vertices + offset;
+		uint32_t n = sizes[f];
+		offset += n;
+		if (!isValidFace(face_vertices, n))
+			continue;
+
+		uint32_t face = addFace(numCorners(), n);
+		for (uint32_t i = 0; i < n; ++i) {
+			uint32_t a = face_vertices[i];
+			uint32_t b = face_vertices[(i + 1) % n];
+			uint32_t edge = edge_table.find(a, b);
+			if (edge == invalid_index) {
+				edge = addSharedEdge(a, b);
+				edge_table.insert(a, b, edge);
+			}
+			addCorner(face, a, edge);
+		}
+		faces[f] = face;
+	}
+	resizeCornerData();
+	triangulateFaces(first_face);
+	return faces;
+}
+
+SharedVertex Mesh::addSharedVertex(const FixedPoint::vec3f& position) {
+	return SharedVertex(this, addVertex(position));
+}
 
-	SharedEdge* edge = new SharedEdge();
-	edge->v1 = a;
-	edge->v2 = b;
-	a->shared_edges.push_back(edge);
-	b->shared_edges.push_back(edge);
-	addSharedEdge(edge);
-	return edge;
+SharedEdge Mesh::connectSharedVertices(SharedVertex a, SharedVertex b) {
+	if (!a || !b || a.mesh() != this || b.mesh() != this)
+		return SharedEdge();
+	return SharedEdge(this, connectVertices(a.index(), b.index()));
 }
 
-const std::vector<SharedVertex*>& Mesh::getSharedVertices() const {
-	return shared_vertices;
+Face Mesh::fillSharedVertices(const std::vector<SharedVertex>& list) {
+	std::vector<uint32_t> vertices;
+	vertices.reserve(list.size());
+	for (SharedVertex shared_vertex : list) {
+		if (!shared_vertex || shared_vertex.mesh() != this)
+			return Face();
+		vertices.push_back(shared_vertex.index());
+	}
+	return Face(this, fillVertices(vertices.data(), uint32_t(vertices.size())));
 }
+
 const std::vector<std::string>& Mesh::getMaterials() const {
 	return materials;
 }
 
-const std::vector<SharedEdge*>& Mesh::getSharedEdges() const {
-	return shared_edges;
+// The handles hand out mutable access like the pointers of the former object graph did.
+HandleRange<SharedVertex> Mesh::getSharedVertices() const {
+	return HandleRange<SharedVertex>(const_cast<Mesh*>(this), 0, numSharedVertices());
 }
-const std::vector<Face*>& Mesh::getFaces() const {
-	return faces;
+
+HandleRange<SharedEdge> Mesh::getSharedEdges() const {
+	return HandleRange<SharedEdge>(const_cast<Mesh*>(this), 0, numSharedEdges());
+}
+
+HandleRange<Face> Mesh::getFaces() const {
+	return HandleRange<Face>(const_cast<Mesh*>(this), 0, numFaces());
 }
 
 uint32_t Mesh::addMaterial(const std::string& material_name) {
@@ -101,93 +274,118 @@ uint32_t Mesh::addMaterial(const std::string& material_name) {
 	return static_cast<uint32_t>(materials.size() - 1);
 }
 
-SharedVertex* SharedEdge::other(SharedVertex* v) {
-	if (v == v1)
-		return v2;
-	if (v == v2)
-		return v1;
-	return nullptr;
+UvMap* Mesh::createUvMap(const std::string& uv_map_name) {
+	UvMap* uv_map = new UvMap(uv_map_name);
+	uv_map->corner_uvs.resize(numCorners(), invalid_index);
+	uv_maps.push_back(uv_map);
+	return uv_map;
 }
 
-Face* Mesh::fillSharedVertices(std::vector<SharedVertex*>& list) {
-	size_t n = list.size();
-	if (n <= 2) {
-		return nullptr;
-	}
+UvMap::UvMap(const std::string& name) : name(name) {}
 
-	for (size_t i = 0; i < n; ++i) {
+FixedPoint::vec3f& SharedVertex::position() const {
+	return mesh_->positions[index_];
+}
 
-		if (!connectSharedVertices(list[i], list[(i + 1) % n])) {
-			return nullptr;
-		}
+std::vector<Vertex> SharedVertex::vertices() const {
+	std::vector<Vertex> vertices;
+	for (uint32_t c = mesh_->vertex_corners[index_]; c != invalid_index; c = mesh_->corner_next_at_vertex[c])
+		vertices.emplace_back(mesh_, c);
+	return vertices;
+}
+
+std::vector<SharedEdge> SharedVertex::sharedEdges() const {
+	std::vector<SharedEdge> edges;
+	for (uint32_t e = mesh_->vertex_edges[index_]; e != invalid_index;) {
+		edges.emplace_back(mesh_, e);
+		e = mesh_->edge_next[2 * e + (mesh_->edge_vertices[2 * e] == index_ ? 0 : 1)];
 	}
+	return edges;
+}
 
-	Face* face = new Face();
-	face->edges.reserve(n);
+SharedVertex SharedEdge::v1() const {
+	return SharedVertex(mesh_, mesh_->edge_vertices[2 * index_]);
+}
 
-	Vertex* first_vert = nullptr;
-	Edge* prev_edge = nullptr;
+SharedVertex SharedEdge::v2() const {
+	return SharedVertex(mesh_, mesh_->edge_vertices[2 * index_ + 1]);
+}
 
-	for (size_t i = 0; i < n; ++i) {
-		SharedVertex* shared_vertex_a = list[i];
-		SharedVertex* shared_vertex_b = list[(i + 1) % n];
-		SharedEdge* shared_edge = connectSharedVertices(shared_vertex_a, shared_vertex_b);
+std::vector<Edge> SharedEdge::edges() const {
+	std::vector<Edge> edges;
+	for (uint32_t c = mesh_->edge_corners[index_]; c != invalid_index; c = mesh_->corner_next_at_edge[c])
+		edges.emplace_back(mesh_, c);
+	return edges;
+}
 
-		Vertex* v = new Vertex(uv_maps.size());
-		v->face = face;
-		v->shared_vertex = shared_vertex_a;
-		v->in = prev_edge;
+SharedVertex SharedEdge::other(SharedVertex v) const {
+	if (v == v1())
+		return v2();
+	if (v == v2())
+		return v1();
+	return SharedVertex();
+}
 
-		Edge* e = new Edge();
-		e->in = v;
-		e->out = nullptr;
-		e->shared_edge = shared_edge;
-		e->face = face;
+Face Vertex::face() const {
+	return Face(mesh_, mesh_->corner_faces[index_]);
+}
 
-		v->out = e;
+SharedVertex Vertex::sharedVertex() const {
+	return SharedVertex(mesh_, mesh_->corner_vertices[index_]);
+}
 
-		shared_vertex_a->vertices.push_back(v);
-		shared_edge->edges.push_back(e);
-		face->edges.push_back(e);
+FixedPoint::vec3f& Vertex::normal() const {
+	return mesh_->corner_normals[index_];
+}
 
-		if (!first_vert)
-			first_vert = v;
-		else
-			prev_edge->out = v;
+UvCoordinate* Vertex::uv(uint32_t uv_map) const {
+	UvMap* map = mesh_->uv_maps[uv_map];
+	uint32_t uv = map->corner_uvs[index_];
+	return uv == invalid_index ? nullptr : &map->uv_coordinates[uv];
+}
 
-		prev_edge = e;
-	}
+Edge Vertex::in() const {
+	return Edge(mesh_, mesh_->previousCorner(index_));
+}
 
-	prev_edge->out = first_vert;
-	first_vert->in = prev_edge;
-	face->updateTriangulation();
-	addFace(face);
-	return face;
+Edge Vertex::out() const {
+	return Edge(mesh_, index_);
 }
 
-UvMap* Mesh::createUvMap(const std::string& uv_map_name) {
-	UvMap* uv_map = new UvMap(uv_map_name);
-	uv_maps.push_back(uv_map);
-	return uv_map;
+Vertex Edge::in() const {
+	return Vertex(mesh_, index_);
 }
 
-UvMap::UvMap(const std::string& name) : name(name) {}
+Vertex Edge::out() const {
+	return Vertex(mesh_, mesh_->nextCorner(index_));
+}
 
-Vertex::Vertex(uint32_t num_uvs) {
-	uvs.reserve(num_uvs);
-	for (uint32_t i = 0; i < num_uvs; i++)
-		uvs.push_back(nullptr);
+SharedEdge Edge::sharedEdge() const {
+	return SharedEdge(mesh_, mesh_->corner_edges[index_]);
 }
 
-void Face::updateTriangulation() {
-	triangulation.clear();
-	uint32_t n = edges.size();
-	triangulation.reserve(3 * (n - 2));
-	for (uint32_t i = 1; i <= n - 2; ++i) {
-		triangulation.push_back(0);
-		triangulation.push_back(i);
-		triangulation.push_back(i + 1);
-	}
+Face Edge::face() const {
+	return Face(mesh_, mesh_->corner_faces[index_]);
+}
+
+uint32_t& Face::materialIndex() const {
+	return mesh_->face_materials[index_];
+}
+
+HandleRange<Edge> Face::edges() const {
+	uint32_t first = mesh_->face_corners[index_];
+	return HandleRange<Edge>(mesh_, first, first + mesh_->face_sizes[index_]);
+}
+
+std::vector<uint32_t> Face::triangulation() const {
+	uint32_t first = mesh_->face_corners[index_];
+	uint32_t begin = 3 * mesh_->face_triangles[index_];
+	uint32_t end = begin + 3 * (mesh_->face_sizes[index_] - 2);
+	std::vector<uint32_t> triangulation;
+	triangulation.reserve(end - begin);
+	for (uint32_t i = begin; i < end; i++)
+		triangulation.push_back(mesh_->triangles[i] - first);
+	return triangulation;
 }
 } // namespace mesh
 } // namespace kayo
@@ -201,6 +399,9 @@ EMSCRIPTEN_BINDINGS(KayoMeshBindings) {
 	class_<kayo::mesh::Mesh>("Mesh")
 		.property("name", &kayo::mesh::Mesh::name, return_value_policy::reference())
 		.property("materials", &kayo::mesh::Mesh::materials, return_value_policy::reference())
-		.property("uvMaps", &kayo::mesh::Mesh::uv_maps, return_value_policy::reference());
+		.property("uvMaps", &kayo::mesh::Mesh::uv_maps, return_value_policy::reference())
+		.function("getVertexAttribute", &kayo::mesh::Mesh::getVertexAttribute)
+		.function("getEdgeAttribute", &kayo::mesh::Mesh::getEdgeAttribute)
+		.function("getFaceAttribute", &kayo::mesh::Mesh::getFaceAttribute);
 	register_vector<kayo::mesh::Mesh*>("VectorMesh");
 }
\ No newline at end of file
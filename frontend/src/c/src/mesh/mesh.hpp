@@ -1,159 +1,328 @@
 #pragma once
 #include "../numerics/vec2.hpp"
 #include "../numerics/vec3.hpp"
-#include <any>
+#include "meshAttributes.hpp"
+#include <cstdint>
 #include <map>
+#include <string>
 #include <vector>
 
 namespace kayo {
 namespace mesh {
 
+/**
+ * Marks a missing element, e.g. the end of an adjacency list or a corner without a uv coordinate.
+ */
+constexpr uint32_t invalid_index = UINT32_MAX;
+
+class Mesh;
 class Vertex;
 class Edge;
 class SharedEdge;
 class SharedVertex;
 class Face;
 
-class SharedVertex {
+/**
+ * A UV coordinate that may be used by multiple Vertices.
+ */
+using UvCoordinate = FixedPoint::vec2f;
+
+class UvMap {
   public:
-	FixedPoint::vec3f position;
-	std::vector<Vertex*> vertices;
-	std::vector<SharedEdge*> shared_edges;
+	std::string name;
+	std::vector<UvCoordinate> uv_coordinates;
+	/**
+	 * The index into uv_coordinates of every corner of the Mesh, {@link invalid_index} if the corner has none.
+	 */
+	std::vector<uint32_t> corner_uvs;
+	UvMap(const std::string& name);
 };
 
-class SharedEdge {
+/**
+ * The handles of the object style API. A handle is the index of an element and the Mesh it belongs to,
+ * it stays valid as long as the Mesh is alive. A default constructed handle refers to no element and is false.
+ */
+template <typename Derived>
+class MeshHandle {
+  protected:
+	Mesh* mesh_ = nullptr;
+	uint32_t index_ = invalid_index;
+
   public:
-	std::vector<Edge*> edges;
-	SharedVertex* v1;
-	SharedVertex* v2;
-	std::map<uint32_t, std::any> attributes;
-	SharedVertex* other(SharedVertex*);
+	MeshHandle() = default;
+	MeshHandle(Mesh* mesh, uint32_t index) : mesh_(mesh), index_(index) {}
+	Mesh* mesh() const { return mesh_; }
+	uint32_t index() const { return index_; }
+	explicit operator bool() const { return mesh_ && index_ != invalid_index; }
+	bool operator==(const MeshHandle& other) const = default;
 };
 
 /**
- * A UV coordinate that may be used by multiple Vertices.
+ * The handles of the elements index_begin to index_end of a Mesh, for range based for loops.
  */
-using UvCoordinate = FixedPoint::vec2f;
+template <typename H>
+class HandleRange {
+  private:
+	Mesh* mesh;
+	uint32_t index_begin;
+	uint32_t index_end;
+
+  public:
+	class iterator {
+	  private:
+		Mesh* mesh;
+		uint32_t index;
+
+	  public:
+		iterator(Mesh* mesh, uint32_t index) : mesh(mesh), index(index) {}
+		H operator*() const { return H(mesh, index); }
+		iterator& operator++() {
+			index++;
+			return *this;
+		}
+		bool operator!=(const iterator& other) const { return index != other.index; }
+	};
+	HandleRange(Mesh* mesh, uint32_t index_begin, uint32_t index_end) : mesh(mesh), index_begin(index_begin), index_end(index_end) {}
+	iterator begin() const { return iterator(mesh, index_begin); }
+	iterator end() const { return iterator(mesh, index_end); }
+	uint32_t size() const { return index_end - index_begin; }
+	H operator[](uint32_t i) const { return H(mesh, index_begin + i); }
+};
 
-class Vertex {
+class SharedVertex : public MeshHandle<SharedVertex> {
   public:
-	Vertex(uint32_t num_uvs);
+	using MeshHandle::MeshHandle;
+	FixedPoint::vec3f& position() const;
 	/**
-	 * The face the vertex belongs to.
-	 * Shall not be nullptr.
+	 * The Vertices of all Faces using this SharedVertex.
 	 */
-	Face* face;
+	std::vector<Vertex> vertices() const;
+	std::vector<SharedEdge> sharedEdges() const;
+};
+
+class SharedEdge : public MeshHandle<SharedEdge> {
+  public:
+	using MeshHandle::MeshHandle;
+	SharedVertex v1() const;
+	SharedVertex v2() const;
 	/**
-	 * The shared vertex the vertex belongs to.
-	 * Shall not be nullptr.
+	 * The Edges of all Faces using this SharedEdge.
 	 */
-	SharedVertex* shared_vertex;
+	std::vector<Edge> edges() const;
+	SharedVertex other(SharedVertex) const;
+};
+
+/**
+ * The corner of a Face at one of its SharedVertices. Vertices and Edges share their indices:
+ * Edge i starts at Vertex i and ends at the next Vertex of the Face.
+ */
+class Vertex : public MeshHandle<Vertex> {
+  public:
+	using MeshHandle::MeshHandle;
+	Face face() const;
+	SharedVertex sharedVertex() const;
 	/**
 	 * The object space normal of this Vertex.
 	 */
-	FixedPoint::vec3f normal;
+	FixedPoint::vec3f& normal() const;
 	/**
-	 * The size shall be equal to the number of uv_maps in the Mesh this Vertex belongs to.
+	 * The uv coordinate of this Vertex in a UvMap of the Mesh, nullptr if it has none.
 	 */
-	std::vector<UvCoordinate*> uvs;
+	UvCoordinate* uv(uint32_t uv_map) const;
 	/**
-	 * The incomming Edge.
-	 * This Vertex shall be the outgoing Vertex of that Edge.
+	 * The incomming Edge. This Vertex is the outgoing Vertex of that Edge.
 	 */
-	Edge* in;
+	Edge in() const;
 	/**
-	 * The outgoing Edge.
-	 * This Vertex ahll be the incomming Vertex of that Edge.
+	 * The outgoing Edge. This Vertex is the incomming Vertex of that Edge.
 	 */
-	Edge* out;
-	/**
-	 * Optional custom vertex attributes of this Vertex.
-	 */
-	std::map<uint32_t, std::any> attributes;
+	Edge out() const;
 };
 
 /**
  * From a data structure perspective Edges sit between Faces and SharedEdges.
  * They make up the Face.
  */
-class Edge {
+class Edge : public MeshHandle<Edge> {
   public:
+	using MeshHandle::MeshHandle;
 	/**
 	 * The Vertex going into this Edge. (First Vertex)
 	 */
-	Vertex* in;
+	Vertex in() const;
 	/**
 	 * The Vertex going out of the Edge. (Second Vertex)
 	 */
-	Vertex* out;
-	/**
-	 * The SharedEdge this Edge belongs to.
-	 */
-	SharedEdge* shared_edge;
-	/**
-	 * The Face this Edge belongs to.
-	 */
-	Face* face;
+	Vertex out() const;
+	SharedEdge sharedEdge() const;
+	Face face() const;
 };
 
-class Face {
+class Face : public MeshHandle<Face> {
   public:
+	using MeshHandle::MeshHandle;
 	/**
-	 * The index of the Material in the materials list of the Mesh this Face belongs to
-	 * that shall be used to render this Face.
+	 * The index of the Material in the materials list of the Mesh that shall be used to render this Face.
 	 */
-	uint32_t material_index;
+	uint32_t& materialIndex() const;
 	/**
 	 * The (CCW) Edges making up this Face.
 	 */
-	std::vector<Edge*> edges;
+	HandleRange<Edge> edges() const;
 	/**
-	 * The cached triangulation of this Face.
+	 * The cached triangulation of this Face as indices into {@link edges}.
 	 */
-	std::vector<uint32_t> triangulation;
-	/**
-	 * Optional custom Face attributes of this Face.
-	 */
-	std::map<uint32_t, std::any> attributes;
-	void updateTriangulation();
-};
-
-class UvMap {
-  public:
-	std::string name;
-	std::vector<UvCoordinate*> uv_coordinates;
-	UvMap(const std::string& name);
+	std::vector<uint32_t> triangulation() const;
 };
 
+/**
+ * A polygon mesh stored as arrays indexed by 32 bit element indices.
+ *
+ * SharedVertices are the points of the mesh. Every Face has one corner per SharedVertex it uses,
+ * stored contiguously in Face order, and every corner starts the Edge to the next corner of its Face.
+ * SharedEdges connect two SharedVertices and are used by the Edges of any number of Faces.
+ * Adjacency is kept in intrusive singly linked lists, see {@link vertex_edges}, {@link edge_corners} and {@link vertex_corners}.
+ * Custom attributes are typed columns in {@link vertex_attributes}, {@link edge_attributes} and {@link face_attributes}.
+ *
+ * The handle classes above expose the elements in the object style of the former pointer based Mesh.
+ */
 class Mesh {
   private:
-	std::map<std::string, uint32_t> vertex_attributes;
-	std::map<std::string, uint32_t> edge_attributes;
-	std::map<std::string, uint32_t> face_attributes;
-	std::vector<SharedVertex*> shared_vertices;
-	std::vector<SharedEdge*> shared_edges;
-	std::vector<Face*> faces;
-	bool addSharedEdge(SharedEdge*);
-	bool addFace(Face*);
+	uint32_t addSharedEdge(uint32_t v1, uint32_t v2);
+	uint32_t addFace(uint32_t first_corner, uint32_t num_vertices);
+	void addCorner(uint32_t face, uint32_t vertex, uint32_t edge);
+	void resizeCornerData();
 
   public:
 	std::string name;
 	std::vector<std::string> materials;
 	std::vector<UvMap*> uv_maps;
-	bool addSharedVertex(SharedVertex*);
+
+	/**
+	 * SharedVertex data.
+	 */
+	std::vector<FixedPoint::vec3f> positions;
+	/**
+	 * The first SharedEdge of a SharedVertex, the list continues in {@link edge_next}.
+	 */
+	std::vector<uint32_t> vertex_edges;
+	/**
+	 * The first corner at a SharedVertex, the list continues in {@link corner_next_at_vertex}.
+	 */
+	std::vector<uint32_t> vertex_corners;
+
+	/**
+	 * The SharedVertices of a SharedEdge, two per SharedEdge.
+	 */
+	std::vector<uint32_t> edge_vertices;
+	/**
+	 * The next SharedEdge around each of the two SharedVertices of a SharedEdge, two per SharedEdge.
+	 */
+	std::vector<uint32_t> edge_next;
+	/**
+	 * The first corner whose Edge uses a SharedEdge, the list continues in {@link corner_next_at_edge}.
+	 */
+	std::vector<uint32_t> edge_corners;
+	AttributeLayers edge_attributes;
+
+	/**
+	 * Corner data, which is the data of Vertices and Edges.
+	 */
+	std::vector<uint32_t> corner_vertices;
+	std::vector<uint32_t> corner_edges;
+	std::vector<uint32_t> corner_faces;
+	std::vector<uint32_t> corner_next_at_vertex;
+	std::vector<uint32_t> corner_next_at_edge;
+	std::vector<FixedPoint::vec3f> corner_normals;
+	/**
+	 * The custom attributes of Vertices, one element per corner.
+	 */
+	AttributeLayers vertex_attributes;
+
+	/**
+	 * The first corner of a Face.
+	 */
+	std::vector<uint32_t> face_corners;
+	std::vector<uint32_t> face_sizes;
+	std::vector<uint32_t> face_materials;
+	/**
+	 * The first triangle of a Face in {@link triangles}.
+	 */
+	std::vector<uint32_t> face_triangles;
+	AttributeLayers face_attributes;
+	/**
+	 * The corners of the triangulations of all Faces, three per triangle.
+	 */
+	std::vector<uint32_t> triangles;
+
+	Mesh() = default;
+	Mesh(const Mesh&) = delete;
+	Mesh& operator=(const Mesh&) = delete;
+	~Mesh();
+
+	uint32_t numSharedVertices() const { return uint32_t(positions.size()); }
+	uint32_t numSharedEdges() const { return uint32_t(edge_corners.size()); }
+	uint32_t numCorners() const { return uint32_t(corner_vertices.size()); }
+	uint32_t numFaces() const { return uint32_t(face_corners.size()); }
+	/**
+	 * The corner after a corner within its Face.
+	 */
+	uint32_t nextCorner(uint32_t corner) const {
+		uint32_t face = corner_faces[corner];
+		return corner + 1 == face_corners[face] + face_sizes[face] ? face_corners[face] : corner + 1;
+	}
+	uint32_t previousCorner(uint32_t corner) const {
+		uint32_t face = corner_faces[corner];
+		return corner == face_corners[face] ? corner + face_sizes[face] - 1 : corner - 1;
+	}
+
+	uint32_t addVertex(const FixedPoint::vec3f& position);
+	/**
+	 * @returns The SharedEdge between two SharedVertices, which is created if it does not exist yet.
+	 * {@link invalid_index} if both are the same.
+	 */
+	uint32_t connectVertices(uint32_t a, uint32_t b);
+	/**
+	 * @returns The SharedEdge between two SharedVertices or {@link invalid_index}.
+	 */
+	uint32_t findEdge(uint32_t a, uint32_t b) const;
+	/**
+	 * Creates a Face with a corner for every SharedVertex in order and connects all consecutive SharedVertices.
+	 * @returns The new Face or {@link invalid_index} for less than 3 SharedVertices or consecutive equal ones.
+	 */
+	uint32_t fillVertices(const uint32_t* vertices, uint32_t num_vertices);
+	/**
+	 * Creates many Faces at once from an index buffer, in time linear in the number of corners.
+	 * SharedEdges are looked up in a hash table instead of the adjacency lists, so high valence SharedVertices stay cheap.
+	 * Faces are skipped for the same reasons as in {@link fillVertices}.
+	 * @param vertices The SharedVertices of all Faces, sizes[i] consecutive ones for Face i.
+	 * @returns The Face created for every input Face, {@link invalid_index} for skipped ones.
+	 */
+	std::vector<uint32_t> fillFaces(const uint32_t* vertices, const uint32_t* sizes, uint32_t num_faces);
+	/**
+	 * Appends the triangulations of the Faces from first_face on to {@link triangles}, those Faces must not have one yet.
+	 * Each Face is projected onto its best fit plane. Quads are split along the diagonal through a reflex corner if there is one,
+	 * larger Faces are ear clipped. Many Faces are triangulated in batches on worker threads, so call it off the main thread.
+	 */
+	void triangulateFaces(uint32_t first_face);
+
+	SharedVertex addSharedVertex(const FixedPoint::vec3f& position);
 	UvMap* createUvMap(const std::string& uv_map_name);
-	SharedEdge* connectSharedVertices(SharedVertex*, SharedVertex*);
-	Face* fillSharedVertices(std::vector<SharedVertex*>&);
+	SharedEdge connectSharedVertices(SharedVertex, SharedVertex);
+	Face fillSharedVertices(const std::vector<SharedVertex>&);
 	uint32_t addMaterial(const std::string& material_name);
 
 	const std::vector<std::string>& getMaterials() const;
-	const std::vector<SharedVertex*>& getSharedVertices() const;
-	const std::vector<SharedEdge*>& getSharedEdges() const;
-	const std::vector<Face*>& getFaces() const;
+	HandleRange<SharedVertex> getSharedVertices() const;
+	HandleRange<SharedEdge> getSharedEdges() const;
+	HandleRange<Face> getFaces() const;
 
-	uint32_t ensureVertexAttribute(const std::string& attrib_name);
-	uint32_t ensureEdgeAttribute(const std::string& attrib_name);
-	uint32_t ensureFaceAttribute(const std::string& attrib_name);
+	uint32_t ensureVertexAttribute(const std::string& attrib_name, AttributeType type);
+	uint32_t ensureEdgeAttribute(const std::string& attrib_name, AttributeType type);
+	uint32_t ensureFaceAttribute(const std::string& attrib_name, AttributeType type);
+	emscripten::val getVertexAttribute(const std::string& attrib_name) const;
+	emscripten::val getEdgeAttribute(const std::string& attrib_name) const;
+	emscripten::val getFaceAttribute(const std::string& attrib_name) const;
 };
 } // namespace mesh
 } // namespace kayo
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "meshAttributes.hpp"
+#include <emscripten/bind.h>
+#include <stdexcept>
+
+namespace kayo {
+namespace mesh {
+
+AttributeColumn::AttributeColumn(std::string name, AttributeType type) : name(std::move(name)), type(type) {}
+
+void AttributeColumn::resize(uint32_t size) {
+	uint32_t wordsPerElement = attributeWords(type);
+	if (type == AttributeType::boolean) {
+		// Clear the bits past the end, so they are zero when the column grows again.
+		if (size < num_elements && (size & 31) != 0)
+			words[size >> 5] &= (uint32_t(1) << (size & 31)) - 1;
+		words.resize((size_t(size) + 31) / 32, 0);
+	} else {
+		words.resize(size_t(size) * wordsPerElement, 0);
+	}
+	num_elements = size;
+}
+
+emscripten::val AttributeColumn::view() const {
+	switch (type) {
+	case AttributeType::boolean:
+		return emscripten::val(emscripten::typed_memory_view(words.size(), words.data()));
+	case AttributeType::int32:
+		return emscripten::val(emscripten::typed_memory_view(words.size(), reinterpret_cast<const int32_t*>(words.data())));
+	default:
+		return emscripten::val(emscripten::typed_memory_view(words.size(), reinterpret_cast<const float*>(words.data())));
+	}
+}
+
+uint32_t AttributeLayers::ensure(const std::string& name, AttributeType type) {
+	auto it = ids.find(name);
+	if (it != ids.end()) {
+		if (columns[it->second].type != type)
+			throw std::runtime_error("The attribute " + name + " already exists with a different type.");
+		return it->second;
+	}
+	uint32_t id = uint32_t(columns.size());
+	columns.emplace_back(name, type);
+	columns.back().resize(num_elements);
+	ids.emplace(name, id);
+	return id;
+}
+
+uint32_t AttributeLayers::find(const std::string& name) const {
+	auto it = ids.find(name);
+	return it == ids.end() ? UINT32_MAX : it->second;
+}
+
+void AttributeLayers::remove(const std::string& name) {
+	auto it = ids.find(name);
+	if (it == ids.end())
+		return;
+	uint32_t id = it->second;
+	columns.erase(columns.begin() + id);
+	ids.erase(it);
+	for (auto& [other, otherId] : ids) {
+		if (otherId > id)
+			otherId--;
+	}
+}
+
+void AttributeLayers::resize(uint32_t size) {
+	for (AttributeColumn& column : columns)
+		column.resize(size);
+	num_elements = size;
+}
+
+std::vector<std::string> AttributeLayers::names() const {
+	std::vector<std::string> names;
+	names.reserve(columns.size());
+	for (const AttributeColumn& column : columns)
+		names.push_back(column.name);
+	return names;
+}
+
+emscripten::val AttributeLayers::view(const std::string& name) const {
+	uint32_t id = find(name);
+	if (id == UINT32_MAX)
+		return emscripten::val::undefined();
+	return columns[id].view();
+}
+
+} // namespace mesh
+} // namespace kayo
+
+using namespace emscripten;
+EMSCRIPTEN_BINDINGS(KayoMeshAttributes) {
+	enum_<kayo::mesh::AttributeType>("MeshAttributeType")
+		.value("boolean", kayo::mesh::AttributeType::boolean)
+		.value("int32", kayo::mesh::AttributeType::int32)
+		.value("float32", kayo::mesh::AttributeType::float32)
+		.value("vec2", kayo::mesh::AttributeType::vec2)
+		.value("vec3", kayo::mesh::AttributeType::vec3)
+		.value("vec4", kayo::mesh::AttributeType::vec4);
+}
\ No newline at end of file
@@ -0,0 +1,124 @@
+#pragma once
+#include <cstdint>
+#include <emscripten/val.h>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace kayo {
+namespace mesh {
+
+enum class AttributeType : uint8_t {
+	/**
+	 * One bit per element.
+	 */
+	boolean,
+	int32,
+	float32,
+	vec2,
+	vec3,
+	vec4,
+};
+
+/**
+ * The 32 bit words an element of a type occupies, 0 for the bits of {@link AttributeType::boolean}.
+ */
+constexpr uint32_t attributeWords(AttributeType type) {
+	switch (type) {
+	case AttributeType::boolean:
+		return 0;
+	case AttributeType::int32:
+	case AttributeType::float32:
+		return 1;
+	case AttributeType::vec2:
+		return 2;
+	case AttributeType::vec3:
+		return 3;
+	case AttributeType::vec4:
+		return 4;
+	}
+	return 0;
+}
+
+/**
+ * The values of one custom attribute for all elements of a kind, e.g. all faces of a Mesh, stored contiguously.
+ * Booleans are packed into a bitset, bit i % 32 of word i / 32 belongs to element i.
+ * New elements are zero.
+ */
+class AttributeColumn {
+  private:
+	std::vector<uint32_t> words;
+	uint32_t num_elements = 0;
+
+  public:
+	std::string name;
+	AttributeType type;
+
+	AttributeColumn(std::string name, AttributeType type);
+	uint32_t size() const { return num_elements; }
+	void resize(uint32_t size);
+
+	bool getBool(uint32_t i) const { return (words[i >> 5] >> (i & 31)) & 1; }
+	void setBool(uint32_t i, bool value) {
+		if (value)
+			words[i >> 5] |= uint32_t(1) << (i & 31);
+		else
+			words[i >> 5] &= ~(uint32_t(1) << (i & 31));
+	}
+	/**
+	 * The values of a column of a 32 bit type: int32_t, float or a float vector matching the type of the column.
+	 */
+	template <typename T>
+	T* data() {
+		static_assert(sizeof(T) % sizeof(uint32_t) == 0);
+		return reinterpret_cast<T*>(words.data());
+	}
+	template <typename T>
+	const T* data() const {
+		static_assert(sizeof(T) % sizeof(uint32_t) == 0);
+		return reinterpret_cast<const T*>(words.data());
+	}
+	/**
+	 * A view of the values for JS: an Uint32Array of the bits of booleans, an Int32Array or a Float32Array with the components of all elements.
+	 * The view is invalidated when elements are added.
+	 */
+	emscripten::val view() const;
+};
+
+/**
+ * The custom attributes of one kind of element, which grow with the elements.
+ * Adding or removing a column invalidates references to the columns.
+ */
+class AttributeLayers {
+  private:
+	std::vector<AttributeColumn> columns;
+	std::map<std::string, uint32_t> ids;
+	uint32_t num_elements = 0;
+
+  public:
+	/**
+	 * @returns The id of the column with the name, which is added if it does not exist yet.
+	 * Throws if the column exists with a different type.
+	 */
+	uint32_t ensure(const std::string& name, AttributeType type);
+	/**
+	 * @returns The id of the column with the name or UINT32_MAX.
+	 */
+	uint32_t find(const std::string& name) const;
+	/**
+	 * Removes a column. The ids of the following columns decrease by one.
+	 */
+	void remove(const std::string& name);
+	AttributeColumn& operator[](uint32_t id) { return columns[id]; }
+	const AttributeColumn& operator[](uint32_t id) const { return columns[id]; }
+	uint32_t size() const { return uint32_t(columns.size()); }
+	void resize(uint32_t size);
+	std::vector<std::string> names() const;
+	/**
+	 * The {@link AttributeColumn::view} of the column with the name, undefined if there is none.
+	 */
+	emscripten::val view(const std::string& name) const;
+};
+
+} // namespace mesh
+} // namespace kayo
\ No newline at end of file
@@ -25,10 +25,51 @@ class VertexBuffer {
 	void updateBytes();
 	void clear();
 };
+class IndexBuffer {
+  public:
+	/**
+	 * The GPUIndexFormat, "uint16" if all vertices can be addressed with it and "uint32" otherwise.
+	 */
+	std::string format;
+	void* data = nullptr;
+	uint32_t num_indices = 0;
+	/**
+	 * The bytes of the indices, padded to a multiple of 4 as GPU buffer writes require.
+	 */
+	uint32_t bytes_total = 0;
+	kayo::memUtils::KayoPointer dataJS() const;
+	void clear();
+};
+/**
+ * The triangles using one Material of the Mesh. first and count are indices into the IndexBuffer,
+ * or vertices if the RealtimeData is not indexed.
+ */
+struct DrawRange {
+	uint32_t material;
+	uint32_t first;
+	uint32_t count;
+};
 class RealtimeData {
+  private:
+	std::vector<uint32_t> sortTrianglesByMaterial();
+	void buildVertexStreams(const std::vector<uint32_t>& corners);
+
   public:
 	kayo::mesh::Mesh* mesh;
-	RealtimeData(kayo::mesh::Mesh* mesh);
+	/**
+	 * Whether corners with equal position, normal and uv share a vertex, which the triangles refer to through {@link indices}.
+	 * Otherwise every corner of every triangle has its own vertex.
+	 */
+	bool indexed;
+	RealtimeData(kayo::mesh::Mesh* mesh, bool indexed = true);
+	/**
+	 * Whether the indexed build of the Mesh takes longer than a frame, about 12 ms on the main thread,
+	 * so it should run in a {@link BuildRealtimeDataTask} while a non-indexed RealtimeData is drawn.
+	 */
+	static bool indexInTask(const kayo::mesh::Mesh* mesh);
+	RealtimeData(const RealtimeData&) = delete;
+	RealtimeData& operator=(const RealtimeData&) = delete;
+	~RealtimeData();
 	void build();
 	/**
 	 * Object space vertex position
@@ -42,6 +83,11 @@ class RealtimeData {
 	 * Object space Normal, *(Tangant, Bitangent)
 	 */
 	VertexBuffer tangent_space;
+	/**
+	 * The triangles, ordered by Material and for the post transform vertex cache. Empty if not {@link indexed}.
+	 */
+	IndexBuffer indices;
+	std::vector<DrawRange> draw_ranges;
 };
 } // namespace mesh
 } // namespace kayo
\ No newline at end of file
@@ -0,0 +1,161 @@
+#include "mesh.hpp"
+#include "../task/workerPool.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace kayo {
+namespace mesh {
+
+namespace {
+constexpr uint32_t faces_per_batch = 4096;
+
+/**
+ * The buffers a thread reuses for all Faces it triangulates.
+ */
+struct TriangulationScratch {
+	std::vector<FixedPoint::vec2f> points;
+	std::vector<uint32_t> prev;
+	std::vector<uint32_t> next;
+};
+
+/**
+ * Twice the signed area of the 2D triangle a b c, positive if it is counterclockwise.
+ */
+float area2(const FixedPoint::vec2f& a, const FixedPoint::vec2f& b, const FixedPoint::vec2f& c) {
+	return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+bool inTriangle(const FixedPoint::vec2f& p, const FixedPoint::vec2f& a, const FixedPoint::vec2f& b, const FixedPoint::vec2f& c) {
+	return area2(a, b, p) >= 0.0f && area2(b, c, p) >= 0.0f && area2(c, a, p) >= 0.0f;
+}
+
+/**
+ * Projects the corners of a Face onto the plane through the Newell normal, so that the Face is counterclockwise in 2D.
+ * @returns False if the Face has no area.
+ */
+bool projectFace(const Mesh& mesh, uint32_t first, uint32_t n, std::vector<FixedPoint::vec2f>& points) {
+	FixedPoint::vec3f normal(0.0f);
+	for (uint32_t i = 0; i < n; i++) {
+		const FixedPoint::vec3f& a = mesh.positions[mesh.corner_vertices[first + i]];
+		const FixedPoint::vec3f& b = mesh.positions[mesh.corner_vertices[first + (i + 1) % n]];
+		normal.x += (a.y - b.y) * (a.z + b.z);
+		normal.y += (a.z - b.z) * (a.x + b.x);
+		normal.z += (a.x - b.x) * (a.y + b.y);
+	}
+	float length = std::sqrt(normal.dot(normal));
+	if (!(length > 0.0f))
+		return false;
+	normal = normal / length;
+
+	// Any axis not parallel to the normal spans the plane together with it.
+	FixedPoint::vec3f axis(0.0f);
+	float ax = std::abs(normal.x), ay = std::abs(normal.y), az = std::abs(normal.z);
+	axis[ax <= ay && ax <= az ? 0 : (ay <= az ? 1 : 2)] = 1.0f;
+	FixedPoint::vec3f u = axis.cross(normal);
+	u = u / std::sqrt(u.dot(u));
+	FixedPoint::vec3f v = normal.cross(u);
+
+	points.resize(n);
+	for (uint32_t i = 0; i < n; i++) {
+		const FixedPoint::vec3f& p = mesh.positions[mesh.corner_vertices[first + i]];
+		points[i] = FixedPoint::vec2f(p.dot(u), p.dot(v));
+	}
+	return true;
+}
+
+/**
+ * Ear clipping in O(n²) per Face. If no ear is left, which only happens for self intersecting Faces, the next corner is clipped anyway.
+ */
+void clipEars(uint32_t first, uint32_t n, TriangulationScratch& scratch, uint32_t* out) {
+	const std::vector<FixedPoint::vec2f>& points = scratch.points;
+	std::vector<uint32_t>& prev = scratch.prev;
+	std::vector<uint32_t>& next = scratch.next;
+	prev.resize(n);
+	next.resize(n);
+	for (uint32_t i = 0; i < n; i++) {
+		prev[i] = (i + n - 1) % n;
+		next[i] = (i + 1) % n;
+	}
+
+	uint32_t remaining = n;
+	uint32_t i = 0;
+	uint32_t misses = 0;
+	while (remaining > 3) {
+		uint32_t a = prev[i];
+		uint32_t c = next[i];
+		bool ear = area2(points[a], points[i], points[c]) > 0.0f;
+		for (uint32_t j = next[c]; ear && j != a; j = next[j])
+			ear = !inTriangle(points[j], points[a], points[i], points[c]);
+
+		if (!ear && ++misses < remaining) {
+			i = c;
+			continue;
+		}
+		*out++ = first + a;
+		*out++ = first + i;
+		*out++ = first + c;
+		next[a] = c;
+		prev[c] = a;
+		remaining--;
+		misses = 0;
+		i = c;
+	}
+	*out++ = first + prev[i];
+	*out++ = first + i;
+	*out++ = first + next[i];
+}
+
+void triangulateFace(Mesh& mesh, uint32_t face, TriangulationScratch& scratch) {
+	uint32_t first = mesh.face_corners[face];
+	uint32_t n = mesh.face_sizes[face];
+	uint32_t* out = mesh.triangles.data() + 3 * size_t(mesh.face_triangles[face]);
+
+	if (n > 3 && projectFace(mesh, first, n, scratch.points)) {
+		const std::vector<FixedPoint::vec2f>& points = scratch.points;
+		if (n > 4) {
+			clipEars(first, n, scratch, out);
+			return;
+		}
+		// A concave quad has to be split along the diagonal through its reflex corner.
+		if (area2(points[0], points[1], points[2]) <= 0.0f || area2(points[2], points[3], points[0]) <= 0.0f) {
+			uint32_t quad[6] = {1, 2, 3, 1, 3, 0};
+			for (uint32_t i = 0; i < 6; i++)
+				out[i] = first + quad[i];
+			return;
+		}
+	}
+	for (uint32_t i = 1; i <= n - 2; ++i) {
+		*out++ = first;
+		*out++ = first + i;
+		*out++ = first + i + 1;
+	}
+}
+
+} // namespace
+
+void Mesh::triangulateFaces(uint32_t first_face) {
+	uint32_t num_faces = numFaces();
+	if (first_face >= num_faces)
+		return;
+
+	// Every Face of n corners has n - 2 triangles, so their positions are known before triangulating.
+	uint32_t num_triangles = uint32_t(triangles.size() / 3);
+	face_triangles.resize(num_faces);
+	for (uint32_t face = first_face; face < num_faces; face++) {
+		face_triangles[face] = num_triangles;
+		num_triangles += face_sizes[face] - 2;
+	}
+	triangles.resize(3 * size_t(num_triangles));
+
+	// Every batch gets its own scratch buffers, which are small next to the faces of a batch.
+	uint32_t num_batches = (num_faces - first_face + faces_per_batch - 1) / faces_per_batch;
+	WorkerPool::shared().parallelFor(num_batches, [this, first_face, num_faces](uint32_t batch) {
+		TriangulationScratch scratch;
+		uint32_t begin = first_face + batch * faces_per_batch;
+		uint32_t end = std::min(num_faces, begin + faces_per_batch);
+		for (uint32_t face = begin; face < end; face++)
+			triangulateFace(*this, face, scratch);
+	});
+}
+} // namespace mesh
+} // namespace kayo
\ No newline at end of file
@@ -0,0 +1,28 @@
+#include "bitUnpack.hpp"
+#include <array>
+#include <utility>
+
+namespace kayo {
+namespace minecraft {
+
+using UnpackKernel = void (*)(const uint64_t*, uint16_t*, uint32_t);
+
+template <PackedLayout Layout, size_t... I>
+static constexpr std::array<UnpackKernel, sizeof...(I)> kernelTable(std::index_sequence<I...>) {
+	return {&unpackIndices<uint8_t(I + 4), Layout>...};
+}
+
+static constexpr auto paddedKernels = kernelTable<PackedLayout::Padded>(std::make_index_sequence<12>());
+static constexpr auto tightKernels = kernelTable<PackedLayout::Tight>(std::make_index_sequence<12>());
+
+void unpackIndices(const uint64_t* data, uint8_t bits, PackedLayout layout, uint16_t* out, uint32_t count) {
+	if (bits < 4 || bits > 15) {
+		unpackIndicesScalar(data, bits, layout, out, 0, count);
+		return;
+	}
+	const auto& kernels = layout == PackedLayout::Padded ? paddedKernels : tightKernels;
+	kernels[bits - 4](data, out, count);
+}
+
+} // namespace minecraft
+} // namespace kayo
\ No newline at end of file
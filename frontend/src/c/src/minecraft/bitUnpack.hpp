@@ -0,0 +1,178 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#elif defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+/**
+ * Expansion of bit packed palette indices (block states, biomes) into uint16 arrays.
+ * The widths 4 to 15 have compile time specialized kernels using wasm SIMD128 on the WASM build and SSE4.1 on native x86 builds.
+ * All other widths and targets without SIMD use {@link unpackIndicesScalar}.
+ */
+namespace kayo {
+namespace minecraft {
+
+enum class PackedLayout : uint8_t {
+	/**
+	 * Since 1.16: indices never span two longs, the unused high bits of each long are padding.
+	 */
+	Padded,
+	/**
+	 * Before 1.16: the indices form one continuous little endian bit stream across all longs.
+	 */
+	Tight,
+};
+
+/**
+ * The number of longs needed to store count indices of the given width.
+ */
+constexpr uint32_t packedLongCount(uint8_t bits, PackedLayout layout, uint32_t count) {
+	if (layout == PackedLayout::Padded) {
+		uint32_t perLong = 64u / bits;
+		return (count + perLong - 1) / perLong;
+	}
+	return uint32_t((uint64_t(count) * bits + 63) / 64);
+}
+
+/**
+ * Expands the indices [begin, end) of data into out[begin, end). Supports every width from 1 to 16.
+ */
+inline void unpackIndicesScalar(const uint64_t* data, uint8_t bits, PackedLayout layout, uint16_t* out, uint32_t begin, uint32_t end) {
+	const uint64_t mask = (uint64_t(1) << bits) - 1;
+	const bool padded = layout == PackedLayout::Padded;
+	size_t word;
+	uint32_t shift;
+	if (padded) {
+		uint32_t perLong = 64u / bits;
+		word = begin / perLong;
+		shift = (begin % perLong) * bits;
+	} else {
+		uint64_t bit = uint64_t(begin) * bits;
+		word = size_t(bit / 64);
+		shift = uint32_t(bit % 64);
+	}
+
+	for (uint32_t i = begin; i < end; i++) {
+		if (padded && shift + bits > 64) {
+			word++;
+			shift = 0;
+		}
+		uint64_t value = data[word] >> shift;
+		if (!padded && shift + bits > 64)
+			value |= data[word + 1] << (64 - shift);
+		out[i] = uint16_t(value & mask);
+		shift += bits;
+		if (shift >= 64) {
+			word++;
+			shift -= 64;
+		}
+	}
+}
+
+namespace bitUnpack {
+
+/**
+ * The compile time layout of one SIMD step for a width and layout.
+ * A step loads two 16 byte vectors. For the tight layout every load covers 8 indices (Bits bytes),
+ * for the padded layout every load covers two longs.
+ * Each 32 bit lane gathers the 3 bytes holding its index with a byte shuffle.
+ * Multiplying by 2^(7 - shift) and shifting right by 7 then aligns all lanes with one constant shift.
+ */
+template <uint8_t Bits, PackedLayout Layout>
+struct Plan {
+	static_assert(Bits >= 4 && Bits <= 15, "There are SIMD kernels for 4 to 15 bits per index only.");
+	static constexpr uint32_t per_long = 64u / Bits;
+	static constexpr uint32_t load_stride = Layout == PackedLayout::Tight ? Bits : 16u;
+	static constexpr uint32_t indices_per_load = Layout == PackedLayout::Tight ? 8u : 2u * per_long;
+	/**
+	 * Always even, so the 32 bit lanes can be narrowed to 16 bits pairwise.
+	 */
+	static constexpr uint32_t vectors_per_load = (indices_per_load + 7) / 8 * 2;
+	static constexpr uint32_t indices_per_step = 2 * indices_per_load;
+	static constexpr uint32_t bytes_per_step = 2 * load_stride;
+	/**
+	 * The last load of a step may write up to a full vector pair past its indices.
+	 */
+	static constexpr uint32_t written_per_step = indices_per_load + vectors_per_load * 4;
+	static constexpr uint32_t read_per_step = load_stride + 16;
+
+	struct Tables {
+		alignas(16) uint8_t shuffle[vectors_per_load][16];
+		alignas(16) uint32_t multiplier[vectors_per_load][4];
+	};
+
+	static constexpr Tables build() {
+		Tables tables{};
+		for (uint32_t lane = 0; lane < vectors_per_load * 4; lane++) {
+			uint8_t* shuffle = tables.shuffle[lane / 4] + (lane % 4) * 4;
+			uint32_t bit = Layout == PackedLayout::Tight ? lane * Bits : (lane / per_long) * 64 + (lane % per_long) * Bits;
+			uint32_t byte = bit / 8;
+			for (uint32_t k = 0; k < 4; k++)
+				shuffle[k] = lane < indices_per_load && k < 3 && byte + k < 16 ? uint8_t(byte + k) : uint8_t(0x80);
+			tables.multiplier[lane / 4][lane % 4] = uint32_t(1) << (7 - bit % 8);
+		}
+		return tables;
+	}
+	static constexpr Tables tables = build();
+};
+
+} // namespace bitUnpack
+
+/**
+ * Expands count indices of Bits bits from data into out.
+ * data has to hold {@link packedLongCount} longs, it does not need to be aligned.
+ */
+template <uint8_t Bits, PackedLayout Layout>
+void unpackIndices(const uint64_t* data, uint16_t* out, uint32_t count) {
+	uint32_t i = 0;
+#if defined(__wasm_simd128__) || defined(__SSE4_1__)
+	using Plan = bitUnpack::Plan<Bits, Layout>;
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+	const size_t byteLength = size_t(packedLongCount(Bits, Layout, count)) * 8;
+	size_t position = 0;
+#if defined(__wasm_simd128__)
+	const v128_t mask = wasm_i32x4_splat((1 << Bits) - 1);
+	for (; i + Plan::written_per_step <= count && position + Plan::read_per_step <= byteLength; i += Plan::indices_per_step, position += Plan::bytes_per_step) {
+		for (uint32_t load = 0; load < 2; load++) {
+			const v128_t source = wasm_v128_load(bytes + position + load * Plan::load_stride);
+			uint16_t* target = out + i + load * Plan::indices_per_load;
+			for (uint32_t v = 0; v < Plan::vectors_per_load; v += 2) {
+				v128_t low = wasm_i8x16_swizzle(source, wasm_v128_load(Plan::tables.shuffle[v]));
+				v128_t high = wasm_i8x16_swizzle(source, wasm_v128_load(Plan::tables.shuffle[v + 1]));
+				low = wasm_v128_and(wasm_u32x4_shr(wasm_i32x4_mul(low, wasm_v128_load(Plan::tables.multiplier[v])), 7), mask);
+				high = wasm_v128_and(wasm_u32x4_shr(wasm_i32x4_mul(high, wasm_v128_load(Plan::tables.multiplier[v + 1])), 7), mask);
+				wasm_v128_store(target + v * 4, wasm_u16x8_narrow_i32x4(low, high));
+			}
+		}
+	}
+#else
+	const __m128i mask = _mm_set1_epi32((1 << Bits) - 1);
+	for (; i + Plan::written_per_step <= count && position + Plan::read_per_step <= byteLength; i += Plan::indices_per_step, position += Plan::bytes_per_step) {
+		for (uint32_t load = 0; load < 2; load++) {
+			const __m128i source = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + position + load * Plan::load_stride));
+			uint16_t* target = out + i + load * Plan::indices_per_load;
+			for (uint32_t v = 0; v < Plan::vectors_per_load; v += 2) {
+				__m128i low = _mm_shuffle_epi8(source, _mm_load_si128(reinterpret_cast<const __m128i*>(Plan::tables.shuffle[v])));
+				__m128i high = _mm_shuffle_epi8(source, _mm_load_si128(reinterpret_cast<const __m128i*>(Plan::tables.shuffle[v + 1])));
+				low = _mm_and_si128(_mm_srli_epi32(_mm_mullo_epi32(low, _mm_load_si128(reinterpret_cast<const __m128i*>(Plan::tables.multiplier[v]))), 7), mask);
+				high = _mm_and_si128(_mm_srli_epi32(_mm_mullo_epi32(high, _mm_load_si128(reinterpret_cast<const __m128i*>(Plan::tables.multiplier[v + 1]))), 7), mask);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(target + v * 4), _mm_packus_epi32(low, high));
+			}
+		}
+	}
+#endif
+#endif
+	unpackIndicesScalar(data, Bits, Layout, out, i, count);
+}
+
+/**
+ * Expands count indices of the given width from data into out, dispatching to the specialized kernel for the width.
+ */
+void unpackIndices(const uint64_t* data, uint8_t bits, PackedLayout layout, uint16_t* out, uint32_t count);
+
+} // namespace minecraft
+} // namespace kayo
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "blockModels.hpp"
+#include <algorithm>
+#include <emscripten/bind.h>
+#include <iostream>
+#include <utility>
+
+namespace kayo {
+namespace minecraft {
+
+std::string blockStateKey(const NBT::TagTable& chunk, const NBT::FlatTag* palette_entry) {
+	const NBT::FlatTag* name = chunk.getTag(palette_entry, "Name");
+	if (!name)
+		return "";
+	std::string key(name->get<std::string_view>());
+
+	const NBT::FlatTag* properties = chunk.getTag(palette_entry, "Properties");
+	if (!properties || properties->length == 0)
+		return key;
+	std::vector<std::pair<std::string_view, std::string_view>> sorted;
+	for (const NBT::FlatTag* property = chunk.firstChild(properties); property; property = chunk.nextSibling(property)) {
+		if (property->id == 8)
+			sorted.emplace_back(property->name, property->get<std::string_view>());
+	}
+	std::sort(sorted.begin(), sorted.end());
+
+	key += '[';
+	for (size_t i = 0; i < sorted.size(); i++) {
+		if (i > 0)
+			key += ',';
+		key.append(sorted[i].first).append("=").append(sorted[i].second);
+	}
+	key += ']';
+	return key;
+}
+
+void BlockModelTable::setModel(std::string block_state, uint8_t shape, bool opaque) {
+	if (shape > uint8_t(BlockShape::custom)) {
+		std::cerr << "Unknown block shape " << int(shape) << " for " << block_state << "." << std::endl;
+		return;
+	}
+	BlockModel& model = this->models[block_state];
+	model.shape = BlockShape(shape);
+	model.opaque = opaque;
+}
+
+void BlockModelTable::setFace(std::string block_state, uint8_t face, uint32_t texture_index, uint32_t tint, float u, float v, float tangent_u, float tangent_v, float bitangent_u, float bitangent_v) {
+	if (face >= block_faces) {
+		std::cerr << "Unknown block face " << int(face) << " for " << block_state << "." << std::endl;
+		return;
+	}
+	BlockFaceTexture& texture = this->models[block_state].faces[face];
+	texture.texture_index = texture_index;
+	texture.tint = tint;
+	texture.uv_origin[0] = u;
+	texture.uv_origin[1] = v;
+	texture.uv_tangent[0] = tangent_u;
+	texture.uv_tangent[1] = tangent_v;
+	texture.uv_bitangent[0] = bitangent_u;
+	texture.uv_bitangent[1] = bitangent_v;
+}
+
+const BlockModel& BlockModelTable::get(const std::string& block_state) const {
+	auto it = this->models.find(block_state);
+	return it == this->models.end() ? this->fallback : it->second;
+}
+
+void BlockModelTable::resolvePalette(const NBT::TagTable& chunk, const NBT::FlatTag* palette, std::vector<const BlockModel*>& out) const {
+	out.clear();
+	if (!palette)
+		return;
+	out.reserve(palette->length);
+	for (const NBT::FlatTag* entry = chunk.firstChild(palette); entry; entry = chunk.nextSibling(entry))
+		out.push_back(&this->get(blockStateKey(chunk, entry)));
+}
+
+void BlockModelTable::resolveStates(const BlockStateRegistry& registry, const uint32_t* states, size_t num_states, std::vector<const BlockModel*>& out) const {
+	out.clear();
+	out.reserve(num_states);
+	for (size_t i = 0; i < num_states; i++)
+		out.push_back(&this->get(registry.key(states[i])));
+}
+
+} // namespace minecraft
+} // namespace kayo
+
+using namespace emscripten;
+EMSCRIPTEN_BINDINGS(KayoWasmMinecraftBlockModels) {
+	class_<kayo::minecraft::BlockModelTable>("KayoWASMMinecraftBlockModels")
+		.constructor<>()
+		.function("setModel", &kayo::minecraft::BlockModelTable::setModel)
+		.function("setFace", &kayo::minecraft::BlockModelTable::setFace);
+}
\ No newline at end of file
@@ -0,0 +1,94 @@
+#pragma once
+#include "blockStateRegistry.hpp"
+#include "nbtTable.hpp"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace kayo {
+namespace minecraft {
+
+/**
+ * The faces of a block in the order of the face indices used by {@link BlockModelTable::setFace}.
+ */
+enum class BlockFace : uint8_t {
+	down,
+	up,
+	north,
+	south,
+	west,
+	east,
+};
+constexpr uint32_t block_faces = 6;
+
+enum class BlockShape : uint8_t {
+	/**
+	 * Air and other blocks without geometry.
+	 */
+	empty,
+	/**
+	 * A full cube with a single texture per face. Equal faces of adjacent cubes are merged.
+	 */
+	cube,
+	/**
+	 * Any other model. These blocks are not meshed natively and reported to the host instead.
+	 */
+	custom,
+};
+
+/**
+ * The texture of a cube face with the uv frame of a single block, as the host computed it for the unit cube.
+ */
+struct BlockFaceTexture {
+	uint32_t texture_index = 0;
+	uint32_t tint = 0;
+	float uv_origin[2] = {0.0f, 0.0f};
+	float uv_tangent[2] = {1.0f, 0.0f};
+	float uv_bitangent[2] = {0.0f, 1.0f};
+
+	bool operator==(const BlockFaceTexture& other) const = default;
+};
+
+struct BlockModel {
+	BlockShape shape = BlockShape::custom;
+	/**
+	 * Opaque blocks hide the faces of their neighbours.
+	 */
+	bool opaque = false;
+	std::array<BlockFaceTexture, block_faces> faces;
+};
+
+/**
+ * Builds the key a palette entry is registered with: the block name followed by its properties
+ * sorted by name, e.g. "minecraft:oak_log[axis=y]".
+ */
+std::string blockStateKey(const NBT::TagTable& chunk, const NBT::FlatTag* palette_entry);
+
+/**
+ * The meshing information of all block states, registered by the host from its resource pack.
+ * Unknown block states are treated as custom, non opaque models.
+ * The table must not be modified while meshing tasks are running.
+ */
+class BlockModelTable {
+  private:
+	std::unordered_map<std::string, BlockModel> models;
+	BlockModel fallback;
+
+  public:
+	void setModel(std::string block_state, uint8_t shape, bool opaque);
+	void setFace(std::string block_state, uint8_t face, uint32_t texture_index, uint32_t tint, float u, float v, float tangent_u, float tangent_v, float bitangent_u, float bitangent_v);
+	const BlockModel& get(const std::string& block_state) const;
+	/**
+	 * Looks up the model of every entry of a palette list.
+	 */
+	void resolvePalette(const NBT::TagTable& chunk, const NBT::FlatTag* palette, std::vector<const BlockModel*>& out) const;
+	/**
+	 * Looks up the model of every block state id of a palette.
+	 */
+	void resolveStates(const BlockStateRegistry& registry, const uint32_t* states, size_t num_states, std::vector<const BlockModel*>& out) const;
+};
+
+} // namespace minecraft
+} // namespace kayo
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include "blockStateRegistry.hpp"
+#include "blockModels.hpp"
+#include <emscripten/bind.h>
+
+namespace kayo {
+namespace minecraft {
+
+static bool isAirKey(std::string_view key) {
+	std::string_view name = key.substr(0, key.find('['));
+	return name == "minecraft:air" || name == "minecraft:cave_air" || name == "minecraft:void_air";
+}
+
+std::pair<uint32_t, bool> KeyRegistry::internLocked(const std::string& key) {
+	auto [it, inserted] = this->ids.try_emplace(key, uint32_t(this->offsets.size() - 1));
+	if (inserted) {
+		this->keys.insert(this->keys.end(), key.begin(), key.end());
+		this->offsets.push_back(uint32_t(this->keys.size()));
+	}
+	return {it->second, inserted};
+}
+
+uint32_t KeyRegistry::intern(const std::string& key) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->internLocked(key).first;
+}
+
+uint32_t KeyRegistry::size() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return uint32_t(this->offsets.size() - 1);
+}
+
+size_t KeyRegistry::byteSize() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	size_t bytes = this->ids.bucket_count() * sizeof(void*) + this->ids.size() * (sizeof(void*) + sizeof(std::pair<const std::string, uint32_t>));
+	// The keys are stored twice: by the map nodes, as most exceed the small string buffer, and back to back for JS.
+	bytes += 2 * this->keys.capacity();
+	bytes += this->offsets.capacity() * sizeof(uint32_t);
+	return bytes;
+}
+
+std::string KeyRegistry::key(uint32_t id) const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	if (id + 1 >= this->offsets.size())
+		return "";
+	return std::string(this->keys.data() + this->offsets[id], this->offsets[id + 1] - this->offsets[id]);
+}
+
+kayo::memUtils::KayoPointer KeyRegistry::keysJS() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return {reinterpret_cast<uintptr_t>(this->keys.data()), uint32_t(this->keys.size())};
+}
+
+kayo::memUtils::KayoPointer KeyRegistry::offsetsJS() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return {reinterpret_cast<uintptr_t>(this->offsets.data()), uint32_t(this->offsets.size() * sizeof(uint32_t))};
+}
+
+BlockStateRegistry& BlockStateRegistry::global() {
+	static BlockStateRegistry registry;
+	return registry;
+}
+
+uint32_t BlockStateRegistry::internStateLocked(const std::string& key) {
+	auto [id, inserted] = this->internLocked(key);
+	if (inserted)
+		this->air.push_back(isAirKey(key));
+	return id;
+}
+
+uint32_t BlockStateRegistry::intern(const std::string& key) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->internStateLocked(key);
+}
+
+void BlockStateRegistry::internPalette(const NBT::TagTable& chunk, const NBT::FlatTag* palette, std::vector<uint32_t>& out) {
+	out.clear();
+	if (!palette)
+		return;
+	// The keys are built before locking, so workers decoding other chunks only wait for the lookups.
+	std::vector<std::string> paletteKeys;
+	paletteKeys.reserve(palette->length);
+	for (const NBT::FlatTag* entry = chunk.firstChild(palette); entry; entry = chunk.nextSibling(entry))
+		paletteKeys.push_back(blockStateKey(chunk, entry));
+
+	out.reserve(paletteKeys.size());
+	std::lock_guard<std::mutex> lock(this->mutex);
+	for (const std::string& key : paletteKeys)
+		out.push_back(this->internStateLocked(key));
+}
+
+void BlockStateRegistry::airFlags(const std::vector<uint32_t>& states, std::vector<uint8_t>& out) const {
+	out.resize(states.size());
+	std::lock_guard<std::mutex> lock(this->mutex);
+	for (size_t i = 0; i < states.size(); i++)
+		out[i] = states[i] < this->air.size() ? this->air[states[i]] : 0;
+}
+
+size_t BlockStateRegistry::byteSize() const {
+	size_t bytes = KeyRegistry::byteSize();
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return bytes + this->air.capacity();
+}
+
+BiomeRegistry& BiomeRegistry::global() {
+	static BiomeRegistry registry;
+	return registry;
+}
+
+void BiomeRegistry::internNames(const NBT::TagTable& chunk, const NBT::FlatTag* names, std::vector<uint32_t>& out) {
+	out.clear();
+	if (!names || names->element_id != 8)
+		return;
+	out.reserve(names->length);
+	std::lock_guard<std::mutex> lock(this->mutex);
+	for (const NBT::FlatTag* name = chunk.firstChild(names); name; name = chunk.nextSibling(name))
+		out.push_back(this->internLocked(std::string(name->get<std::string_view>())).first);
+}
+
+} // namespace minecraft
+} // namespace kayo
+
+using namespace emscripten;
+EMSCRIPTEN_BINDINGS(KayoWasmMinecraftBlockStates) {
+	class_<kayo::minecraft::KeyRegistry>("KayoWASMMinecraftKeyRegistry")
+		.function("size", &kayo::minecraft::KeyRegistry::size)
+		.function("key", &kayo::minecraft::KeyRegistry::key)
+		.property("keys", &kayo::minecraft::KeyRegistry::keysJS)
+		.property("offsets", &kayo::minecraft::KeyRegistry::offsetsJS);
+	class_<kayo::minecraft::BlockStateRegistry, base<kayo::minecraft::KeyRegistry>>("KayoWASMMinecraftBlockStates")
+		.class_function("global", &kayo::minecraft::BlockStateRegistry::global, return_value_policy::reference());
+	class_<kayo::minecraft::BiomeRegistry, base<kayo::minecraft::KeyRegistry>>("KayoWASMMinecraftBiomes")
+		.class_function("global", &kayo::minecraft::BiomeRegistry::global, return_value_policy::reference());
+}
\ No newline at end of file
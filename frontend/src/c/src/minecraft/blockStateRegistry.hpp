@@ -0,0 +1,91 @@
+#pragma once
+#include "../utils/memUtils.hpp"
+#include "nbtTable.hpp"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace kayo {
+namespace minecraft {
+
+/**
+ * Interns string keys into dense ids. Ids are never reused or removed.
+ * Interning is thread safe, the views for JS stay valid until the next key is interned.
+ */
+class KeyRegistry {
+  protected:
+	mutable std::mutex mutex;
+	std::unordered_map<std::string, uint32_t> ids;
+	/**
+	 * The UTF-8 keys back to back, in id order.
+	 */
+	std::vector<char> keys;
+	/**
+	 * The start of every key in keys, followed by the end of the last one.
+	 */
+	std::vector<uint32_t> offsets{0};
+
+	/**
+	 * @returns The id of the key and whether it was added.
+	 */
+	std::pair<uint32_t, bool> internLocked(const std::string& key);
+
+  public:
+	uint32_t intern(const std::string& key);
+	uint32_t size() const;
+	/**
+	 * The approximate memory of the registry, including the keys held by its hash map.
+	 */
+	size_t byteSize() const;
+	std::string key(uint32_t id) const;
+	kayo::memUtils::KayoPointer keysJS() const;
+	kayo::memUtils::KayoPointer offsetsJS() const;
+};
+
+/**
+ * Interns the block states of all loaded palettes, so sections can refer to them without their NBT.
+ * Block states are identified by their {@link blockStateKey}, and whether they are air is kept next to them.
+ */
+class BlockStateRegistry : public KeyRegistry {
+  private:
+	/**
+	 * Whether a block state is one of the air blocks, in id order.
+	 */
+	std::vector<uint8_t> air;
+
+	uint32_t internStateLocked(const std::string& key);
+
+  public:
+	/**
+	 * The registry shared by all dimensions.
+	 */
+	static BlockStateRegistry& global();
+	uint32_t intern(const std::string& key);
+	/**
+	 * Interns every entry of a palette list and writes their ids to out.
+	 */
+	void internPalette(const NBT::TagTable& chunk, const NBT::FlatTag* palette, std::vector<uint32_t>& out);
+	/**
+	 * Writes whether each of the given block states is air to out.
+	 */
+	void airFlags(const std::vector<uint32_t>& states, std::vector<uint8_t>& out) const;
+	size_t byteSize() const;
+};
+
+/**
+ * Interns the biomes of all dimensions by their name.
+ */
+class BiomeRegistry : public KeyRegistry {
+  public:
+	static BiomeRegistry& global();
+	/**
+	 * Interns every entry of a list of strings, like the biome palette of a section, and writes their ids to out.
+	 */
+	void internNames(const NBT::TagTable& chunk, const NBT::FlatTag* names, std::vector<uint32_t>& out);
+};
+
+} // namespace minecraft
+} // namespace kayo
\ No newline at end of file
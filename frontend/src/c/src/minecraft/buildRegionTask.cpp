@@ -0,0 +1,182 @@
+#include "buildRegionTask.hpp"
+#include "../task/workerPool.hpp"
+#include <algorithm>
+#include <emscripten/bind.h>
+#include <emscripten/em_asm.h>
+#include <iostream>
+#include <memory>
+
+namespace kayo {
+namespace minecraft {
+
+constexpr uint32_t progress_interval = 32;
+
+/**
+ * Decodes the chunks of the task on the worker pool and queues them for {@link BuildRegionTask::merge}.
+ */
+void BuildRegionTask::decodeChunks() {
+	uint32_t numChunks = uint32_t(this->chunks.size());
+	WorkerPool::shared().parallelFor(numChunks, [this, numChunks](uint32_t n) {
+		uint32_t i = this->chunks[n];
+		int32_t chunk_x = this->region_x * 32 + int32_t(i % 32);
+		int32_t chunk_z = this->region_z * 32 + int32_t(i / 32);
+		DecodedChunk decoded;
+		int status;
+		try {
+			status = this->dimension->decodeChunk(chunk_x, chunk_z, decoded);
+		} catch (const std::exception& e) {
+			std::cerr << "Could not decode chunk " << chunk_x << ", " << chunk_z << ": " << e.what() << std::endl;
+			status = -3;
+		}
+		if (status != 0 && status != -2 && status != -4)
+			this->failed_chunks++;
+		this->deliver(status, decoded);
+
+		uint32_t finished = ++this->finished_chunks;
+		if (finished % progress_interval == 0) {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdollar-in-identifier-extension"
+			MAIN_THREAD_ASYNC_EM_ASM({ window.kayo.taskQueue.wasmTaskUpdate($0, $1, $2); }, this->task_id, finished, numChunks);
+#pragma GCC diagnostic pop
+		}
+	});
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdollar-in-identifier-extension"
+	MAIN_THREAD_ASYNC_EM_ASM({ window.kayo.taskQueue.wasmTaskFinished($0, {numChunks : $1, failedChunks : $2}); }, this->task_id, numChunks, this->failed_chunks.load());
+#pragma GCC diagnostic pop
+}
+
+void BuildRegionTask::deliver(int status, DecodedChunk& chunk) {
+	if (status != 0 && status != -4)
+		return;
+	std::lock_guard<std::mutex> lock(this->decoded_mutex);
+	(status == 0 ? this->decoded_chunks : this->external_chunks).push_back(std::move(chunk));
+}
+
+void BuildRegionTask::mergeChunks(std::vector<uint64_t>* changed_sections) {
+	std::vector<DecodedChunk> decoded;
+	std::vector<DecodedChunk> external;
+	{
+		std::lock_guard<std::mutex> lock(this->decoded_mutex);
+		decoded.swap(this->decoded_chunks);
+		external.swap(this->external_chunks);
+	}
+	this->dimension->releaseRegionData(this->region_x, this->region_z);
+	for (DecodedChunk& chunk : decoded)
+		this->dimension->insertChunk(chunk, changed_sections);
+	this->built_chunks += uint32_t(decoded.size());
+
+	this->external_coordinates.clear();
+	for (const DecodedChunk& chunk : external) {
+		this->dimension->markExternalChunk(chunk);
+		this->external_coordinates.push_back(chunk.chunk_x);
+		this->external_coordinates.push_back(chunk.chunk_z);
+	}
+}
+
+emscripten::val BuildRegionTask::merge() {
+	this->mergeChunks(nullptr);
+	return this->externalChunksView();
+}
+
+emscripten::val BuildRegionTask::externalChunksView() {
+	return emscripten::val(emscripten::typed_memory_view(this->external_coordinates.size(), this->external_coordinates.data()));
+}
+
+emscripten::val ReloadRegionTask::merge() {
+	this->mergeChunks(&this->changed);
+	std::sort(this->changed.begin(), this->changed.end());
+	this->changed.erase(std::unique(this->changed.begin(), this->changed.end()), this->changed.end());
+	this->changed_sections.clear();
+	this->changed_sections.reserve(this->changed.size() * 3);
+	for (uint64_t key : this->changed) {
+		this->changed_sections.push_back(SectionKey::x(key));
+		this->changed_sections.push_back(SectionKey::y(key));
+		this->changed_sections.push_back(SectionKey::z(key));
+	}
+	return this->externalChunksView();
+}
+
+static void decodeExternalChunk(DecodeExternalChunkTask* task) {
+	std::unique_ptr<uint8_t[]> data(task->data);
+	task->data = nullptr;
+
+	DecodedChunk decoded;
+	int status;
+	try {
+		status = task->dimension->decodeExternalChunk(task->chunk_x, task->chunk_z, task->compression, data.get(), task->length, decoded);
+	} catch (const std::exception& e) {
+		std::cerr << "Could not decode external chunk " << task->chunk_x << ", " << task->chunk_z << ": " << e.what() << std::endl;
+		status = -3;
+	}
+	data.reset();
+	if (status == 0)
+		task->dimension->deliverExternalChunk(decoded);
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdollar-in-identifier-extension"
+	MAIN_THREAD_ASYNC_EM_ASM({ window.kayo.taskQueue.wasmTaskFinished($0, $1); }, task->task_id, status);
+#pragma GCC diagnostic pop
+}
+
+BuildRegionTask::BuildRegionTask(uint32_t task_id, DimensionData* dimension, int32_t region_x, int32_t region_z)
+	: Task(task_id), dimension(dimension), region_x(region_x), region_z(region_z), chunks(chunks_per_region) {
+	for (uint32_t i = 0; i < chunks_per_region; i++)
+		this->chunks[i] = uint16_t(i);
+}
+
+void BuildRegionTask::run() {
+	WorkerPool::shared().submit([this] { this->decodeChunks(); });
+}
+
+ReloadRegionTask::ReloadRegionTask(uint32_t task_id, DimensionData* dimension, int32_t region_x, int32_t region_z, uintptr_t byte_offset, uint32_t byte_length)
+	: BuildRegionTask(task_id, dimension, region_x, region_z), data(reinterpret_cast<uint8_t*>(byte_offset)), length(byte_length) {}
+
+void ReloadRegionTask::run() {
+	this->chunks = this->dimension->reloadRegion(this->region_x, this->region_z, reinterpret_cast<uintptr_t>(this->data), this->length, &this->changed);
+	this->data = nullptr;
+	BuildRegionTask::run();
+}
+
+kayo::memUtils::KayoPointer ReloadRegionTask::changedSectionsJS() const {
+	return {reinterpret_cast<uintptr_t>(this->changed_sections.data()), uint32_t(this->changed_sections.size() * sizeof(int32_t))};
+}
+
+DecodeExternalChunkTask::DecodeExternalChunkTask(uint32_t task_id, DimensionData* dimension, int32_t chunk_x, int32_t chunk_z, uintptr_t byte_offset, uint32_t byte_length)
+	: Task(task_id), dimension(dimension), chunk_x(chunk_x), chunk_z(chunk_z), data(reinterpret_cast<uint8_t*>(byte_offset)), length(byte_length) {}
+
+void DecodeExternalChunkTask::run() {
+	const uint8_t* compression = this->dimension->externalChunks.find(ColumnKey::pack(this->chunk_x, this->chunk_z));
+	if (!compression) {
+		std::cerr << "Chunk " << this->chunk_x << ", " << this->chunk_z << " is not stored externally." << std::endl;
+		delete[] this->data;
+		this->data = nullptr;
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdollar-in-identifier-extension"
+		MAIN_THREAD_ASYNC_EM_ASM({ window.kayo.taskQueue.wasmTaskFinished($0, $1); }, this->task_id, -1);
+#pragma GCC diagnostic pop
+		return;
+	}
+	this->compression = *compression;
+	WorkerPool::shared().submit([this] { decodeExternalChunk(this); });
+}
+
+} // namespace minecraft
+} // namespace kayo
+
+using namespace emscripten;
+EMSCRIPTEN_BINDINGS(KayoBuildRegionTask) {
+	class_<kayo::minecraft::BuildRegionTask, base<kayo::Task>>("WasmBuildRegionTask")
+		.constructor<uint32_t, kayo::minecraft::DimensionData*, int32_t, int32_t>()
+		.function("run", &kayo::minecraft::BuildRegionTask::run)
+		.function("merge", &kayo::minecraft::BuildRegionTask::merge)
+		.property("builtChunks", &kayo::minecraft::BuildRegionTask::built_chunks);
+	class_<kayo::minecraft::ReloadRegionTask, base<kayo::minecraft::BuildRegionTask>>("WasmReloadRegionTask")
+		.constructor<uint32_t, kayo::minecraft::DimensionData*, int32_t, int32_t, uintptr_t, uint32_t>()
+		.function("run", &kayo::minecraft::ReloadRegionTask::run)
+		.property("changedSections", &kayo::minecraft::ReloadRegionTask::changedSectionsJS);
+	class_<kayo::minecraft::DecodeExternalChunkTask, base<kayo::Task>>("WasmDecodeExternalChunkTask")
+		.constructor<uint32_t, kayo::minecraft::DimensionData*, int32_t, int32_t, uintptr_t, uint32_t>()
+		.function("run", &kayo::minecraft::DecodeExternalChunkTask::run);
+}
\ No newline at end of file
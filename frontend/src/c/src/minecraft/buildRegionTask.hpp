@@ -0,0 +1,106 @@
+#pragma once
+#include "../task/task.hpp"
+#include "../utils/memUtils.hpp"
+#include "context.hpp"
+#include <atomic>
+#include <cstdint>
+#include <emscripten/val.h>
+#include <mutex>
+#include <vector>
+
+namespace kayo {
+namespace minecraft {
+
+/**
+ * Decodes all chunks of an opened region on the {@link WorkerPool}.
+ * Every chunk is inflated and parsed on its own, the workers only read the region file and the registries.
+ * The decoded chunks are queued on the task and inserted by {@link merge}, which the host calls on the thread
+ * owning the dimension once the task finished, like {@link DimensionData::mergeExternalChunks}.
+ * The region must not be opened again until the task is merged.
+ * Chunks stored in external .mcc files do not hold up the import: {@link merge} returns them,
+ * so the host can load their files and decode them with a {@link DecodeExternalChunkTask}.
+ */
+class BuildRegionTask : public Task {
+  public:
+	DimensionData* dimension;
+	const int32_t region_x;
+	const int32_t region_z;
+	std::atomic<uint32_t> finished_chunks = 0;
+	std::atomic<uint32_t> failed_chunks = 0;
+	/**
+	 * The number of chunks {@link merge} inserted.
+	 */
+	uint32_t built_chunks = 0;
+	/**
+	 * The indices (z * 32 + x) of the chunks to decode within the region. All chunks by default.
+	 */
+	std::vector<uint16_t> chunks;
+	BuildRegionTask(uint32_t task_id, DimensionData* dimension, int32_t region_x, int32_t region_z);
+	void run() override;
+	/**
+	 * Inserts the decoded chunks into the dimension, records the external ones and releases the chunk sectors of the region.
+	 * @returns The x and z coordinates of the chunks stored in external .mcc files. The view is valid until the task is deleted.
+	 */
+	virtual emscripten::val merge();
+	/**
+	 * Queues the result of decoding a chunk for {@link merge}. Thread safe.
+	 */
+	void deliver(int status, DecodedChunk& chunk);
+
+  protected:
+	void decodeChunks();
+	void mergeChunks(std::vector<uint64_t>* changed_sections);
+	emscripten::val externalChunksView();
+
+  private:
+	std::mutex decoded_mutex;
+	std::vector<DecodedChunk> decoded_chunks;
+	std::vector<DecodedChunk> external_chunks;
+	std::vector<int32_t> external_coordinates;
+};
+
+/**
+ * Replaces a region with a newer version of its file and decodes only the chunks whose
+ * header entry changed, as a {@link BuildRegionTask} would.
+ * The file is replaced and the changed chunks are removed by {@link run}, on the thread owning the dimension.
+ * Takes ownership of the region file, which has to come from allocArrayUint8.
+ */
+class ReloadRegionTask : public BuildRegionTask {
+  public:
+	uint8_t* data;
+	const uint32_t length;
+	/**
+	 * The chunk x, section y and chunk z of every section that was added, modified or removed, for re-meshing.
+	 * Filled by {@link merge}.
+	 */
+	std::vector<int32_t> changed_sections;
+	ReloadRegionTask(uint32_t task_id, DimensionData* dimension, int32_t region_x, int32_t region_z, uintptr_t byte_offset, uint32_t byte_length);
+	void run() override;
+	emscripten::val merge() override;
+	kayo::memUtils::KayoPointer changedSectionsJS() const;
+
+  private:
+	std::vector<uint64_t> changed;
+};
+
+/**
+ * Decodes a chunk from the contents of its .mcc file on a worker thread.
+ * The worker only reads the compression the task looked up in {@link run}, so the dimension can be used meanwhile.
+ * The decoded chunk is handed to {@link DimensionData::deliverExternalChunk}, the host inserts it with
+ * {@link DimensionData::mergeExternalChunks} once the task finished.
+ * Takes ownership of the buffer, which has to come from allocArrayUint8.
+ */
+class DecodeExternalChunkTask : public Task {
+  public:
+	DimensionData* dimension;
+	const int32_t chunk_x;
+	const int32_t chunk_z;
+	uint8_t* data;
+	const uint32_t length;
+	uint8_t compression = 0;
+	DecodeExternalChunkTask(uint32_t task_id, DimensionData* dimension, int32_t chunk_x, int32_t chunk_z, uintptr_t byte_offset, uint32_t byte_length);
+	void run() override;
+};
+
+} // namespace minecraft
+} // namespace kayo
\ No newline at end of file
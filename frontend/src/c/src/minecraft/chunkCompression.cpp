@@ -0,0 +1,143 @@
+#include "chunkCompression.hpp"
+#include "../utils/lz4Util.hpp"
+#include "../utils/zlibUtil.hpp"
+#include "parse.hpp"
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace kayo {
+namespace minecraft {
+
+static uint8_t* decompressGzip(const uint8_t* input, size_t input_length, size_t* output_length) {
+	return kayo::zlib::Inflater::local().decompress(input, input_length, kayo::zlib::Format::gzip, output_length);
+}
+
+static uint8_t* decompressZlib(const uint8_t* input, size_t input_length, size_t* output_length) {
+	return kayo::zlib::Inflater::local().decompress(input, input_length, kayo::zlib::Format::zlib, output_length);
+}
+
+static uint8_t* copyUncompressed(const uint8_t* input, size_t input_length, size_t* output_length) {
+	uint8_t* output = static_cast<uint8_t*>(std::malloc(input_length > 0 ? input_length : 1));
+	if (!output)
+		return nullptr;
+	std::memcpy(output, input, input_length);
+	*output_length = input_length;
+	return output;
+}
+
+/**
+ * The framing of LZ4BlockOutputStream (lz4-java), which Minecraft uses for compression type 4.
+ * Every block starts with this header. A block with zero lengths marks the end of the stream.
+ */
+constexpr uint8_t lz4_block_magic[8] = {'L', 'Z', '4', 'B', 'l', 'o', 'c', 'k'};
+constexpr size_t lz4_block_header_bytes = 8 + 1 + 4 + 4 + 4;
+constexpr uint8_t lz4_block_method_raw = 0x10;
+constexpr uint8_t lz4_block_method_lz4 = 0x20;
+
+/**
+ * The largest decompressed chunk that is accepted. Real chunks stay far below this, so a larger sum of block lengths means a corrupt stream.
+ */
+constexpr uint64_t max_decompressed_chunk_bytes = uint64_t(256) << 20;
+
+struct LZ4BlockHeader {
+	uint8_t method;
+	uint32_t compressed_length;
+	uint32_t decompressed_length;
+};
+
+static uint32_t readU32LittleEndian(const uint8_t* data) {
+	return uint32_t(data[0]) | (uint32_t(data[1]) << 8) | (uint32_t(data[2]) << 16) | (uint32_t(data[3]) << 24);
+}
+
+static bool readLZ4BlockHeader(const uint8_t* data, size_t remaining, LZ4BlockHeader& header) {
+	if (remaining < lz4_block_header_bytes || std::memcmp(data, lz4_block_magic, sizeof(lz4_block_magic)) != 0)
+		return false;
+	header.method = data[8] & 0xF0;
+	header.compressed_length = readU32LittleEndian(data + 9);
+	header.decompressed_length = readU32LittleEndian(data + 13);
+	return header.compressed_length <= remaining - lz4_block_header_bytes;
+}
+
+/**
+ * Decodes a stream of LZ4 blocks. The block checksums are not verified.
+ * The headers are walked first, so the output is allocated once with its final size.
+ */
+static uint8_t* decompressLZ4(const uint8_t* input, size_t input_length, size_t* output_length) {
+	// Summed in 64 bits, as the block lengths can add up past a 32 bit size_t.
+	uint64_t sum = 0;
+	LZ4BlockHeader header;
+	size_t position = 0;
+	while (position < input_length) {
+		if (!readLZ4BlockHeader(input + position, input_length - position, header))
+			return nullptr;
+		if (header.compressed_length == 0 && header.decompressed_length == 0)
+			break;
+		sum += header.decompressed_length;
+		if (sum > max_decompressed_chunk_bytes) {
+			std::cerr << "LZ4 chunk exceeds " << max_decompressed_chunk_bytes << " bytes." << std::endl;
+			return nullptr;
+		}
+		position += lz4_block_header_bytes + header.compressed_length;
+	}
+	size_t total = size_t(sum);
+
+	uint8_t* output = static_cast<uint8_t*>(std::malloc(total > 0 ? total : 1));
+	if (!output)
+		return nullptr;
+	size_t written = 0;
+	position = 0;
+	while (written < total) {
+		readLZ4BlockHeader(input + position, input_length - position, header);
+		const uint8_t* block = input + position + lz4_block_header_bytes;
+		bool valid;
+		if (header.method == lz4_block_method_raw) {
+			valid = header.compressed_length == header.decompressed_length;
+			if (valid)
+				std::memcpy(output + written, block, header.decompressed_length);
+		} else if (header.method == lz4_block_method_lz4) {
+			int64_t produced = kayo::lz4::decompressBlock(block, header.compressed_length, output + written, total - written);
+			valid = produced == int64_t(header.decompressed_length);
+		} else {
+			valid = false;
+		}
+		if (!valid) {
+			std::free(output);
+			return nullptr;
+		}
+		written += header.decompressed_length;
+		position += lz4_block_header_bytes + header.compressed_length;
+	}
+	*output_length = total;
+	return output;
+}
+
+static std::array<ChunkDecompressor, 256> decompressors = [] {
+	std::array<ChunkDecompressor, 256> defaults{};
+	defaults[chunk_compression_gzip] = &decompressGzip;
+	defaults[chunk_compression_zlib] = &decompressZlib;
+	defaults[chunk_compression_none] = &copyUncompressed;
+	defaults[chunk_compression_lz4] = &decompressLZ4;
+	return defaults;
+}();
+
+void registerChunkDecompressor(uint8_t compression, ChunkDecompressor decompressor) {
+	decompressors[compression] = decompressor;
+}
+
+ChunkDecompressor chunkDecompressor(uint8_t compression) {
+	return decompressors[compression];
+}
+
+uint8_t* decompressChunk(uint8_t compression, const uint8_t* input, size_t input_length, size_t* output_length) {
+	ChunkDecompressor decompressor = decompressors[compression];
+	if (!decompressor) {
+		std::cerr << "Unsupported chunk compression type " << int(compression) << "." << std::endl;
+		return nullptr;
+	}
+	return decompressor(input, input_length, output_length);
+}
+
+} // namespace minecraft
+} // namespace kayo
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace kayo {
+namespace minecraft {
+
+/**
+ * The compression types of chunks, stored in the fifth byte of every chunk in a region file.
+ */
+constexpr uint8_t chunk_compression_gzip = 1;
+constexpr uint8_t chunk_compression_zlib = 2;
+constexpr uint8_t chunk_compression_none = 3;
+constexpr uint8_t chunk_compression_lz4 = 4;
+constexpr uint8_t chunk_compression_custom = 127;
+/**
+ * Set in addition to the compression type if the chunk exceeds 1 MiB and is stored in a separate c.X.Z.mcc file.
+ */
+constexpr uint8_t chunk_compression_external = 128;
+
+/**
+ * Decompresses a chunk payload (everything after the compression byte).
+ * @returns A buffer allocated with malloc, which the caller owns, or nullptr if the payload is corrupt.
+ */
+typedef uint8_t* (*ChunkDecompressor)(const uint8_t* input, size_t input_length, size_t* output_length);
+
+/**
+ * Registers or replaces the decompressor of a compression type.
+ * Must not be called while chunks are decoded.
+ */
+void registerChunkDecompressor(uint8_t compression, ChunkDecompressor decompressor);
+
+/**
+ * Returns the decompressor of a compression type or nullptr if the type is not supported.
+ */
+ChunkDecompressor chunkDecompressor(uint8_t compression);
+
+uint8_t* decompressChunk(uint8_t compression, const uint8_t* input, size_t input_length, size_t* output_length);
+
+} // namespace minecraft
+} // namespace kayo
\ No newline at end of file
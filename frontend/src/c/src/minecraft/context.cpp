@@ -1,14 +1,14 @@
 #include "context.hpp"
 #include "../numerics/fixedMath.hpp"
-#include "../utils/zlibUtil.hpp"
+#include "bitUnpack.hpp"
+#include "chunkCompression.hpp"
 #include "parse.hpp"
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <cstring>
 #include <iostream>
-#include <map>
-#include <tuple>
+#include <memory>
 #include <vector>
 
 namespace kayo {
@@ -19,147 +19,755 @@ struct ChunkDescription {
 	uint8_t sectorCount;
 };
 
-static ChunkDescription getChunkDescription(const Bytef* data, uint8_t x, uint8_t y) {
+static ChunkDescription getChunkDescription(const uint8_t* data, uint8_t x, uint8_t y) {
 	uint32_t off = (y * 32 + x) * 4;
 	uint32_t offset = readU32AsBigEndian(data + off, 3);
 	uint8_t sectorCount = CHAR_TO_U8(data[off + 3]);
 	return {offset, sectorCount};
 }
 
-static void buildChunkSections(std::map<std::tuple<int, int8_t, int>, const uint16_t*>& sectionsMap, const NBT::CompoundTag* chunk) {
-	NBT::ListTag* sections = chunk->getTag<NBT::ListTag>("sections");
-	int xPos = chunk->getTag<NBT::IntTag>("xPos")->value;
-	int zPos = chunk->getTag<NBT::IntTag>("zPos")->value;
+/**
+ * Decodes the biomes and light levels of a section into decoded.
+ */
+static void buildSectionBiomesAndLight(DecodedChunk& decoded, const NBT::TagTable& chunk, const NBT::FlatTag* section, uint64_t key, BiomeRegistry& biomes) {
+	const NBT::FlatTag* biomePalette = NBT::getTag(chunk, section, "biomes.palette");
+	std::vector<uint32_t> ids;
+	biomes.internNames(chunk, biomePalette, ids);
+	if (ids.size() == 1) {
+		SectionBiomes& out = decoded.biomes.emplace_back(key, SectionBiomes()).second;
+		out.fill(ids[0]);
+	} else if (ids.size() > 1) {
+		uint8_t bitsPerIndex = static_cast<uint8_t>(std::ceil(std::log2(ids.size())));
+		const NBT::FlatTag* dataTag = NBT::getTag(chunk, section, "biomes.data");
+		if (dataTag && dataTag->id == 12 && dataTag->length >= packedLongCount(bitsPerIndex, PackedLayout::Padded, biomes_per_section)) {
+			std::vector<uint64_t> data(dataTag->length);
+			dataTag->copyArray(reinterpret_cast<int64_t*>(data.data()));
+			uint16_t indices[biomes_per_section];
+			unpackIndices(data.data(), bitsPerIndex, PackedLayout::Padded, indices, biomes_per_section);
+			SectionBiomes& out = decoded.biomes.emplace_back(key, SectionBiomes()).second;
+			for (uint32_t i = 0; i < biomes_per_section; i++)
+				out[i] = ids[indices[i] < ids.size() ? indices[i] : 0];
+		} else {
+			std::cerr << "Biomes of section " << int(SectionKey::y(key)) << " are incomplete." << std::endl;
+		}
+	}
+
+	// The light arrays stay packed, they can be uploaded to the GPU as they are.
+	const NBT::FlatTag* blockLight = chunk.getTag(section, "BlockLight");
+	if (blockLight && blockLight->id == 7 && blockLight->length == light_bytes_per_section)
+		blockLight->copyArray(reinterpret_cast<int8_t*>(decoded.block_light.emplace_back(key, NibbleArray()).second.data()));
+	const NBT::FlatTag* skyLight = chunk.getTag(section, "SkyLight");
+	if (skyLight && skyLight->id == 7 && skyLight->length == light_bytes_per_section)
+		skyLight->copyArray(reinterpret_cast<int8_t*>(decoded.sky_light.emplace_back(key, NibbleArray()).second.data()));
+}
 
-	for (NBT::NBTBase* sectionBase : sections->value) {
-		NBT::CompoundTag* section = sectionBase->as<NBT::CompoundTag>();
-		int8_t yPos = section->getTag<NBT::ByteTag>("Y")->value;
-		NBT::CompoundTag* block_states = section->getTag<NBT::CompoundTag>("block_states");
+/**
+ * Builds the sections of the chunk in the slot decoded.chunk_x, decoded.chunk_z.
+ * The sections are keyed by the slot, like unloading and reloading do. A chunk whose xPos/zPos names another position
+ * was copied or moved between slots, it is placed at its slot like Minecraft does.
+ */
+static void buildChunkSections(DecodedChunk& decoded, const NBT::TagTable& chunk, BlockStateRegistry& registry, BiomeRegistry& biomes) {
+	const NBT::FlatTag* root = chunk.root();
+	const NBT::FlatTag* sections = chunk.getTag(root, "sections");
+	int xPos = decoded.chunk_x;
+	int zPos = decoded.chunk_z;
+	const NBT::FlatTag* storedX = chunk.getTag(root, "xPos");
+	const NBT::FlatTag* storedZ = chunk.getTag(root, "zPos");
+	if (storedX && storedZ && storedX->id == 3 && storedZ->id == 3 && (storedX->get<int32_t>() != xPos || storedZ->get<int32_t>() != zPos))
+		std::cerr << "Chunk " << xPos << ", " << zPos << " is stored as " << storedX->get<int32_t>() << ", " << storedZ->get<int32_t>() << ", placing it at its slot." << std::endl;
+	if (!sections)
+		return;
+
+	ColumnSurfaces surfaces;
+	surfaces.fill(INT16_MIN);
+	std::vector<uint8_t> air;
+	for (const NBT::FlatTag* section = chunk.firstChild(sections); section; section = chunk.nextSibling(section)) {
+		int8_t yPos = NBT::getGeneric<int8_t>(chunk, section, "Y");
+		buildSectionBiomesAndLight(decoded, chunk, section, SectionKey::pack(xPos, yPos, zPos), biomes);
+		const NBT::FlatTag* block_states = chunk.getTag(section, "block_states");
 		if (!block_states)
 			continue;
-		NBT::ListTag* palette = block_states->getTag<NBT::ListTag>("palette");
-		size_t paletteSize = palette->value.size();
-		if (paletteSize <= 1)
+		const NBT::FlatTag* palette = chunk.getTag(block_states, "palette");
+		if (!palette || palette->length == 0)
+			continue;
+		size_t paletteSize = palette->length;
+		std::vector<uint32_t> states;
+		registry.internPalette(chunk, palette, states);
+		registry.airFlags(states, air);
+		if (paletteSize == 1) {
+			decoded.uniform_sections.emplace_back(SectionKey::pack(xPos, yPos, zPos), states[0]);
+			if (!air[0])
+				includeSolidSectionSurfaces(yPos, surfaces);
 			continue;
+		}
 
 		uint8_t bitsPerIndex = std::max(static_cast<uint8_t>(std::ceil(std::log2(paletteSize))), uint8_t(4));
-		uint64_t mask = (1ULL << bitsPerIndex) - 1;
-
-		uint8_t indicesPerLong = 64 / bitsPerIndex;
-		NBT::LongArrayTag* data = block_states->getTag<NBT::LongArrayTag>("data");
-
-		uint16_t* sectionIndices = new uint16_t[4096];
-		size_t longIndex = 0;
-		uint8_t indexInLong = 0;
-		int64_t currentLong = data->value[longIndex];
-		for (int i = 0; i < 4096; i++) {
-			if (indexInLong == indicesPerLong) {
-				indexInLong = 0;
-				longIndex++;
-				currentLong = data->value[longIndex];
-			}
-			sectionIndices[i] = extractIndex(currentLong, indexInLong * bitsPerIndex, mask);
-			indexInLong++;
+		const NBT::FlatTag* dataTag = chunk.getTag(block_states, "data");
+		if (!dataTag || dataTag->length < packedLongCount(bitsPerIndex, PackedLayout::Padded, blocks_per_section)) {
+			std::cerr << "Block states of section " << int(yPos) << " are incomplete." << std::endl;
+			continue;
 		}
 
-		sectionsMap[std::make_tuple(xPos, yPos, zPos)] = sectionIndices;
+		PackedSection packed;
+		packed.bits_per_index = bitsPerIndex;
+		packed.palette_size = uint16_t(paletteSize);
+		packed.data.resize(dataTag->length);
+		dataTag->copyArray(reinterpret_cast<int64_t*>(packed.data.data()));
+		packed.palette = std::move(states);
+		SectionOccupancy occupancy;
+		buildSectionOccupancy(packed, air, occupancy);
+		includeSectionSurfaces(occupancy, yPos, surfaces);
+		decoded.occupancy.emplace_back(SectionKey::pack(xPos, yPos, zPos), occupancy);
+		decoded.sections.emplace_back(SectionKey::pack(xPos, yPos, zPos), std::move(packed));
 	}
+	decoded.heights = summarizeSurfaces(surfaces);
 }
 
-static NBT::CompoundTag* readChunk(const Bytef* data, ChunkDescription chunkDescription) {
-	uint32_t byteOffset = chunkDescription.offset * 4096;
-	const Bytef* chunk = data + byteOffset;
+/**
+ * The tags of a chunk that are used after decoding. Everything else is skipped while parsing.
+ */
+static const NBT::PathSet chunkPaths{
+	"xPos",
+	"zPos",
+	"sections.*.Y",
+	"sections.*.block_states.palette",
+	"sections.*.block_states.data",
+	"sections.*.biomes",
+	"sections.*.BlockLight",
+	"sections.*.SkyLight",
+};
+
+/**
+ * Locates the payload of a chunk in its region file.
+ * @param compression Receives the compression byte, including {@link chunk_compression_external}.
+ */
+static bool locateChunk(const RegionFile& region, ChunkDescription chunkDescription, const uint8_t*& payload, size_t& payloadLength, uint8_t& compression) {
+	uint64_t byteOffset = uint64_t(chunkDescription.offset) * 4096;
+	if (byteOffset + 5 > region.length) {
+		std::cerr << "Chunk sector lies outside of the region file." << std::endl;
+		return false;
+	}
+	const uint8_t* chunk = region.data.get() + byteOffset;
 	uint32_t chunkDataLength = readU32AsBigEndian(chunk, 4);
+	if (chunkDataLength == 0 || byteOffset + 4 + chunkDataLength > region.length) {
+		std::cerr << "Chunk data exceeds the region file." << std::endl;
+		return false;
+	}
+	compression = chunk[4];
+	payload = chunk + 5;
+	payloadLength = chunkDataLength - 1;
+	return true;
+}
+
+static int parseChunk(int32_t chunk_x, int32_t chunk_z, uint8_t compression, const uint8_t* payload, size_t payloadLength, BlockStateRegistry& registry, BiomeRegistry& biomes, DecodedChunk& out) {
 	size_t size = 0;
-	const Bytef* res = zlib_decompress(chunk + 5, chunkDataLength - 1, &size);
-	size_t progress = 0;
-	NBT::NBTBase* tag = NBT::parseNBT(res, progress);
-	auto t = tag->as<NBT::CompoundTag>();
+	uint8_t* res = decompressChunk(compression, payload, payloadLength, &size);
+	if (!res) {
+		std::cerr << "Could not decompress chunk " << chunk_x << ", " << chunk_z << "." << std::endl;
+		return -3;
+	}
+	NBT::TagTable* chunk = new NBT::TagTable(res, size, chunkPaths, true);
 
-	return t;
+	out.chunk_x = chunk_x;
+	out.chunk_z = chunk_z;
+	out.nbt.reset(chunk);
+	out.sections.clear();
+	out.uniform_sections.clear();
+	out.occupancy.clear();
+	out.heights = ChunkHeights();
+	out.biomes.clear();
+	out.block_light.clear();
+	out.sky_light.clear();
+	buildChunkSections(out, *chunk, registry, biomes);
+	return 0;
 }
 
-int DimensionData::buildChunk(int chunk_x, int chunk_z) {
+int DimensionData::decodeChunk(int32_t chunk_x, int32_t chunk_z, DecodedChunk& out) const {
 	int region_x = chunk_x >> 5;
 	int region_z = chunk_z >> 5;
-	const uint8_t* region;
-
-	if (auto it = this->regionsRawData.find(std::make_tuple(region_x, region_z)); it != this->regionsRawData.end())
-		region = it->second;
-	else {
+	const RegionFile* region = this->regionsRawData.find(ColumnKey::pack(region_x, region_z));
+	if (!region) {
 		std::cerr << "Could not find region for chunk." << std::endl;
 		return -1;
 	}
 
 	uint8_t inner_chunk_x = uint8_t(modulus(chunk_x, 32));
 	uint8_t inner_chunk_z = uint8_t(modulus(chunk_z, 32));
-	NBT::CompoundTag* chunk = readChunk(region, getChunkDescription(region, inner_chunk_x, inner_chunk_z));
-	if (!chunk) {
-		std::cerr << "Read chunk is NULL." << std::endl;
+	ChunkDescription description = getChunkDescription(region->data.get(), inner_chunk_x, inner_chunk_z);
+	if (description.offset == 0 || description.sectorCount == 0)
+		return -2;
+	if (!region->hasChunkData())
+		return -5;
+
+	const uint8_t* payload;
+	size_t payloadLength;
+	uint8_t compression;
+	if (!locateChunk(*region, description, payload, payloadLength, compression))
 		return -3;
+	if (compression & chunk_compression_external) {
+		out.chunk_x = chunk_x;
+		out.chunk_z = chunk_z;
+		out.external_compression = uint8_t(compression & ~chunk_compression_external);
+		return -4;
+	}
+	return parseChunk(chunk_x, chunk_z, compression, payload, payloadLength, this->blockStates, this->biomes, out);
+}
+
+int DimensionData::decodeExternalChunk(int32_t chunk_x, int32_t chunk_z, uint8_t compression, const uint8_t* data, size_t length, DecodedChunk& out) const {
+	return parseChunk(chunk_x, chunk_z, compression, data, length, this->blockStates, this->biomes, out);
+}
+
+void DimensionData::markExternalChunk(const DecodedChunk& chunk) {
+	this->externalChunks.insertOrAssign(ColumnKey::pack(chunk.chunk_x, chunk.chunk_z), chunk.external_compression);
+}
+
+void DimensionData::deliverExternalChunk(DecodedChunk& chunk) {
+	std::lock_guard<std::mutex> lock(this->deliveredExternalChunksMutex);
+	this->deliveredExternalChunks.push_back(std::move(chunk));
+}
+
+emscripten::val DimensionData::mergeExternalChunks() {
+	std::vector<DecodedChunk> delivered;
+	{
+		std::lock_guard<std::mutex> lock(this->deliveredExternalChunksMutex);
+		delivered.swap(this->deliveredExternalChunks);
+	}
+	std::vector<uint64_t> changed;
+	for (DecodedChunk& chunk : delivered)
+		this->insertChunk(chunk, &changed);
+	std::sort(changed.begin(), changed.end());
+	changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+	return this->unloadedSectionsView(changed);
+}
+
+/**
+ * Collects the keys of all sections listed in a chunk, including uniform ones.
+ */
+static void collectSectionKeys(const NBT::TagTable& chunk, int32_t chunk_x, int32_t chunk_z, std::vector<uint64_t>& out) {
+	const NBT::FlatTag* sections = chunk.getTag(chunk.root(), "sections");
+	if (!sections)
+		return;
+	for (const NBT::FlatTag* section = chunk.firstChild(sections); section; section = chunk.nextSibling(section))
+		out.push_back(SectionKey::pack(chunk_x, NBT::getGeneric<int8_t>(chunk, section, "Y"), chunk_z));
+}
+
+void DimensionData::removeChunk(int32_t chunk_x, int32_t chunk_z, std::vector<uint64_t>* changed_sections) {
+	uint64_t key = ColumnKey::pack(chunk_x, chunk_z);
+	this->externalChunks.erase(key);
+	const std::unique_ptr<const NBT::TagTable>* chunk = this->nbtChunks.find(key);
+	if (!chunk)
+		return;
+
+	std::vector<uint64_t> sections;
+	if (*chunk) {
+		collectSectionKeys(**chunk, chunk_x, chunk_z, sections);
+	} else {
+		// Chunks restored from a world cache have no NBT to list their sections.
+		for (int32_t y = INT8_MIN; y <= INT8_MAX; y++) {
+			uint64_t section = SectionKey::pack(chunk_x, int8_t(y), chunk_z);
+			if (this->sectionBlockIndices.find(section) || this->uniformSections.find(section) || this->sectionOccupancy.find(section) ||
+				this->sectionBiomes.contains(section) || this->blockLight.contains(section) || this->skyLight.contains(section))
+				sections.push_back(section);
+		}
+	}
+	for (uint64_t section : sections) {
+		this->expandedSections.invalidate(section);
+		this->sectionBlockIndices.erase(section);
+		this->uniformSections.erase(section);
+		this->sectionOccupancy.erase(section);
+		this->sectionBiomes.erase(section);
+		this->blockLight.erase(section);
+		this->skyLight.erase(section);
+	}
+	this->chunkHeights.erase(key);
+	this->heightPyramid.set(chunk_x, chunk_z, ChunkHeights());
+	if (changed_sections)
+		changed_sections->insert(changed_sections->end(), sections.begin(), sections.end());
+	this->nbtChunks.erase(key);
+}
+
+void DimensionData::insertChunk(DecodedChunk& chunk, std::vector<uint64_t>* changed_sections) {
+	this->removeChunk(chunk.chunk_x, chunk.chunk_z, changed_sections);
+	if (changed_sections && chunk.nbt)
+		collectSectionKeys(*chunk.nbt, chunk.chunk_x, chunk.chunk_z, *changed_sections);
+	this->nbtChunks.insertOrAssign(ColumnKey::pack(chunk.chunk_x, chunk.chunk_z), std::move(chunk.nbt));
+	for (auto& [key, packed] : chunk.sections) {
+		this->expandedSections.invalidate(key);
+		this->sectionBlockIndices.insertOrAssign(key, std::move(packed));
+	}
+	for (auto [key, state] : chunk.uniform_sections)
+		this->uniformSections.insertOrAssign(key, state);
+	for (const auto& [key, occupancy] : chunk.occupancy)
+		this->sectionOccupancy.insertOrAssign(key, occupancy);
+	for (const auto& [key, sectionBiomeValues] : chunk.biomes)
+		this->sectionBiomes.insertOrAssign(key, sectionBiomeValues);
+	for (const auto& [key, light] : chunk.block_light)
+		this->blockLight.insertOrAssign(key, light);
+	for (const auto& [key, light] : chunk.sky_light)
+		this->skyLight.insertOrAssign(key, light);
+	if (chunk.heights.known())
+		this->chunkHeights.insertOrAssign(ColumnKey::pack(chunk.chunk_x, chunk.chunk_z), chunk.heights);
+	this->heightPyramid.set(chunk.chunk_x, chunk.chunk_z, chunk.heights);
+	chunk.sections.clear();
+	chunk.uniform_sections.clear();
+	chunk.occupancy.clear();
+	chunk.biomes.clear();
+	chunk.block_light.clear();
+	chunk.sky_light.clear();
+}
+
+emscripten::val DimensionData::unloadedSectionsView(const std::vector<uint64_t>& keys) {
+	this->unloadedSections.clear();
+	this->unloadedSections.reserve(keys.size() * 3);
+	for (uint64_t key : keys) {
+		this->unloadedSections.push_back(SectionKey::x(key));
+		this->unloadedSections.push_back(SectionKey::y(key));
+		this->unloadedSections.push_back(SectionKey::z(key));
+	}
+	return emscripten::val(emscripten::typed_memory_view(this->unloadedSections.size(), this->unloadedSections.data()));
+}
+
+emscripten::val DimensionData::unloadChunk(int32_t chunk_x, int32_t chunk_z) {
+	std::vector<uint64_t> removed;
+	this->removeChunk(chunk_x, chunk_z, &removed);
+	return this->unloadedSectionsView(removed);
+}
+
+emscripten::val DimensionData::unloadRegion(int32_t region_x, int32_t region_z) {
+	std::vector<uint64_t> removed;
+	for (uint32_t i = 0; i < chunks_per_region; i++)
+		this->removeChunk(region_x * 32 + int32_t(i % 32), region_z * 32 + int32_t(i / 32), &removed);
+	uint64_t key = ColumnKey::pack(region_x, region_z);
+	this->regionsRawData.erase(key);
+	this->regionIndex.erase(key);
+	this->heightPyramid.eraseRegion(region_x, region_z);
+	return this->unloadedSectionsView(removed);
+}
+
+RegionIndex RegionIndex::fromHeader(const uint8_t* header) {
+	RegionIndex index;
+	for (uint32_t i = 0; i < chunks_per_region; i++) {
+		ChunkDescription description = getChunkDescription(header, uint8_t(i % 32), uint8_t(i / 32));
+		if (description.offset == 0 || description.sectorCount == 0)
+			continue;
+		index.present[i >> 6] |= uint64_t(1) << (i & 63);
+		index.num_chunks++;
+		index.num_sectors += description.sectorCount;
+		index.newest_timestamp = std::max(index.newest_timestamp, readU32AsBigEndian(header + region_timestamps_offset + i * 4, 4));
 	}
+	return index;
+}
+
+void DimensionData::indexRegion(int32_t region_x, int32_t region_z) {
+	uint64_t key = ColumnKey::pack(region_x, region_z);
+	const RegionFile* region = this->regionsRawData.find(key);
+	if (region)
+		this->regionIndex.insertOrAssign(key, RegionIndex::fromHeader(region->data.get()));
+}
+
+bool DimensionData::hasChunk(int32_t chunk_x, int32_t chunk_z) const {
+	uint64_t key = ColumnKey::pack(chunk_x >> 5, chunk_z >> 5);
+	uint32_t i = uint32_t(modulus(chunk_z, 32) * 32 + modulus(chunk_x, 32));
+	if (const RegionIndex* regionEntry = this->regionIndex.find(key))
+		return regionEntry->contains(i);
+	const RegionFile* region = this->regionsRawData.find(key);
+	if (!region)
+		return false;
+	ChunkDescription description = getChunkDescription(region->data.get(), uint8_t(i % 32), uint8_t(i / 32));
+	return description.offset != 0 && description.sectorCount != 0;
+}
 
-	this->nbtChunks[std::make_tuple(chunk_x, chunk_z)] = chunk;
-	buildChunkSections(this->sectionBlockIndices, chunk);
+uint32_t DimensionData::numIndexedChunks() const {
+	uint32_t count = 0;
+	this->regionIndex.forEach([&count](uint64_t, const RegionIndex& regionEntry) { count += regionEntry.num_chunks; });
+	return count;
+}
+
+emscripten::val DimensionData::getIndexedChunks() {
+	this->indexedChunks.clear();
+	this->regionIndex.forEachMorton([this](uint64_t key, const RegionIndex& regionEntry) {
+		for (uint32_t i = 0; i < chunks_per_region; i++) {
+			if (!regionEntry.contains(i))
+				continue;
+			this->indexedChunks.push_back(ColumnKey::x(key) * 32 + int32_t(i % 32));
+			this->indexedChunks.push_back(ColumnKey::z(key) * 32 + int32_t(i / 32));
+		}
+	});
+	return emscripten::val(emscripten::typed_memory_view(this->indexedChunks.size(), this->indexedChunks.data()));
+}
+
+int DimensionData::buildChunk(int chunk_x, int chunk_z) {
+	DecodedChunk decoded;
+	int status = this->decodeChunk(chunk_x, chunk_z, decoded);
+	if (status == -4)
+		this->markExternalChunk(decoded);
+	if (status != 0)
+		return status;
+	this->insertChunk(decoded);
 	return 0;
 }
 
-const NBT::CompoundTag* DimensionData::getChunk(int32_t chunk_x, int32_t chunk_z) {
-	try {
-		return this->nbtChunks.at(std::make_tuple(chunk_x, chunk_z));
-	} catch (const std::out_of_range& e) {
-		return NULL;
+int DimensionData::buildExternalChunk(int32_t chunk_x, int32_t chunk_z, uintptr_t byte_offset, uint32_t byte_length) {
+	std::unique_ptr<uint8_t[]> data(reinterpret_cast<uint8_t*>(byte_offset));
+	const uint8_t* compression = this->externalChunks.find(ColumnKey::pack(chunk_x, chunk_z));
+	if (!compression) {
+		std::cerr << "Chunk " << chunk_x << ", " << chunk_z << " is not stored externally." << std::endl;
+		return -1;
 	}
+	DecodedChunk decoded;
+	int status = this->decodeExternalChunk(chunk_x, chunk_z, *compression, data.get(), byte_length, decoded);
+	if (status != 0)
+		return status;
+	this->insertChunk(decoded);
+	return 0;
+}
+
+const NBT::TagTable* DimensionData::getChunk(int32_t chunk_x, int32_t chunk_z) {
+	const std::unique_ptr<const NBT::TagTable>* chunk = this->nbtChunks.find(ColumnKey::pack(chunk_x, chunk_z));
+	return chunk ? chunk->get() : nullptr;
 }
 
 std::string DimensionData::getPalette(int32_t chunk_x, int8_t y, int32_t chunk_z) {
-	auto chunk = this->nbtChunks[std::make_tuple(chunk_x, chunk_z)];
-	auto sections = chunk->getTag<NBT::ListTag>("sections");
-	for (auto sectionBase : sections->value) {
-		auto section = sectionBase->as<NBT::CompoundTag>();
-		auto Y = section->getTag<NBT::ByteTag>("Y")->value;
+	const NBT::TagTable* chunk = this->getChunk(chunk_x, chunk_z);
+	if (!chunk)
+		return "";
+	const NBT::FlatTag* sections = chunk->getTag(chunk->root(), "sections");
+	if (!sections)
+		return "";
+	for (const NBT::FlatTag* section = chunk->firstChild(sections); section; section = chunk->nextSibling(section)) {
+		auto Y = NBT::getGeneric<int8_t>(*chunk, section, "Y");
 		if (y == Y) {
 			std::ostringstream oss;
-			section->getTag<NBT::CompoundTag>("block_states")->getTag<NBT::ListTag>("palette")->displayContent(oss);
+			chunk->displayContent(NBT::getTag(*chunk, section, "block_states.palette"), oss);
 			return oss.str();
 		}
 	}
 	return "";
 }
 
-emscripten::val DimensionData::getSectionView(int32_t chunk_x, int8_t section_y, int8_t chunk_z) {
-	const uint16_t* section;
-	try {
-		section = this->sectionBlockIndices.at(std::make_tuple(chunk_x, section_y, chunk_z));
-	} catch (const std::out_of_range& e) {
-		std::ostringstream oss;
-		oss << "The given section at dimension \"" << this->name << "\", X: " << chunk_x << ", Y: " << int(section_y) << ", Z: " << chunk_z << " is not known." << std::endl;
-		throw std::runtime_error(oss.str());
+bool DimensionData::unpackSection(int32_t chunk_x, int8_t section_y, int32_t chunk_z, uint16_t* out) const {
+	const PackedSection* section = this->sectionBlockIndices.find(SectionKey::pack(chunk_x, section_y, chunk_z));
+	if (!section)
+		return false;
+	kayo::minecraft::unpackSection(*section, out);
+	return true;
+}
+
+bool DimensionData::unpackSectionStates(int32_t chunk_x, int8_t section_y, int32_t chunk_z, uint32_t* out) const {
+	uint64_t key = SectionKey::pack(chunk_x, section_y, chunk_z);
+	if (const uint32_t* state = this->uniformSections.find(key)) {
+		std::fill(out, out + blocks_per_section, *state);
+		return true;
+	}
+	const PackedSection* section = this->sectionBlockIndices.find(key);
+	if (!section)
+		return false;
+	uint16_t indices[blocks_per_section];
+	kayo::minecraft::unpackSection(*section, indices);
+	const uint32_t* palette = section->palette.data();
+	uint16_t paletteSize = uint16_t(section->palette.size());
+	for (uint32_t i = 0; i < blocks_per_section; i++)
+		out[i] = indices[i] < paletteSize ? palette[indices[i]] : 0;
+	return true;
+}
+
+void DimensionData::updateSectionOccupancy(uint64_t key, ColumnSurfaces& surfaces) {
+	int8_t sectionY = SectionKey::y(key);
+	std::vector<uint8_t> air;
+	if (const uint32_t* state = this->uniformSections.find(key)) {
+		this->sectionOccupancy.erase(key);
+		this->blockStates.airFlags({*state}, air);
+		if (!air[0])
+			includeSolidSectionSurfaces(sectionY, surfaces);
+		return;
+	}
+	const PackedSection* section = this->sectionBlockIndices.find(key);
+	if (!section) {
+		this->sectionOccupancy.erase(key);
+		return;
+	}
+	this->blockStates.airFlags(section->palette, air);
+	SectionOccupancy& occupancy = this->sectionOccupancy[key];
+	buildSectionOccupancy(*section, air, occupancy);
+	includeSectionSurfaces(occupancy, sectionY, surfaces);
+}
+
+void DimensionData::setChunkHeights(int32_t chunk_x, int32_t chunk_z, const ChunkHeights& heights) {
+	if (heights.known())
+		this->chunkHeights.insertOrAssign(ColumnKey::pack(chunk_x, chunk_z), heights);
+	else
+		this->chunkHeights.erase(ColumnKey::pack(chunk_x, chunk_z));
+	this->heightPyramid.set(chunk_x, chunk_z, heights);
+}
+
+void DimensionData::updateChunkOccupancy(int32_t chunk_x, int32_t chunk_z) {
+	ColumnSurfaces surfaces;
+	surfaces.fill(INT16_MIN);
+	for (int32_t y = INT8_MIN; y <= INT8_MAX; y++)
+		this->updateSectionOccupancy(SectionKey::pack(chunk_x, int8_t(y), chunk_z), surfaces);
+	this->setChunkHeights(chunk_x, chunk_z, summarizeSurfaces(surfaces));
+}
+
+int32_t DimensionData::getSectionOccupancy(int32_t chunk_x, int8_t section_y, int32_t chunk_z) const {
+	uint64_t key = SectionKey::pack(chunk_x, section_y, chunk_z);
+	if (const uint32_t* state = this->uniformSections.find(key)) {
+		std::vector<uint8_t> air;
+		this->blockStates.airFlags({*state}, air);
+		return air[0] ? 0 : 2;
+	}
+	const SectionOccupancy* occupancy = this->sectionOccupancy.find(key);
+	if (!occupancy)
+		return -1;
+	return occupancy->count == 0 ? 0 : occupancy->count == blocks_per_section ? 2 : 1;
+}
+
+emscripten::val DimensionData::getSectionOccupancyBits(int32_t chunk_x, int8_t section_y, int32_t chunk_z) {
+	const SectionOccupancy* occupancy = this->sectionOccupancy.find(SectionKey::pack(chunk_x, section_y, chunk_z));
+	if (!occupancy)
+		this->throwUnknownSection(chunk_x, section_y, chunk_z);
+	return emscripten::val(emscripten::typed_memory_view(blocks_per_section / 32, reinterpret_cast<const uint32_t*>(occupancy->bits.data())));
+}
+
+bool DimensionData::isSectionOpaque(int32_t chunk_x, int8_t section_y, int32_t chunk_z, const BlockModelTable& block_models) const {
+	uint64_t key = SectionKey::pack(chunk_x, section_y, chunk_z);
+	std::vector<const BlockModel*> models;
+	if (const uint32_t* state = this->uniformSections.find(key)) {
+		block_models.resolveStates(this->blockStates, state, 1, models);
+	} else {
+		const PackedSection* section = this->sectionBlockIndices.find(key);
+		if (!section)
+			return false;
+		block_models.resolveStates(this->blockStates, section->palette.data(), section->palette.size(), models);
+	}
+	return std::all_of(models.begin(), models.end(), [](const BlockModel* model) { return model->opaque; });
+}
+
+bool DimensionData::isSectionEnclosed(int32_t chunk_x, int8_t section_y, int32_t chunk_z, const BlockModelTable* block_models) const {
+	if (!block_models || section_y == INT8_MIN || section_y == INT8_MAX)
+		return false;
+	const int32_t offsets[block_faces][3] = {{0, -1, 0}, {0, 1, 0}, {0, 0, -1}, {0, 0, 1}, {-1, 0, 0}, {1, 0, 0}};
+	for (const auto& offset : offsets) {
+		if (!this->isSectionOpaque(chunk_x + offset[0], int8_t(section_y + offset[1]), chunk_z + offset[2], *block_models))
+			return false;
 	}
+	return true;
+}
+
+ChunkHeights DimensionData::getSurfaceHeights(uint32_t level, int32_t chunk_x, int32_t chunk_z) const {
+	return this->heightPyramid.get(level, chunk_x, chunk_z);
+}
+
+void DimensionData::throwUnknownSection(int32_t chunk_x, int8_t section_y, int32_t chunk_z) const {
+	std::ostringstream oss;
+	oss << "The given section at dimension \"" << this->name << "\", X: " << chunk_x << ", Y: " << int(section_y) << ", Z: " << chunk_z << " is not known." << std::endl;
+	throw std::runtime_error(oss.str());
+}
+
+emscripten::val DimensionData::getSectionView(int32_t chunk_x, int8_t section_y, int32_t chunk_z) {
+	uint64_t key = SectionKey::pack(chunk_x, section_y, chunk_z);
+	const PackedSection* section = this->sectionBlockIndices.find(key);
+	if (!section)
+		this->throwUnknownSection(chunk_x, section_y, chunk_z);
+
+	return emscripten::val(emscripten::typed_memory_view(blocks_per_section, this->expandedSections.get(key, *section)));
+}
 
-	return emscripten::val(emscripten::typed_memory_view(4096 * 2, section));
+emscripten::val DimensionData::getSectionPaletteIds(int32_t chunk_x, int8_t section_y, int32_t chunk_z) {
+	uint64_t key = SectionKey::pack(chunk_x, section_y, chunk_z);
+	if (const uint32_t* state = this->uniformSections.find(key))
+		return emscripten::val(emscripten::typed_memory_view(1, state));
+	const PackedSection* section = this->sectionBlockIndices.find(key);
+	if (!section)
+		this->throwUnknownSection(chunk_x, section_y, chunk_z);
+	return emscripten::val(emscripten::typed_memory_view(section->palette.size(), section->palette.data()));
+}
+
+emscripten::val DimensionData::getSectionStates(int32_t chunk_x, int8_t section_y, int32_t chunk_z) {
+	this->sectionStates.resize(blocks_per_section);
+	if (!this->unpackSectionStates(chunk_x, section_y, chunk_z, this->sectionStates.data()))
+		this->throwUnknownSection(chunk_x, section_y, chunk_z);
+	return emscripten::val(emscripten::typed_memory_view(blocks_per_section, this->sectionStates.data()));
+}
+
+emscripten::val DimensionData::getSectionBiomes(int32_t chunk_x, int8_t section_y, int32_t chunk_z) {
+	const SectionBiomes* section = this->sectionBiomes.find(SectionKey::pack(chunk_x, section_y, chunk_z));
+	if (!section)
+		this->throwUnknownSection(chunk_x, section_y, chunk_z);
+	return emscripten::val(emscripten::typed_memory_view(biomes_per_section, section->data()));
+}
+
+emscripten::val DimensionData::getSectionBlockLight(int32_t chunk_x, int8_t section_y, int32_t chunk_z) {
+	const NibbleArray* light = this->blockLight.find(SectionKey::pack(chunk_x, section_y, chunk_z));
+	if (!light)
+		return emscripten::val::undefined();
+	return emscripten::val(emscripten::typed_memory_view(light_bytes_per_section, light->data()));
+}
+
+emscripten::val DimensionData::getSectionSkyLight(int32_t chunk_x, int8_t section_y, int32_t chunk_z) {
+	const NibbleArray* light = this->skyLight.find(SectionKey::pack(chunk_x, section_y, chunk_z));
+	if (!light)
+		return emscripten::val::undefined();
+	return emscripten::val(emscripten::typed_memory_view(light_bytes_per_section, light->data()));
 }
 
 void DimensionData::openRegion(int32_t region_x, int32_t region_z, std::string file) {
-	uint8_t* data = new Bytef[file.size()];
+	uint8_t* data = new uint8_t[file.size()];
 	std::memcpy(data, file.data(), file.size());
-	this->regionsRawData[std::tuple<int, int>(region_x, region_z)] = data;
+	this->adoptRegion(region_x, region_z, reinterpret_cast<uintptr_t>(data), uint32_t(file.size()));
 }
 
-DimensionData::DimensionData(std::string name, int32_t index) : name(name), index(index) {}
-WorldData::WorldData(std::string name) : name(name) {}
+void DimensionData::adoptRegion(int32_t region_x, int32_t region_z, uintptr_t byte_offset, uint32_t byte_length) {
+	std::unique_ptr<uint8_t[]> data(reinterpret_cast<uint8_t*>(byte_offset));
+	if (byte_length < region_header_bytes) {
+		std::cerr << "Region " << region_x << ", " << region_z << " is too short for a region file." << std::endl;
+		return;
+	}
+	uint64_t key = ColumnKey::pack(region_x, region_z);
+	RegionFile& region = this->regionsRawData[key];
+	this->regionIndex.erase(key);
+	region.data = std::move(data);
+	region.length = byte_length;
+}
+
+std::vector<uint16_t> DimensionData::reloadRegion(int32_t region_x, int32_t region_z, uintptr_t byte_offset, uint32_t byte_length, std::vector<uint64_t>* changed_sections) {
+	std::vector<uint16_t> changed;
+	const uint8_t* data = reinterpret_cast<const uint8_t*>(byte_offset);
+	if (byte_length < region_header_bytes) {
+		this->adoptRegion(region_x, region_z, byte_offset, byte_length);
+		return changed;
+	}
+
+	// Both the location and the timestamp are compared, as a chunk may be rewritten within the same second.
+	const RegionFile* previous = this->regionsRawData.find(ColumnKey::pack(region_x, region_z));
+	for (uint32_t i = 0; i < chunks_per_region; i++) {
+		const uint8_t* location = data + i * 4;
+		const uint8_t* timestamp = data + region_timestamps_offset + i * 4;
+		if (previous && std::memcmp(location, previous->data.get() + i * 4, 4) == 0 && std::memcmp(timestamp, previous->data.get() + region_timestamps_offset + i * 4, 4) == 0)
+			continue;
+		// The old chunk goes away even if the new one fails to decode or is stored externally, so no stale sections remain.
+		this->removeChunk(region_x * 32 + int32_t(i % 32), region_z * 32 + int32_t(i / 32), changed_sections);
+		ChunkDescription description = getChunkDescription(data, uint8_t(i % 32), uint8_t(i / 32));
+		if (description.offset != 0 && description.sectorCount != 0)
+			changed.push_back(uint16_t(i));
+	}
+	bool indexed = this->regionIndex.find(ColumnKey::pack(region_x, region_z)) != nullptr;
+	this->adoptRegion(region_x, region_z, byte_offset, byte_length);
+	if (indexed)
+		this->indexRegion(region_x, region_z);
+	return changed;
+}
+
+void DimensionData::releaseRegionData(int32_t region_x, int32_t region_z) {
+	RegionFile* region = this->regionsRawData.find(ColumnKey::pack(region_x, region_z));
+	if (!region || !region->hasChunkData())
+		return;
+	std::unique_ptr<uint8_t[]> header(new uint8_t[region_header_bytes]);
+	std::memcpy(header.get(), region->data.get(), region_header_bytes);
+	region->data = std::move(header);
+	region->length = region_header_bytes;
+}
+
+/**
+ * The number of expanded sections kept for {@link DimensionData::getSectionView} (8 KiB each).
+ */
+constexpr uint32_t expanded_section_cache_size = 256;
+
+/**
+ * All dimensions alive, for {@link minecraftMemoryUsage}.
+ */
+static std::vector<const DimensionData*>& liveDimensions() {
+	static std::vector<const DimensionData*> dimensions;
+	return dimensions;
+}
+
+DimensionData::DimensionData(std::string name, int32_t index)
+	: name(name), index(index), blockStates(BlockStateRegistry::global()), biomes(BiomeRegistry::global()), expandedSections(expanded_section_cache_size) {
+	liveDimensions().push_back(this);
+}
+
+DimensionData::~DimensionData() {
+	std::vector<const DimensionData*>& dimensions = liveDimensions();
+	dimensions.erase(std::remove(dimensions.begin(), dimensions.end(), this), dimensions.end());
+}
+
+MemoryUsage& MemoryUsage::operator+=(const MemoryUsage& other) {
+	region_files += other.region_files;
+	chunk_nbt += other.chunk_nbt;
+	block_sections += other.block_sections;
+	occupancy += other.occupancy;
+	biomes += other.biomes;
+	light += other.light;
+	caches += other.caches;
+	registries += other.registries;
+	return *this;
+}
+
+MemoryUsage DimensionData::memoryUsage() const {
+	MemoryUsage usage;
+	usage.region_files = this->regionsRawData.byteSize() + this->regionIndex.byteSize();
+	this->regionsRawData.forEach([&usage](uint64_t, const RegionFile& region) { usage.region_files += region.length; });
+	usage.chunk_nbt = this->nbtChunks.byteSize();
+	this->nbtChunks.forEach([&usage](uint64_t, const std::unique_ptr<const NBT::TagTable>& chunk) {
+		if (chunk)
+			usage.chunk_nbt += chunk->byteSize();
+	});
+	usage.block_sections = this->sectionBlockIndices.byteSize() + this->uniformSections.byteSize();
+	this->sectionBlockIndices.forEach([&usage](uint64_t, const PackedSection& section) { usage.block_sections += section.data.capacity() * sizeof(uint64_t) + section.palette.capacity() * sizeof(uint32_t); });
+	usage.occupancy = this->sectionOccupancy.byteSize() + this->chunkHeights.byteSize() + this->heightPyramid.byteSize();
+	usage.biomes = this->sectionBiomes.byteSize();
+	usage.light = this->blockLight.byteSize() + this->skyLight.byteSize();
+	usage.caches = this->expandedSections.byteSize() + this->externalChunks.byteSize();
+	usage.caches += this->sectionStates.capacity() * sizeof(uint32_t) + (this->indexedChunks.capacity() + this->unloadedSections.capacity()) * sizeof(int32_t);
+	return usage;
+}
+
+MemoryUsage minecraftMemoryUsage() {
+	MemoryUsage usage;
+	for (const DimensionData* dimension : liveDimensions())
+		usage += dimension->memoryUsage();
+	usage.registries = BlockStateRegistry::global().byteSize() + BiomeRegistry::global().byteSize();
+	return usage;
+}
 
 } // namespace minecraft
 } // namespace kayo
 
 using namespace emscripten;
 EMSCRIPTEN_BINDINGS(KayoWasmMinecraft) {
-	class_<kayo::minecraft::WorldData>("KayoWASMMinecraftWorld")
-		.constructor<std::string>();
 	class_<kayo::minecraft::DimensionData>("KayoWASMMinecraftDimension")
 		.constructor<std::string, int32_t>()
 		.function("openRegion", &kayo::minecraft::DimensionData::openRegion)
+		.function("adoptRegion", &kayo::minecraft::DimensionData::adoptRegion)
+		.function("releaseRegionData", &kayo::minecraft::DimensionData::releaseRegionData)
+		.function("indexRegion", &kayo::minecraft::DimensionData::indexRegion)
+		.function("hasChunk", &kayo::minecraft::DimensionData::hasChunk)
+		.function("numIndexedChunks", &kayo::minecraft::DimensionData::numIndexedChunks)
+		.function("getIndexedChunks", &kayo::minecraft::DimensionData::getIndexedChunks)
+		.function("unloadChunk", &kayo::minecraft::DimensionData::unloadChunk)
+		.function("unloadRegion", &kayo::minecraft::DimensionData::unloadRegion)
+		.function("memoryUsage", &kayo::minecraft::DimensionData::memoryUsage)
 		.function("buildChunk", &kayo::minecraft::DimensionData::buildChunk)
+		.function("buildExternalChunk", &kayo::minecraft::DimensionData::buildExternalChunk)
+		.function("mergeExternalChunks", &kayo::minecraft::DimensionData::mergeExternalChunks)
 		.function("getPalette", &kayo::minecraft::DimensionData::getPalette)
-		.function("getSectionView", &kayo::minecraft::DimensionData::getSectionView);
+		.function("getSectionView", &kayo::minecraft::DimensionData::getSectionView)
+		.function("getSectionPaletteIds", &kayo::minecraft::DimensionData::getSectionPaletteIds)
+		.function("getSectionStates", &kayo::minecraft::DimensionData::getSectionStates)
+		.function("getSectionBiomes", &kayo::minecraft::DimensionData::getSectionBiomes)
+		.function("getSectionBlockLight", &kayo::minecraft::DimensionData::getSectionBlockLight)
+		.function("getSectionSkyLight", &kayo::minecraft::DimensionData::getSectionSkyLight)
+		.function("getSectionOccupancy", &kayo::minecraft::DimensionData::getSectionOccupancy)
+		.function("getSectionOccupancyBits", &kayo::minecraft::DimensionData::getSectionOccupancyBits)
+		.function("isSectionEnclosed", &kayo::minecraft::DimensionData::isSectionEnclosed, allow_raw_pointers())
+		.function("getSurfaceHeights", &kayo::minecraft::DimensionData::getSurfaceHeights);
+	value_object<kayo::minecraft::MemoryUsage>("MinecraftMemoryUsage")
+		.field("regionFiles", &kayo::minecraft::MemoryUsage::region_files)
+		.field("chunkNbt", &kayo::minecraft::MemoryUsage::chunk_nbt)
+		.field("blockSections", &kayo::minecraft::MemoryUsage::block_sections)
+		.field("occupancy", &kayo::minecraft::MemoryUsage::occupancy)
+		.field("biomes", &kayo::minecraft::MemoryUsage::biomes)
+		.field("light", &kayo::minecraft::MemoryUsage::light)
+		.field("caches", &kayo::minecraft::MemoryUsage::caches)
+		.field("registries", &kayo::minecraft::MemoryUsage::registries);
+	function("getMinecraftMemoryUsage", &kayo::minecraft::minecraftMemoryUsage);
 }
@@ -1,37 +1,366 @@
 #pragma once
+#include "blockModels.hpp"
+#include "blockStateRegistry.hpp"
 #include "nbt.hpp"
+#include "nbtTable.hpp"
+#include "occupancy.hpp"
+#include "sectionStore.hpp"
+#include "spatialHash.hpp"
+#include <algorithm>
 #include <emscripten/bind.h>
+#include <iterator>
+#include <mutex>
 
 namespace kayo {
 namespace minecraft {
 
-typedef std::map<std::tuple<int, int>, const uint8_t*> RegionsRawData;
-typedef std::map<std::tuple<uint8_t, uint8_t>, const NBT::CompoundTag*> NBTChunks;
-typedef std::map<std::tuple<int, int8_t, int>, const uint16_t*> SectionBlockIndices;
+/**
+ * The size of the region file header: 4 KiB chunk locations followed by 4 KiB timestamps.
+ */
+constexpr uint32_t region_header_bytes = 8192;
+constexpr uint32_t region_timestamps_offset = 4096;
+constexpr uint32_t chunks_per_region = 32 * 32;
+
+constexpr uint32_t biomes_per_section = 4 * 4 * 4;
+constexpr uint32_t light_bytes_per_section = blocks_per_section / 2;
+
+/**
+ * The biome ids of a section, one per 4x4x4 blocks in YZX order.
+ */
+typedef std::array<uint32_t, biomes_per_section> SectionBiomes;
+/**
+ * A light level of 0 to 15 per block of a section in YZX order, packed two per byte with the lower nibble first as stored by Minecraft.
+ */
+typedef std::array<uint8_t, light_bytes_per_section> NibbleArray;
+
+/**
+ * The raw bytes of an opened region file.
+ * Once all chunks are decoded the chunk sectors are released and only the header is kept.
+ */
+struct RegionFile {
+	std::unique_ptr<uint8_t[]> data;
+	uint32_t length = 0;
+	bool hasChunkData() const { return length > region_header_bytes; }
+};
+
+/**
+ * The chunks a region file stores according to its header, gathered before any chunk is decoded.
+ */
+struct RegionIndex {
+	/**
+	 * One bit per chunk of the region, indexed by z * 32 + x.
+	 */
+	std::array<uint64_t, chunks_per_region / 64> present{};
+	uint32_t num_chunks = 0;
+	/**
+	 * The 4 KiB sectors occupied by all chunks.
+	 */
+	uint32_t num_sectors = 0;
+	/**
+	 * The newest modification time of any chunk in seconds since the epoch.
+	 */
+	uint32_t newest_timestamp = 0;
+
+	bool contains(uint32_t index) const { return (present[index >> 6] >> (index & 63)) & 1; }
+	/**
+	 * Reads the location and timestamp tables of a region file header of {@link region_header_bytes}.
+	 */
+	static RegionIndex fromHeader(const uint8_t* header);
+};
+
+typedef SpatialHashMap<ColumnKey, RegionFile> RegionsRawData;
+/**
+ * The NBT of every loaded chunk. Chunks restored without their NBT, e.g. from a world cache, map to nullptr.
+ */
+typedef SpatialHashMap<ColumnKey, std::unique_ptr<const NBT::TagTable>> NBTChunks;
+typedef SpatialHashMap<SectionKey, PackedSection> SectionBlockIndices;
+
+/**
+ * The bytes held by the subsystems of one or more dimensions, including the tables of their containers.
+ * Allocator overhead is not included, see {@link kayo::memUtils::getHeapUsage} for the size of the whole heap.
+ */
+struct MemoryUsage {
+	/**
+	 * Region files and their indexed headers.
+	 */
+	size_t region_files = 0;
+	size_t chunk_nbt = 0;
+	/**
+	 * Packed and uniform block states of all sections.
+	 */
+	size_t block_sections = 0;
+	/**
+	 * Section occupancy, chunk heights and the height pyramid.
+	 */
+	size_t occupancy = 0;
+	size_t biomes = 0;
+	size_t light = 0;
+	/**
+	 * Expanded sections and other scratch buffers.
+	 */
+	size_t caches = 0;
+	/**
+	 * The block state and biome registries shared by all dimensions.
+	 */
+	size_t registries = 0;
+
+	MemoryUsage& operator+=(const MemoryUsage& other);
+	size_t total() const { return region_files + chunk_nbt + block_sections + occupancy + biomes + light + caches + registries; }
+};
+
+/**
+ * The result of decoding a single chunk, before it is inserted into a {@link DimensionData}.
+ */
+struct DecodedChunk {
+	int32_t chunk_x;
+	int32_t chunk_z;
+	std::unique_ptr<const NBT::TagTable> nbt;
+	/**
+	 * The {@link SectionKey}s and packed block indices of the non uniform sections.
+	 */
+	std::vector<std::pair<uint64_t, PackedSection>> sections;
+	/**
+	 * The {@link SectionKey}s and block state ids of the uniform sections.
+	 */
+	std::vector<std::pair<uint64_t, uint32_t>> uniform_sections;
+	/**
+	 * The {@link SectionKey}s and occupancy of the non uniform sections.
+	 */
+	std::vector<std::pair<uint64_t, SectionOccupancy>> occupancy;
+	ChunkHeights heights;
+	std::vector<std::pair<uint64_t, SectionBiomes>> biomes;
+	std::vector<std::pair<uint64_t, NibbleArray>> block_light;
+	std::vector<std::pair<uint64_t, NibbleArray>> sky_light;
+	/**
+	 * The compression type of the .mcc file if the chunk is stored externally ({@link DimensionData::decodeChunk} returned -4).
+	 */
+	uint8_t external_compression = 0;
+};
 
 class DimensionData {
   public:
 	const std::string name;
 	const int32_t index;
 	DimensionData(std::string name, int32_t index);
+	DimensionData(const DimensionData&) = delete;
+	DimensionData& operator=(const DimensionData&) = delete;
+	~DimensionData();
 	RegionsRawData regionsRawData;
+	/**
+	 * The indexed headers of the opened regions, see {@link indexRegion}.
+	 */
+	SpatialHashMap<ColumnKey, RegionIndex> regionIndex;
 	NBTChunks nbtChunks;
 	SectionBlockIndices sectionBlockIndices;
-	const NBT::CompoundTag* getChunk(int32_t chunk_x, int32_t chunkZ);
+	/**
+	 * The block state ids of sections with a single palette entry, which are not stored in {@link sectionBlockIndices}.
+	 */
+	SpatialHashMap<SectionKey, uint32_t> uniformSections;
+	BlockStateRegistry& blockStates;
+	BiomeRegistry& biomes;
+	/**
+	 * The biomes of all sections with a biome palette, as ids of {@link biomes}.
+	 */
+	DenseSpatialHashMap<SectionKey, SectionBiomes> sectionBiomes;
+	/**
+	 * The light levels of the sections that store them. Sections without light data are dark.
+	 */
+	DenseSpatialHashMap<SectionKey, NibbleArray> blockLight;
+	DenseSpatialHashMap<SectionKey, NibbleArray> skyLight;
+	/**
+	 * The occupancy of the sections in {@link sectionBlockIndices}.
+	 */
+	DenseSpatialHashMap<SectionKey, SectionOccupancy> sectionOccupancy;
+	SpatialHashMap<ColumnKey, ChunkHeights> chunkHeights;
+	HeightPyramid heightPyramid;
+	/**
+	 * The compression types of chunks stored in external .mcc files, which wait for their data from the host.
+	 */
+	SpatialHashMap<ColumnKey, uint8_t> externalChunks;
+	/**
+	 * The sections most recently expanded for {@link getSectionView}.
+	 */
+	ExpandedSectionCache expandedSections;
+	const NBT::TagTable* getChunk(int32_t chunk_x, int32_t chunk_z);
+	/**
+	 * Copies a region file into the WASM heap. Prefer {@link adoptRegion}, which avoids the copy.
+	 */
 	void openRegion(int32_t region_x, int32_t region_z, std::string file);
+	/**
+	 * Takes ownership of a region file the host wrote into a buffer obtained from allocArrayUint8.
+	 * The buffer may hold only the header, which makes the chunks of the region known before the file is read completely.
+	 */
+	void adoptRegion(int32_t region_x, int32_t region_z, uintptr_t byte_offset, uint32_t byte_length);
+	/**
+	 * Frees the chunk sectors of a region and keeps its header. Chunks of the region can not be decoded afterwards.
+	 */
+	void releaseRegionData(int32_t region_x, int32_t region_z);
+	/**
+	 * Indexes the header of an opened region. Opening a region drops its previous index,
+	 * an {@link IndexWorldTask} indexes all regions of a world in parallel.
+	 */
+	void indexRegion(int32_t region_x, int32_t region_z);
+	/**
+	 * Whether an opened region stores a chunk, without decoding it.
+	 */
+	bool hasChunk(int32_t chunk_x, int32_t chunk_z) const;
+	uint32_t numIndexedChunks() const;
+	/**
+	 * The x and z coordinates of all chunks stored in the opened regions, ordered along the Z-order curve.
+	 * The view is overwritten by the next call.
+	 */
+	emscripten::val getIndexedChunks();
 	int buildChunk(int32_t chunk_x, int32_t chunk_z);
+	/**
+	 * Decodes and inserts an external chunk from a .mcc file the host wrote into a buffer obtained from allocArrayUint8.
+	 * Takes ownership of the buffer.
+	 */
+	int buildExternalChunk(int32_t chunk_x, int32_t chunk_z, uintptr_t byte_offset, uint32_t byte_length);
+	/**
+	 * Decodes a chunk without modifying this dimension.
+	 * May be called from several threads at once as long as no region is opened meanwhile.
+	 * @returns 0 on success, -1 if the region is not open, -2 if the chunk is not stored in the region,
+	 * -3 if the chunk could not be read, -4 if the chunk is stored in an external .mcc file
+	 * and -5 if only the header of the region is loaded, e.g. after {@link releaseRegionData}, so the region has to be opened again.
+	 */
+	int decodeChunk(int32_t chunk_x, int32_t chunk_z, DecodedChunk& out) const;
+	/**
+	 * Decodes the contents of the .mcc file of a chunk with the compression {@link markExternalChunk} recorded for it.
+	 * Only the registries are used, so this may run on any thread while the dimension is modified.
+	 */
+	int decodeExternalChunk(int32_t chunk_x, int32_t chunk_z, uint8_t compression, const uint8_t* data, size_t length, DecodedChunk& out) const;
+	/**
+	 * Records a chunk for which {@link decodeChunk} returned -4, so its .mcc file can be decoded later.
+	 */
+	void markExternalChunk(const DecodedChunk& chunk);
+	/**
+	 * Queues a chunk a {@link DecodeExternalChunkTask} decoded for {@link mergeExternalChunks}. Thread safe.
+	 */
+	void deliverExternalChunk(DecodedChunk& chunk);
+	/**
+	 * Inserts the chunks queued by {@link deliverExternalChunk}. Tasks never insert external chunks themselves,
+	 * so this has to be called from the thread that uses the dimension, while no {@link MeshChunkTask} reads it.
+	 * @returns The x, y and z coordinates of the changed sections. The view is overwritten by the next call.
+	 */
+	emscripten::val mergeExternalChunks();
+	/**
+	 * Removes the chunks queued by {@link deliverExternalChunk} that a consumer like the {@link SectionStreamer} inserts itself. Thread safe.
+	 * @param wanted Called with the chunk x and z of every queued chunk.
+	 */
+	template <typename Wanted>
+	std::vector<DecodedChunk> takeExternalChunks(Wanted wanted) {
+		std::vector<DecodedChunk> taken;
+		std::lock_guard<std::mutex> lock(this->deliveredExternalChunksMutex);
+		auto kept = std::partition(this->deliveredExternalChunks.begin(), this->deliveredExternalChunks.end(), [&](const DecodedChunk& chunk) { return !wanted(chunk.chunk_x, chunk.chunk_z); });
+		std::move(kept, this->deliveredExternalChunks.end(), std::back_inserter(taken));
+		this->deliveredExternalChunks.erase(kept, this->deliveredExternalChunks.end());
+		return taken;
+	}
+	/**
+	 * Inserts a decoded chunk and frees the chunk it replaces, including sections the new chunk no longer stores.
+	 * @param changed_sections Receives the {@link SectionKey}s of all sections of the old and the new chunk.
+	 */
+	void insertChunk(DecodedChunk& chunk, std::vector<uint64_t>* changed_sections = nullptr);
+	/**
+	 * Frees a chunk and its sections.
+	 * @param changed_sections Receives the {@link SectionKey}s of the removed sections.
+	 */
+	void removeChunk(int32_t chunk_x, int32_t chunk_z, std::vector<uint64_t>* changed_sections = nullptr);
+	/**
+	 * Frees a chunk and its sections, see {@link removeChunk}. Chunks resident in a {@link SectionStreamer} are evicted by the streamer instead.
+	 * @returns The x, y and z coordinates of the removed sections. The view is overwritten by the next call.
+	 */
+	emscripten::val unloadChunk(int32_t chunk_x, int32_t chunk_z);
+	/**
+	 * Frees a region file, its index and all chunks of the region, including chunks restored from a world cache.
+	 * @returns The x, y and z coordinates of the removed sections. The view is overwritten by the next call.
+	 */
+	emscripten::val unloadRegion(int32_t region_x, int32_t region_z);
+	MemoryUsage memoryUsage() const;
+	/**
+	 * Replaces a region file with a newer version, like {@link adoptRegion}.
+	 * Chunks whose location or timestamp in the header changed are removed right away and their sections reported as changed.
+	 * The ones that are still stored are collected for decoding.
+	 * @returns The indices (z * 32 + x) of the chunks within the region that have to be decoded again.
+	 */
+	std::vector<uint16_t> reloadRegion(int32_t region_x, int32_t region_z, uintptr_t byte_offset, uint32_t byte_length, std::vector<uint64_t>* changed_sections = nullptr);
+	/**
+	 * Expands the block indices of a non uniform section into out, which has to hold {@link blocks_per_section} elements.
+	 * @returns false if the section is not known or uniform.
+	 */
+	bool unpackSection(int32_t chunk_x, int8_t section_y, int32_t chunk_z, uint16_t* out) const;
+	/**
+	 * Expands the block state ids of a section into out, which has to hold {@link blocks_per_section} elements.
+	 * @returns false if the section is not known.
+	 */
+	bool unpackSectionStates(int32_t chunk_x, int8_t section_y, int32_t chunk_z, uint32_t* out) const;
+	/**
+	 * Recomputes the occupancy of a stored section and includes it in the surfaces of its chunk.
+	 */
+	void updateSectionOccupancy(uint64_t key, ColumnSurfaces& surfaces);
+	void setChunkHeights(int32_t chunk_x, int32_t chunk_z, const ChunkHeights& heights);
+	/**
+	 * Recomputes the occupancy and heights of a chunk from its stored sections, e.g. after loading them from a world cache.
+	 */
+	void updateChunkOccupancy(int32_t chunk_x, int32_t chunk_z);
+	/**
+	 * @returns -1 if the section is not known, 0 if it only contains air, 1 if it is partially and 2 if it is completely filled.
+	 */
+	int32_t getSectionOccupancy(int32_t chunk_x, int8_t section_y, int32_t chunk_z) const;
+	/**
+	 * The occupancy bits of a non uniform section as 128 32 bit words, bit i % 32 of word i / 32 belongs to block i in YZX order.
+	 */
+	emscripten::val getSectionOccupancyBits(int32_t chunk_x, int8_t section_y, int32_t chunk_z);
+	/**
+	 * Whether every block of a section is opaque. Considers all palette entries, even unused ones.
+	 */
+	bool isSectionOpaque(int32_t chunk_x, int8_t section_y, int32_t chunk_z, const BlockModelTable& block_models) const;
+	/**
+	 * Whether all six neighbours of a section are opaque, so nothing inside of it can be seen.
+	 * False if block_models is null, the pointer comes straight from JS through the binding.
+	 */
+	bool isSectionEnclosed(int32_t chunk_x, int8_t section_y, int32_t chunk_z, const BlockModelTable* block_models) const;
+	/**
+	 * The surface heights of the chunks in the cell of the {@link HeightPyramid} at a level (0 to 5) containing a chunk.
+	 */
+	ChunkHeights getSurfaceHeights(uint32_t level, int32_t chunk_x, int32_t chunk_z) const;
+	/**
+	 * The biome ids of a section, see {@link SectionBiomes}.
+	 */
+	emscripten::val getSectionBiomes(int32_t chunk_x, int8_t section_y, int32_t chunk_z);
+	/**
+	 * The packed block light of a section, see {@link NibbleArray}, or undefined if the section stores none.
+	 */
+	emscripten::val getSectionBlockLight(int32_t chunk_x, int8_t section_y, int32_t chunk_z);
+	/**
+	 * The packed sky light of a section, see {@link NibbleArray}, or undefined if the section stores none.
+	 */
+	emscripten::val getSectionSkyLight(int32_t chunk_x, int8_t section_y, int32_t chunk_z);
 	std::string getPalette(int32_t chunk_x, int8_t section_y, int32_t chunk_z);
-	emscripten::val getSectionView(int32_t chunk_x, int8_t section_y, int8_t chunk_z);
-};
+	emscripten::val getSectionView(int32_t chunk_x, int8_t section_y, int32_t chunk_z);
+	/**
+	 * The block state ids of the palette of a section, indexed by the values of {@link getSectionView}.
+	 */
+	emscripten::val getSectionPaletteIds(int32_t chunk_x, int8_t section_y, int32_t chunk_z);
+	/**
+	 * The block state ids of all blocks of a section in YZX order. The view is overwritten by the next call.
+	 */
+	emscripten::val getSectionStates(int32_t chunk_x, int8_t section_y, int32_t chunk_z);
 
-class WorldData {
   private:
-	std::map<int32_t, DimensionData> dimensions;
-
-  public:
-	std::string name;
-	WorldData(std::string world_name);
+	std::vector<uint32_t> sectionStates;
+	std::vector<int32_t> indexedChunks;
+	std::vector<int32_t> unloadedSections;
+	std::mutex deliveredExternalChunksMutex;
+	std::vector<DecodedChunk> deliveredExternalChunks;
+	emscripten::val unloadedSectionsView(const std::vector<uint64_t>& keys);
+	[[noreturn]] void throwUnknownSection(int32_t chunk_x, int8_t section_y, int32_t chunk_z) const;
 };
 
+/**
+ * The memory of all dimensions alive and the shared registries.
+ */
+MemoryUsage minecraftMemoryUsage();
+
 } // namespace minecraft
 } // namespace kayo
\ No newline at end of file
@@ -0,0 +1,205 @@
+#include "greedyMesher.hpp"
+#include <cstdlib>
+#include <cstring>
+
+namespace kayo {
+namespace minecraft {
+
+/**
+ * The axes (0 = x, 1 = y, 2 = z) of a face and the corner of a block its quad starts at.
+ * The tangent and bitangent match the quads the host builds for a full block.
+ */
+struct FaceAxes {
+	uint8_t normal;
+	int8_t normal_sign;
+	uint8_t tangent;
+	int8_t tangent_sign;
+	uint8_t bitangent;
+	int8_t bitangent_sign;
+	float origin[3];
+};
+
+static constexpr FaceAxes face_axes[block_faces] = {
+	{1, -1, 0, 1, 2, -1, {0.0f, 0.0f, 1.0f}}, // down
+	{1, 1, 0, 1, 2, 1, {0.0f, 1.0f, 0.0f}},   // up
+	{2, -1, 0, -1, 1, -1, {1.0f, 1.0f, 0.0f}}, // north
+	{2, 1, 0, 1, 1, -1, {0.0f, 1.0f, 1.0f}},  // south
+	{0, -1, 2, 1, 1, -1, {0.0f, 1.0f, 0.0f}}, // west
+	{0, 1, 2, -1, 1, -1, {1.0f, 1.0f, 1.0f}}, // east
+};
+
+static inline uint32_t blockIndex(const uint32_t c[3]) {
+	return c[1] * 256 + c[2] * 16 + c[0];
+}
+
+static inline const BlockModel* modelOf(const std::vector<const BlockModel*>& models, uint16_t index) {
+	return index < models.size() ? models[index] : nullptr;
+}
+
+SectionMesh::~SectionMesh() {
+	this->geometry.clear();
+	this->texture_coordinates.clear();
+	this->textures.clear();
+}
+
+kayo::memUtils::KayoPointer SectionMesh::customBlocksJS() const {
+	return {reinterpret_cast<uintptr_t>(this->custom_blocks.data()), uint32_t(this->custom_blocks.size() * sizeof(uint16_t))};
+}
+
+void faceOcclusion(const uint16_t* blocks, const std::vector<const BlockModel*>& models, BlockFace face, FaceOcclusion& out) {
+	const FaceAxes& axes = face_axes[uint8_t(face)];
+	uint32_t c[3];
+	c[axes.normal] = axes.normal_sign > 0 ? 0 : 15;
+	for (uint32_t b = 0; b < 16; b++) {
+		c[axes.bitangent] = b;
+		uint16_t row = 0;
+		for (uint32_t t = 0; t < 16; t++) {
+			c[axes.tangent] = t;
+			const BlockModel* model = modelOf(models, blocks[blockIndex(c)]);
+			if (model && model->opaque)
+				row = uint16_t(row | (1u << t));
+		}
+		out[b] = row;
+	}
+}
+
+static void fillInstanceBuffer(kayo::mesh::VertexBuffer& buffer, std::vector<kayo::mesh::VertexAttribute> attributes, const void* data, uint32_t num_instances) {
+	buffer.clear();
+	buffer.attributes = std::move(attributes);
+	buffer.num_vertices = num_instances;
+	buffer.updateBytes();
+	buffer.stepMode = "instance";
+	buffer.arrayStride = buffer.bytes_per_vertex;
+	if (buffer.bytes_total == 0)
+		return;
+	buffer.data = std::malloc(buffer.bytes_total);
+	std::memcpy(buffer.data, data, buffer.bytes_total);
+}
+
+void meshSection(const SectionMeshInput& input, SectionMesh& out) {
+	const std::vector<const BlockModel*>& models = *input.models;
+	const uint16_t* blocks = input.blocks;
+
+	out.custom_blocks.clear();
+	for (uint32_t i = 0; i < blocks_per_section; i++) {
+		const BlockModel* model = modelOf(models, blocks[i]);
+		if (model && model->shape == BlockShape::custom)
+			out.custom_blocks.push_back(uint16_t(i));
+	}
+
+	std::vector<float> geometry;
+	std::vector<float> textureCoordinates;
+	std::vector<uint32_t> textures;
+	std::vector<uint16_t> faceIds(models.size());
+	std::vector<const BlockFaceTexture*> uniqueFaces;
+	uint16_t mask[16][16];
+
+	for (uint32_t f = 0; f < block_faces; f++) {
+		const FaceAxes& axes = face_axes[f];
+		const FaceOcclusion& neighbour = input.neighbours[f];
+
+		// Equal faces of different palette entries (e.g. rotated blocks) share an id so they can be merged.
+		uniqueFaces.clear();
+		for (size_t p = 0; p < models.size(); p++) {
+			faceIds[p] = 0;
+			const BlockModel* model = models[p];
+			if (!model || model->shape != BlockShape::cube)
+				continue;
+			const BlockFaceTexture* face = &model->faces[f];
+			size_t id = 0;
+			while (id < uniqueFaces.size() && !(*uniqueFaces[id] == *face))
+				id++;
+			if (id == uniqueFaces.size())
+				uniqueFaces.push_back(face);
+			faceIds[p] = uint16_t(id + 1);
+		}
+		if (uniqueFaces.empty())
+			continue;
+
+		for (uint32_t d = 0; d < 16; d++) {
+			uint32_t c[3];
+			c[axes.normal] = d;
+			int32_t behind = int32_t(d) + axes.normal_sign;
+			bool insideSection = behind >= 0 && behind < 16;
+			for (uint32_t b = 0; b < 16; b++) {
+				c[axes.bitangent] = b;
+				for (uint32_t t = 0; t < 16; t++) {
+					c[axes.tangent] = t;
+					uint16_t index = blocks[blockIndex(c)];
+					uint16_t id = index < faceIds.size() ? faceIds[index] : 0;
+					if (id != 0) {
+						bool hidden;
+						if (insideSection) {
+							uint32_t n[3] = {c[0], c[1], c[2]};
+							n[axes.normal] = uint32_t(behind);
+							const BlockModel* other = modelOf(models, blocks[blockIndex(n)]);
+							hidden = other && other->opaque;
+						} else {
+							hidden = (neighbour[b] >> t) & 1;
+						}
+						if (hidden)
+							id = 0;
+					}
+					mask[b][t] = id;
+				}
+			}
+
+			for (uint32_t b = 0; b < 16; b++) {
+				for (uint32_t t = 0; t < 16;) {
+					uint16_t id = mask[b][t];
+					if (id == 0) {
+						t++;
+						continue;
+					}
+					uint32_t width = 1;
+					while (t + width < 16 && mask[b][t + width] == id)
+						width++;
+					uint32_t height = 1;
+					for (; b + height < 16; height++) {
+						bool rowMatches = true;
+						for (uint32_t k = 0; k < width && rowMatches; k++)
+							rowMatches = mask[b + height][t + k] == id;
+						if (!rowMatches)
+							break;
+					}
+					for (uint32_t h = 0; h < height; h++)
+						std::memset(&mask[b + h][t], 0, width * sizeof(uint16_t));
+
+					// The quad starts at the block where its tangent and bitangent point into the merged area.
+					float origin[3];
+					origin[axes.normal] = float(d) + axes.origin[axes.normal];
+					origin[axes.tangent] = float(axes.tangent_sign > 0 ? t : t + width - 1) + axes.origin[axes.tangent];
+					origin[axes.bitangent] = float(axes.bitangent_sign > 0 ? b : b + height - 1) + axes.origin[axes.bitangent];
+					float tangent[3] = {0.0f, 0.0f, 0.0f};
+					float bitangent[3] = {0.0f, 0.0f, 0.0f};
+					tangent[axes.tangent] = float(axes.tangent_sign * int32_t(width));
+					bitangent[axes.bitangent] = float(axes.bitangent_sign * int32_t(height));
+					geometry.insert(geometry.end(), origin, origin + 3);
+					geometry.insert(geometry.end(), tangent, tangent + 3);
+					geometry.insert(geometry.end(), bitangent, bitangent + 3);
+
+					// The texture repeats once per merged block.
+					const BlockFaceTexture& texture = *uniqueFaces[id - 1];
+					textureCoordinates.push_back(texture.uv_origin[0]);
+					textureCoordinates.push_back(texture.uv_origin[1]);
+					textureCoordinates.push_back(texture.uv_tangent[0] * float(width));
+					textureCoordinates.push_back(texture.uv_tangent[1] * float(width));
+					textureCoordinates.push_back(texture.uv_bitangent[0] * float(height));
+					textureCoordinates.push_back(texture.uv_bitangent[1] * float(height));
+					textures.push_back(texture.texture_index);
+					textures.push_back(texture.tint);
+
+					t += width;
+				}
+			}
+		}
+	}
+
+	out.num_quads = uint32_t(textures.size() / 2);
+	fillInstanceBuffer(out.geometry, {{"float32x3", 0, 0, 3 * sizeof(float)}, {"float32x3", 3 * sizeof(float), 1, 3 * sizeof(float)}, {"float32x3", 6 * sizeof(float), 2, 3 * sizeof(float)}}, geometry.data(), out.num_quads);
+	fillInstanceBuffer(out.texture_coordinates, {{"float32x2", 0, 3, 2 * sizeof(float)}, {"float32x2", 2 * sizeof(float), 4, 2 * sizeof(float)}, {"float32x2", 4 * sizeof(float), 5, 2 * sizeof(float)}}, textureCoordinates.data(), out.num_quads);
+	fillInstanceBuffer(out.textures, {{"uint32", 0, 6, sizeof(uint32_t)}, {"uint32", sizeof(uint32_t), 7, sizeof(uint32_t)}}, textures.data(), out.num_quads);
+}
+
+} // namespace minecraft
+} // namespace kayo
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+#include "../mesh/realtimeVertexBuffers.hpp"
+#include "blockModels.hpp"
+#include "sectionStore.hpp"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace kayo {
+namespace minecraft {
+
+/**
+ * The opacity of the layer of a neighbouring section that touches a face of the meshed section.
+ * Bit t of row b is set if the block at tangent coordinate t and bitangent coordinate b of the face is opaque.
+ */
+typedef std::array<uint16_t, 16> FaceOcclusion;
+
+struct SectionMeshInput {
+	/**
+	 * The palette indices of the section in YZX order.
+	 */
+	const uint16_t* blocks = nullptr;
+	/**
+	 * The model of every palette entry of the section.
+	 */
+	const std::vector<const BlockModel*>* models = nullptr;
+	/**
+	 * The occlusion by the neighbouring section behind each face. Missing neighbours hide nothing.
+	 */
+	std::array<FaceOcclusion, block_faces> neighbours{};
+};
+
+/**
+ * The quads of a section as instance vertex buffers in the layout of the opaque Minecraft pipeline:
+ * origin, tangent and bitangent (float32x3), the uv frame (float32x2) and the texture index and tint (uint32).
+ * Positions are relative to the section origin.
+ */
+class SectionMesh {
+  public:
+	int8_t section_y = 0;
+	uint32_t num_quads = 0;
+	kayo::mesh::VertexBuffer geometry;
+	kayo::mesh::VertexBuffer texture_coordinates;
+	kayo::mesh::VertexBuffer textures;
+	/**
+	 * The YZX indices of blocks with {@link BlockShape::custom} models, which the host meshes itself.
+	 */
+	std::vector<uint16_t> custom_blocks;
+
+	SectionMesh() = default;
+	SectionMesh(const SectionMesh&) = delete;
+	SectionMesh& operator=(const SectionMesh&) = delete;
+	~SectionMesh();
+	kayo::memUtils::KayoPointer customBlocksJS() const;
+};
+
+/**
+ * Computes the occlusion a neighbouring section causes on a face of the meshed section.
+ * @param face The face of the meshed section the neighbour lies behind, e.g. {@link BlockFace::up} for the section above.
+ */
+void faceOcclusion(const uint16_t* blocks, const std::vector<const BlockModel*>& models, BlockFace face, FaceOcclusion& out);
+
+/**
+ * Culls hidden faces of all cube blocks of a section and merges adjacent equal faces into quads.
+ */
+void meshSection(const SectionMeshInput& input, SectionMesh& out);
+
+} // namespace minecraft
+} // namespace kayo
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include "meshChunkTask.hpp"
+#include "../task/workerPool.hpp"
+#include <array>
+#include <emscripten/bind.h>
+#include <emscripten/em_asm.h>
+#include <iostream>
+
+namespace kayo {
+namespace minecraft {
+
+struct SectionSource {
+	std::array<uint16_t, blocks_per_section> blocks;
+	std::vector<const BlockModel*> models;
+};
+
+/**
+ * The range of section y coordinates searched for sections of a chunk.
+ */
+constexpr int32_t min_section_y = -128;
+constexpr int32_t max_section_y = 127;
+
+/**
+ * Loads the palette indices and block models of a section.
+ * @returns false if the chunk is not built or has no such section.
+ */
+static bool loadSection(const DimensionData& dimension, const BlockModelTable& block_models, int32_t chunk_x, int8_t section_y, int32_t chunk_z, SectionSource& out) {
+	uint64_t key = SectionKey::pack(chunk_x, section_y, chunk_z);
+	// Uniform sections consist of their only palette entry.
+	if (const uint32_t* state = dimension.uniformSections.find(key)) {
+		block_models.resolveStates(dimension.blockStates, state, 1, out.models);
+		out.blocks.fill(0);
+		return true;
+	}
+	const PackedSection* section = dimension.sectionBlockIndices.find(key);
+	if (!section)
+		return false;
+	block_models.resolveStates(dimension.blockStates, section->palette.data(), section->palette.size(), out.models);
+	kayo::minecraft::unpackSection(*section, out.blocks.data());
+	return true;
+}
+
+static void meshChunk(MeshChunkTask* task) {
+	const DimensionData& dimension = *task->dimension;
+	const BlockModelTable& block_models = *task->block_models;
+
+	// Sections are looked up directly, so chunks restored from a world cache without their NBT are meshed as well.
+	std::vector<int8_t> sectionYs;
+	for (int32_t y = min_section_y; y <= max_section_y; y++) {
+		uint64_t key = SectionKey::pack(task->chunk_x, int8_t(y), task->chunk_z);
+		if (dimension.uniformSections.find(key) || dimension.sectionBlockIndices.find(key))
+			sectionYs.push_back(int8_t(y));
+	}
+	if (sectionYs.empty())
+		std::cerr << "Chunk " << task->chunk_x << ", " << task->chunk_z << " is not built." << std::endl;
+
+	SectionSource center;
+	SectionSource neighbour;
+	uint32_t quads = 0;
+	for (int8_t y : sectionYs) {
+		if (!loadSection(dimension, block_models, task->chunk_x, y, task->chunk_z, center))
+			continue;
+		bool hasGeometry = false;
+		for (const BlockModel* model : center.models)
+			hasGeometry |= model->shape != BlockShape::empty;
+		// Nothing inside a section is visible if all of its neighbours are opaque.
+		if (!hasGeometry || dimension.isSectionEnclosed(task->chunk_x, y, task->chunk_z, &block_models))
+			continue;
+
+		SectionMeshInput input;
+		input.blocks = center.blocks.data();
+		input.models = &center.models;
+		const int32_t offsets[block_faces][3] = {{0, -1, 0}, {0, 1, 0}, {0, 0, -1}, {0, 0, 1}, {-1, 0, 0}, {1, 0, 0}};
+		for (uint32_t f = 0; f < block_faces; f++) {
+			int8_t neighbourY = int8_t(y + offsets[f][1]);
+			if (loadSection(dimension, block_models, task->chunk_x + offsets[f][0], neighbourY, task->chunk_z + offsets[f][2], neighbour))
+				faceOcclusion(neighbour.blocks.data(), neighbour.models, BlockFace(f), input.neighbours[f]);
+		}
+
+		auto mesh = std::make_unique<SectionMesh>();
+		mesh->section_y = y;
+		meshSection(input, *mesh);
+		quads += mesh->num_quads;
+		task->meshes.push_back(std::move(mesh));
+	}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdollar-in-identifier-extension"
+	MAIN_THREAD_ASYNC_EM_ASM({ window.kayo.taskQueue.wasmTaskFinished($0, {meshedSections : $1, quads : $2}); }, task->task_id, uint32_t(task->meshes.size()), quads);
+#pragma GCC diagnostic pop
+}
+
+MeshChunkTask::MeshChunkTask(uint32_t task_id, DimensionData* dimension, BlockModelTable* block_models, int32_t chunk_x, int32_t chunk_z)
+	: Task(task_id), dimension(dimension), block_models(block_models), chunk_x(chunk_x), chunk_z(chunk_z) {}
+
+void MeshChunkTask::run() {
+	WorkerPool::shared().submit([this] { meshChunk(this); });
+}
+
+uint32_t MeshChunkTask::numMeshes() const {
+	return uint32_t(this->meshes.size());
+}
+
+SectionMesh* MeshChunkTask::getMesh(uint32_t index) {
+	return this->meshes[index].get();
+}
+
+} // namespace minecraft
+} // namespace kayo
+
+using namespace emscripten;
+EMSCRIPTEN_BINDINGS(KayoMeshChunkTask) {
+	class_<kayo::minecraft::SectionMesh>("MinecraftSectionMesh")
+		.property("sectionY", &kayo::minecraft::SectionMesh::section_y)
+		.property("numQuads", &kayo::minecraft::SectionMesh::num_quads)
+		.property("geometry", &kayo::minecraft::SectionMesh::geometry, return_value_policy::reference())
+		.property("textureCoordinates", &kayo::minecraft::SectionMesh::texture_coordinates, return_value_policy::reference())
+		.property("textures", &kayo::minecraft::SectionMesh::textures, return_value_policy::reference())
+		.property("customBlocks", &kayo::minecraft::SectionMesh::customBlocksJS);
+	class_<kayo::minecraft::MeshChunkTask, base<kayo::Task>>("WasmMeshChunkTask")
+		.constructor<uint32_t, kayo::minecraft::DimensionData*, kayo::minecraft::BlockModelTable*, int32_t, int32_t>()
+		.function("run", &kayo::minecraft::MeshChunkTask::run)
+		.function("numMeshes", &kayo::minecraft::MeshChunkTask::numMeshes)
+		.function("getMesh", &kayo::minecraft::MeshChunkTask::getMesh, return_value_policy::reference());
+}
\ No newline at end of file
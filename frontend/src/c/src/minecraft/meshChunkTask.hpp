@@ -0,0 +1,32 @@
+#pragma once
+#include "../task/task.hpp"
+#include "blockModels.hpp"
+#include "context.hpp"
+#include "greedyMesher.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace kayo {
+namespace minecraft {
+
+/**
+ * Meshes all sections of a chunk column on a worker thread.
+ * The neighbouring sections, also those of adjacent chunks if they are built, are used for face culling.
+ * Neither the dimension nor the block model table may be modified until the task finished.
+ */
+class MeshChunkTask : public Task {
+  public:
+	DimensionData* dimension;
+	const BlockModelTable* block_models;
+	const int32_t chunk_x;
+	const int32_t chunk_z;
+	std::vector<std::unique_ptr<SectionMesh>> meshes;
+	MeshChunkTask(uint32_t task_id, DimensionData* dimension, BlockModelTable* block_models, int32_t chunk_x, int32_t chunk_z);
+	void run() override;
+	uint32_t numMeshes() const;
+	SectionMesh* getMesh(uint32_t index);
+};
+
+} // namespace minecraft
+} // namespace kayo
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "nbt.hpp"
+#include "../utils/byteSwap.hpp"
 #include "parse.hpp"
 #include <cstdlib>
 #include <iostream>
@@ -51,7 +52,7 @@ ByteArrayTag* createByteArrayTag(const uint8_t* data, std::string name, size_t&
 	data += 4;
 	progress += 4 + size;
 	tag->value.resize(size);
-	std::copy(data, data + size, tag->value.begin());
+	kayo::byteSwap::copyBytes(data, tag->value.data(), size);
 	return tag;
 }
 
@@ -82,6 +83,7 @@ CompoundTag* createCompoundTag(const uint8_t* data, std::string name, size_t& pr
 		}
 
 	} while (next->id > 0);
+	delete next;
 
 	return tag;
 }
@@ -93,10 +95,7 @@ IntArrayTag* createIntArrayTag(const uint8_t* data, std::string name, size_t& pr
 	data += 4;
 	progress += 4 + size * 4;
 	tag->value.resize(size);
-	for (uint32_t i = 0; i < size; i++) {
-		tag->value[i] = readI32AsBigEndian(data, 4);
-		data += 4;
-	}
+	kayo::byteSwap::copyBigEndian32(data, tag->value.data(), size);
 	return tag;
 }
 
@@ -108,10 +107,7 @@ LongArrayTag* createLongArrayTag(const uint8_t* data, std::string name, size_t&
 	data += 4;
 	progress += 4 + size * 8;
 	tag->value.resize(size);
-	for (uint32_t i = 0; i < size; i++) {
-		tag->value[i] = readI64AsBigEndian(data, 8);
-		data += 8;
-	}
+	kayo::byteSwap::copyBigEndian64(data, tag->value.data(), size);
 	return tag;
 }
 
@@ -283,6 +279,11 @@ void NBT::GenericNBT<T>::display(std::ostream& os) const {
 NBTContainer::NBTContainer(const std::string& tagName)
 	: GenericNBT<std::vector<NBTBase*>>(tagName) {}
 
+NBTContainer::~NBTContainer() {
+	for (NBTBase* child : this->value)
+		delete child;
+}
+
 // EndTag class implementation
 EndTag::EndTag()
 	: NBTBase("End Tag") {
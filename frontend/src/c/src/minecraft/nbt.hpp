@@ -40,6 +40,12 @@ class GenericNBT : public NBTBase {
 class NBTContainer : public GenericNBT<std::vector<NBTBase*>> {
   public:
 	NBTContainer(const std::string& tagName);
+	NBTContainer(const NBTContainer&) = delete;
+	NBTContainer& operator=(const NBTContainer&) = delete;
+	/**
+	 * Deletes all child tags, the container owns them.
+	 */
+	~NBTContainer() override;
 
 	virtual std::string getTypeName() const = 0;
 	virtual void displayContent(std::ostream& os) const = 0;
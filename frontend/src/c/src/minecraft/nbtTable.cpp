@@ -0,0 +1,494 @@
+#include "nbtTable.hpp"
+#include <charconv>
+#include <iostream>
+
+namespace NBT {
+
+TagTable::TagTable(const uint8_t* data, size_t length, bool take_ownership) {
+	if (take_ownership)
+		owned_buffer.reset(const_cast<uint8_t*>(data));
+	parse(data, length);
+}
+
+TagTable::TagTable(const uint8_t* data, size_t length, const PathSet& paths, bool take_ownership) {
+	if (take_ownership)
+		owned_buffer.reset(const_cast<uint8_t*>(data));
+	parse(data, length, paths);
+}
+
+PathSet::PathSet(std::initializer_list<std::string> paths) {
+	nodes.emplace_back();
+	for (const std::string& path : paths)
+		add(path);
+}
+
+void PathSet::add(const std::string& path) {
+	uint32_t current = 0;
+	for (const std::string& segment : splitByDot(path)) {
+		uint32_t next = 0;
+		for (uint32_t child : nodes[current].children) {
+			if (nodes[child].segment == segment) {
+				next = child;
+				break;
+			}
+		}
+		if (!next) {
+			next = static_cast<uint32_t>(nodes.size());
+			Node& node = nodes.emplace_back();
+			node.segment = segment;
+			uint32_t index = 0;
+			auto [ptr, ec] = std::from_chars(segment.data(), segment.data() + segment.size(), index);
+			if (ec == std::errc() && ptr == segment.data() + segment.size())
+				node.list_index = index;
+			nodes[current].children.push_back(next);
+		}
+		current = next;
+	}
+	nodes[current].selected = true;
+}
+
+const PathSet::Node* PathSet::match(const Node* node, std::string_view entry) const {
+	for (uint32_t child : node->children) {
+		const Node& candidate = nodes[child];
+		if (candidate.segment == entry || candidate.segment == "*")
+			return &candidate;
+	}
+	return nullptr;
+}
+
+const PathSet::Node* PathSet::match(const Node* node, uint32_t list_index) const {
+	for (uint32_t child : node->children) {
+		const Node& candidate = nodes[child];
+		if (candidate.list_index == list_index || candidate.segment == "*")
+			return &candidate;
+	}
+	return nullptr;
+}
+
+void TagTable::require(const uint8_t* data, size_t bytes) const {
+	// A pointer past the end would make the distance negative and the check pass.
+	if (data > end || bytes > static_cast<size_t>(end - data)) {
+		std::cerr << "NBT data ends unexpectedly." << std::endl;
+		throw std::runtime_error("NBT data ends unexpectedly.");
+	}
+}
+
+void TagTable::parse(const uint8_t* data, size_t length) {
+	tags.clear();
+	end = data + length;
+	require(data, 1);
+	if (data[0] == 0 || data[0] > 12) {
+		std::cerr << "ID is no named NBT." << std::endl;
+		throw std::runtime_error("ID is no named NBT.");
+	}
+	parseNamed(data);
+}
+
+void TagTable::parse(const uint8_t* data, size_t length, const PathSet& paths) {
+	tags.clear();
+	end = data + length;
+	require(data, 3);
+	if (data[0] == 0 || data[0] > 12) {
+		std::cerr << "ID is no named NBT." << std::endl;
+		throw std::runtime_error("ID is no named NBT.");
+	}
+	uint16_t nameLength = readU16AsBigEndian(data + 1, 2);
+	require(data + 3, nameLength);
+	FlatTag& tag = tags.emplace_back();
+	tag.id = static_cast<int8_t>(data[0]);
+	tag.name = std::string_view(reinterpret_cast<const char*>(data + 3), nameLength);
+	data += 3 + nameLength;
+	parsePayload(0, data, paths, paths.root());
+}
+
+uint32_t TagTable::parseNamed(const uint8_t*& data) {
+	require(data, 3);
+	int8_t id = static_cast<int8_t>(data[0]);
+	uint16_t nameLength = readU16AsBigEndian(data + 1, 2);
+	data += 3;
+	require(data, nameLength);
+
+	uint32_t index = static_cast<uint32_t>(tags.size());
+	FlatTag& tag = tags.emplace_back();
+	tag.id = id;
+	tag.name = std::string_view(reinterpret_cast<const char*>(data), nameLength);
+	data += nameLength;
+	parsePayload(index, data);
+	return index;
+}
+
+void TagTable::parsePayload(uint32_t index, const uint8_t*& data) {
+	int8_t id = tags[index].id;
+	size_t elementSize = 0;
+	switch (id) {
+	case 1:
+		elementSize = 1;
+		break;
+	case 2:
+		elementSize = 2;
+		break;
+	case 3:
+	case 5:
+		elementSize = 4;
+		break;
+	case 4:
+	case 6:
+		elementSize = 8;
+		break;
+	case 7:
+	case 11:
+	case 12: {
+		require(data, 4);
+		uint32_t size = readU32AsBigEndian(data, 4);
+		data += 4;
+		size_t bytesPerElement = id == 7 ? 1 : (id == 11 ? 4 : 8);
+		if (size > static_cast<size_t>(end - data) / bytesPerElement) {
+			std::cerr << "NBT data ends unexpectedly." << std::endl;
+			throw std::runtime_error("NBT data ends unexpectedly.");
+		}
+		tags[index].payload = data;
+		tags[index].length = size;
+		data += size * bytesPerElement;
+		return;
+	}
+	case 8: {
+		require(data, 2);
+		uint16_t size = readU16AsBigEndian(data, 2);
+		data += 2;
+		require(data, size);
+		tags[index].payload = data;
+		tags[index].length = size;
+		data += size;
+		return;
+	}
+	case 9: {
+		require(data, 5);
+		int8_t listID = static_cast<int8_t>(data[0]);
+		uint32_t listLength = readU32AsBigEndian(data + 1, 4);
+		data += 5;
+		tags[index].payload = data;
+		tags[index].element_id = listID;
+		tags[index].length = listLength;
+		if (listLength == 0)
+			return;
+		// Every element occupies at least one byte, which bounds the reservation below.
+		if (listID <= 0 || listID > 12 || listLength > static_cast<size_t>(end - data)) {
+			std::cerr << "ID is no NBT" << std::endl;
+			throw std::runtime_error("ID is no NBT.");
+		}
+		uint32_t first = static_cast<uint32_t>(tags.size());
+		tags.resize(first + listLength);
+		tags[index].first_child = first;
+		for (uint32_t i = 0; i < listLength; i++) {
+			FlatTag& element = tags[first + i];
+			element.id = listID;
+			element.next_sibling = i + 1 < listLength ? first + i + 1 : 0;
+			parsePayload(first + i, data);
+		}
+		return;
+	}
+	case 10: {
+		tags[index].payload = data;
+		uint32_t previous = 0;
+		uint32_t count = 0;
+		while (true) {
+			require(data, 1);
+			if (data[0] == 0) {
+				data++;
+				break;
+			}
+			if (data[0] > 12) {
+				std::cerr << "ID is unknown." << std::endl;
+				throw std::runtime_error("ID is unknown.");
+			}
+			uint32_t child = parseNamed(data);
+			if (previous)
+				tags[previous].next_sibling = child;
+			else
+				tags[index].first_child = child;
+			previous = child;
+			count++;
+		}
+		tags[index].length = count;
+		return;
+	}
+	default:
+		std::cerr << "ID is no NBT" << std::endl;
+		throw std::runtime_error("ID is no NBT.");
+	}
+	require(data, elementSize);
+	tags[index].payload = data;
+	data += elementSize;
+}
+
+void TagTable::parsePayload(uint32_t index, const uint8_t*& data, const PathSet& paths, const PathSet::Node* node) {
+	int8_t id = tags[index].id;
+	if (node->selected || (id != 9 && id != 10)) {
+		parsePayload(index, data);
+		return;
+	}
+
+	if (id == 9) {
+		require(data, 5);
+		int8_t listID = static_cast<int8_t>(data[0]);
+		uint32_t listLength = readU32AsBigEndian(data + 1, 4);
+		data += 5;
+		tags[index].payload = data;
+		tags[index].element_id = listID;
+		tags[index].length = listLength;
+		if (listLength == 0)
+			return;
+		if (listID <= 0 || listID > 12 || listLength > static_cast<size_t>(end - data)) {
+			std::cerr << "ID is no NBT" << std::endl;
+			throw std::runtime_error("ID is no NBT.");
+		}
+		uint32_t first = static_cast<uint32_t>(tags.size());
+		tags.resize(first + listLength);
+		tags[index].first_child = first;
+		for (uint32_t i = 0; i < listLength; i++) {
+			FlatTag& element = tags[first + i];
+			element.id = listID;
+			element.next_sibling = i + 1 < listLength ? first + i + 1 : 0;
+			const PathSet::Node* child = paths.match(node, i);
+			if (child) {
+				parsePayload(first + i, data, paths, child);
+			} else {
+				element.payload = data;
+				data = skipPayload(listID, data);
+			}
+		}
+		return;
+	}
+
+	tags[index].payload = data;
+	uint32_t previous = 0;
+	uint32_t count = 0;
+	while (true) {
+		require(data, 1);
+		int8_t childID = static_cast<int8_t>(data[0]);
+		if (childID == 0) {
+			data++;
+			break;
+		}
+		if (childID < 0 || childID > 12) {
+			std::cerr << "ID is unknown." << std::endl;
+			throw std::runtime_error("ID is unknown.");
+		}
+		require(data, 3);
+		uint16_t nameLength = readU16AsBigEndian(data + 1, 2);
+		require(data + 3, nameLength);
+		std::string_view name(reinterpret_cast<const char*>(data + 3), nameLength);
+		data += 3 + nameLength;
+
+		const PathSet::Node* childNode = paths.match(node, name);
+		if (!childNode) {
+			data = skipPayload(childID, data);
+			continue;
+		}
+
+		uint32_t child = static_cast<uint32_t>(tags.size());
+		FlatTag& tag = tags.emplace_back();
+		tag.id = childID;
+		tag.name = name;
+		parsePayload(child, data, paths, childNode);
+		if (previous)
+			tags[previous].next_sibling = child;
+		else
+			tags[index].first_child = child;
+		previous = child;
+		count++;
+	}
+	tags[index].length = count;
+}
+
+const uint8_t* TagTable::skipPayload(int8_t id, const uint8_t* data) const {
+	switch (id) {
+	case 1:
+		require(data, 1);
+		return data + 1;
+	case 2:
+		require(data, 2);
+		return data + 2;
+	case 3:
+	case 5:
+		require(data, 4);
+		return data + 4;
+	case 4:
+	case 6:
+		require(data, 8);
+		return data + 8;
+	case 7:
+	case 11:
+	case 12: {
+		require(data, 4);
+		size_t size = readU32AsBigEndian(data, 4);
+		size_t bytesPerElement = id == 7 ? 1 : (id == 11 ? 4 : 8);
+		data += 4;
+		if (size > static_cast<size_t>(end - data) / bytesPerElement) {
+			std::cerr << "NBT data ends unexpectedly." << std::endl;
+			throw std::runtime_error("NBT data ends unexpectedly.");
+		}
+		return data + size * bytesPerElement;
+	}
+	case 8: {
+		require(data, 2);
+		uint16_t size = readU16AsBigEndian(data, 2);
+		require(data + 2, size);
+		return data + 2 + size;
+	}
+	case 9: {
+		require(data, 5);
+		int8_t listID = static_cast<int8_t>(data[0]);
+		size_t listLength = readU32AsBigEndian(data + 1, 4);
+		data += 5;
+		size_t fixedSize = 0;
+		switch (listID) {
+		case 1: fixedSize = 1; break;
+		case 2: fixedSize = 2; break;
+		case 3:
+		case 5: fixedSize = 4; break;
+		case 4:
+		case 6: fixedSize = 8; break;
+		}
+		if (fixedSize) {
+			if (listLength > static_cast<size_t>(end - data) / fixedSize) {
+				std::cerr << "NBT data ends unexpectedly." << std::endl;
+				throw std::runtime_error("NBT data ends unexpectedly.");
+			}
+			return data + listLength * fixedSize;
+		}
+		for (size_t i = 0; i < listLength; i++)
+			data = skipPayload(listID, data);
+		return data;
+	}
+	case 10:
+		while (true) {
+			require(data, 1);
+			int8_t childID = static_cast<int8_t>(data[0]);
+			if (childID == 0)
+				return data + 1;
+			require(data, 3);
+			uint16_t nameLength = readU16AsBigEndian(data + 1, 2);
+			require(data + 3, nameLength);
+			data = skipPayload(childID, data + 3 + nameLength);
+		}
+	default:
+		std::cerr << "ID is no NBT" << std::endl;
+		throw std::runtime_error("ID is no NBT.");
+	}
+}
+
+const FlatTag* TagTable::firstChild(const FlatTag* container) const {
+	return container->first_child ? &tags[container->first_child] : nullptr;
+}
+
+const FlatTag* TagTable::nextSibling(const FlatTag* tag) const {
+	return tag->next_sibling ? &tags[tag->next_sibling] : nullptr;
+}
+
+const FlatTag* TagTable::getTag(const FlatTag* container, std::string_view entry) const {
+	if (container->id == 10) {
+		for (const FlatTag* child = firstChild(container); child; child = nextSibling(child)) {
+			if (child->name == entry)
+				return child;
+		}
+		return nullptr;
+	}
+	if (container->id == 9) {
+		uint32_t i = 0;
+		auto [ptr, ec] = std::from_chars(entry.data(), entry.data() + entry.size(), i);
+		if (ec != std::errc() || ptr != entry.data() + entry.size() || i >= container->length)
+			return nullptr;
+		return &tags[container->first_child + i];
+	}
+	return nullptr;
+}
+
+size_t TagTable::byteSize() const {
+	size_t bytes = tags.capacity() * sizeof(FlatTag);
+	if (owned_buffer)
+		bytes += size_t(end - owned_buffer.get());
+	return bytes;
+}
+
+void TagTable::display(const FlatTag* tag, std::ostream& os) const {
+	os << "\"" << tag->name << "\": ";
+	displayContent(tag, os);
+}
+
+template <typename T>
+static void displayArray(const FlatTag* tag, std::ostream& os, uint32_t elementSize) {
+	os << "[";
+	for (uint32_t i = 0; i < tag->length; i++) {
+		if (i > 0)
+			os << ", ";
+		if constexpr (std::is_same_v<T, int8_t>)
+			os << static_cast<int>(static_cast<int8_t>(tag->payload[i]));
+		else if constexpr (std::is_same_v<T, int32_t>)
+			os << readI32AsBigEndian(tag->payload + i * elementSize, 4);
+		else
+			os << readI64AsBigEndian(tag->payload + i * elementSize, 8);
+	}
+	os << "]";
+}
+
+void TagTable::displayContent(const FlatTag* tag, std::ostream& os) const {
+	switch (tag->id) {
+	case 1:
+		os << static_cast<int>(tag->get<int8_t>());
+		break;
+	case 2:
+		os << tag->get<int16_t>();
+		break;
+	case 3:
+		os << tag->get<int32_t>();
+		break;
+	case 4:
+		os << tag->get<int64_t>();
+		break;
+	case 5:
+		os << tag->get<float>();
+		break;
+	case 6:
+		os << tag->get<double>();
+		break;
+	case 7:
+		displayArray<int8_t>(tag, os, 1);
+		break;
+	case 8:
+		os << "\"" << tag->get<std::string_view>() << "\"";
+		break;
+	case 9: {
+		os << "[";
+		for (const FlatTag* child = firstChild(tag); child; child = nextSibling(child)) {
+			displayContent(child, os);
+			if (child->next_sibling)
+				os << ",";
+		}
+		os << "]";
+		break;
+	}
+	case 10: {
+		if (tag->length == 0) {
+			os << "{}";
+			break;
+		}
+		os << "\n{\n";
+		for (const FlatTag* child = firstChild(tag); child; child = nextSibling(child)) {
+			display(child, os);
+			if (child->next_sibling)
+				os << ",\n";
+		}
+		os << "\n}";
+		break;
+	}
+	case 11:
+		displayArray<int32_t>(tag, os, 4);
+		break;
+	case 12:
+		displayArray<int64_t>(tag, os, 8);
+		break;
+	}
+}
+
+} // namespace NBT
\ No newline at end of file
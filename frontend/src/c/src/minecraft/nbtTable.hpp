@@ -0,0 +1,215 @@
+#pragma once
+#include "../utils/byteSwap.hpp"
+#include "parse.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace NBT {
+
+/**
+ * A single entry of a {@link TagTable}.
+ * Names and payloads point into the buffer the table was parsed from and are decoded on access.
+ */
+struct FlatTag {
+	/**
+	 * The name of the tag. Empty for list elements.
+	 */
+	std::string_view name;
+	/**
+	 * The first payload byte, directly after the name (and after the length prefix for arrays, strings and lists).
+	 */
+	const uint8_t* payload = nullptr;
+	/**
+	 * The number of elements for arrays and lists, the number of bytes for strings
+	 * and the number of children for compounds.
+	 */
+	uint32_t length = 0;
+	/**
+	 * The table index of the first child of a list or compound. 0 if there is none.
+	 * The elements of a list are stored consecutively.
+	 */
+	uint32_t first_child = 0;
+	/**
+	 * The table index of the next tag in the same container. 0 if there is none.
+	 */
+	uint32_t next_sibling = 0;
+	int8_t id = 0;
+	/**
+	 * The tag id of the elements of a list.
+	 */
+	int8_t element_id = 0;
+
+	bool isContainer() const { return id == 9 || id == 10; }
+
+	/**
+	 * Decodes the payload of a scalar tag. T has to match the tag id.
+	 */
+	template <typename T>
+	T get() const;
+
+	/**
+	 * Decodes the payload of a byte, int or long array tag into out, which has to hold {@link length} elements.
+	 */
+	template <typename T>
+	void copyArray(T* out) const;
+};
+
+/**
+ * A compiled set of dotted tag paths in the syntax of {@link getTag}, e.g. "sections.*.block_states.palette".
+ * The segment "*" matches every entry of a compound or list. A path selects the whole subtree of the tag it ends at.
+ */
+class PathSet {
+  public:
+	struct Node {
+		std::string segment;
+		/**
+		 * The list index this segment addresses or -1 if the segment is not numeric.
+		 */
+		int64_t list_index = -1;
+		/**
+		 * Set if a path ends at this node, which selects the whole subtree.
+		 */
+		bool selected = false;
+		std::vector<uint32_t> children;
+	};
+	/**
+	 * The trie of all paths. nodes[0] is the root tag.
+	 */
+	std::vector<Node> nodes;
+
+	PathSet(std::initializer_list<std::string> paths);
+	void add(const std::string& path);
+	const Node* root() const { return &nodes[0]; }
+	const Node* match(const Node* node, std::string_view entry) const;
+	const Node* match(const Node* node, uint32_t list_index) const;
+};
+
+/**
+ * A flat, allocation free representation of a NBT tree.
+ * All tags live in one contiguous vector; nothing is copied out of the source buffer.
+ * The source buffer has to outlive the table unless the table owns it.
+ */
+class TagTable {
+  private:
+	struct BufferDeleter {
+		void operator()(uint8_t* p) const { std::free(p); }
+	};
+	std::unique_ptr<uint8_t, BufferDeleter> owned_buffer;
+	const uint8_t* end = nullptr;
+	uint32_t parseNamed(const uint8_t*& data);
+	void parsePayload(uint32_t index, const uint8_t*& data);
+	void parsePayload(uint32_t index, const uint8_t*& data, const PathSet& paths, const PathSet::Node* node);
+	const uint8_t* skipPayload(int8_t id, const uint8_t* data) const;
+	void require(const uint8_t* data, size_t bytes) const;
+
+  public:
+	std::vector<FlatTag> tags;
+
+	TagTable() = default;
+	/**
+	 * Parses the named root tag at data.
+	 * @param take_ownership If set the table frees data (allocated with malloc) on destruction.
+	 */
+	TagTable(const uint8_t* data, size_t length, bool take_ownership = false);
+	TagTable(const uint8_t* data, size_t length, const PathSet& paths, bool take_ownership = false);
+	TagTable(const TagTable&) = delete;
+	TagTable& operator=(const TagTable&) = delete;
+
+	/**
+	 * Clears the table and parses the named root tag at data.
+	 * The capacity of the table is kept, so a table can be reused as arena for many chunks.
+	 */
+	void parse(const uint8_t* data, size_t length);
+	/**
+	 * Like {@link parse} but only records the tags on the given paths and their ancestors.
+	 * All other subtrees are skipped in the byte stream without creating table entries.
+	 * Unrequested list elements keep their slot but stay empty.
+	 */
+	void parse(const uint8_t* data, size_t length, const PathSet& paths);
+
+	const FlatTag* root() const { return tags.empty() ? nullptr : &tags[0]; }
+	const FlatTag* firstChild(const FlatTag* container) const;
+	const FlatTag* nextSibling(const FlatTag* tag) const;
+	/**
+	 * Returns the child named entry of a compound or the element with the index entry of a list.
+	 */
+	const FlatTag* getTag(const FlatTag* container, std::string_view entry) const;
+
+	void display(const FlatTag* tag, std::ostream& os) const;
+	void displayContent(const FlatTag* tag, std::ostream& os) const;
+	/**
+	 * The heap memory held by the table, including an owned source buffer.
+	 */
+	size_t byteSize() const;
+};
+
+template <typename T>
+T FlatTag::get() const {
+	if constexpr (std::is_same_v<T, int8_t>) {
+		return static_cast<int8_t>(payload[0]);
+	} else if constexpr (std::is_same_v<T, int16_t>) {
+		return readI16AsBigEndian(payload, 2);
+	} else if constexpr (std::is_same_v<T, int32_t>) {
+		return readI32AsBigEndian(payload, 4);
+	} else if constexpr (std::is_same_v<T, int64_t>) {
+		return readI64AsBigEndian(payload, 8);
+	} else if constexpr (std::is_same_v<T, float>) {
+		uint32_t bits = readU32AsBigEndian(payload, 4);
+		float f;
+		std::memcpy(&f, &bits, sizeof(f));
+		return f;
+	} else if constexpr (std::is_same_v<T, double>) {
+		uint64_t bits = static_cast<uint64_t>(readI64AsBigEndian(payload, 8));
+		double d;
+		std::memcpy(&d, &bits, sizeof(d));
+		return d;
+	} else if constexpr (std::is_same_v<T, std::string_view>) {
+		return std::string_view(reinterpret_cast<const char*>(payload), length);
+	} else {
+		static_assert(sizeof(T) == 0, "Unsupported NBT value type.");
+	}
+}
+
+template <typename T>
+void FlatTag::copyArray(T* out) const {
+	if constexpr (std::is_same_v<T, int8_t>) {
+		kayo::byteSwap::copyBytes(payload, out, length);
+	} else if constexpr (std::is_same_v<T, int32_t>) {
+		kayo::byteSwap::copyBigEndian32(payload, out, length);
+	} else if constexpr (std::is_same_v<T, int64_t>) {
+		kayo::byteSwap::copyBigEndian64(payload, out, length);
+	} else {
+		static_assert(sizeof(T) == 0, "Unsupported NBT array type.");
+	}
+}
+
+inline const FlatTag* getTag(const TagTable& table, const FlatTag* active, const std::string& name) {
+	if (!active)
+		throw std::runtime_error("Active is NULL.");
+	auto selector = splitByDot(name);
+	for (const std::string& entry : selector) {
+		active = table.getTag(active, entry);
+		if (!active)
+			return nullptr;
+	}
+	return active;
+}
+
+template <typename T>
+T getGeneric(const TagTable& table, const FlatTag* active, const std::string& name) {
+	const FlatTag* tag = getTag(table, active, name);
+	if (!tag)
+		throw std::runtime_error("Tag \"" + name + "\" does not exist.");
+	return tag->get<T>();
+}
+
+} // namespace NBT
\ No newline at end of file
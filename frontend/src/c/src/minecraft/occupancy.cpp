@@ -0,0 +1,121 @@
+#include "occupancy.hpp"
+#include <algorithm>
+#include <bit>
+#include <emscripten/bind.h>
+
+namespace kayo {
+namespace minecraft {
+
+void ChunkHeights::include(const ChunkHeights& other) {
+	this->min_surface = std::min(this->min_surface, other.min_surface);
+	this->max_surface = std::max(this->max_surface, other.max_surface);
+}
+
+void buildSectionOccupancy(const PackedSection& section, const std::vector<uint8_t>& air, SectionOccupancy& out) {
+	// Palettes without air or made of air only decide the occupancy without expanding the section.
+	size_t airEntries = size_t(std::count(air.begin(), air.end(), uint8_t(1)));
+	if (airEntries == 0 || airEntries == air.size()) {
+		out.bits.fill(airEntries == 0 ? ~uint64_t(0) : 0);
+		out.count = airEntries == 0 ? uint16_t(blocks_per_section) : 0;
+		return;
+	}
+
+	uint16_t indices[blocks_per_section];
+	unpackSection(section, indices);
+	// Covers every value an index of this width can take, indices beyond the palette count as air.
+	std::vector<uint64_t> occupied(size_t(1) << section.bits_per_index, 0);
+	for (size_t i = 0; i < air.size() && i < occupied.size(); i++)
+		occupied[i] = !air[i];
+	uint32_t count = 0;
+	for (uint32_t word = 0; word < out.bits.size(); word++) {
+		uint64_t bits = 0;
+		const uint16_t* wordIndices = indices + word * 64;
+		for (uint32_t i = 0; i < 64; i++)
+			bits |= occupied[wordIndices[i]] << i;
+		out.bits[word] = bits;
+		count += uint32_t(std::popcount(bits));
+	}
+	out.count = uint16_t(count);
+}
+
+void includeSectionSurfaces(const SectionOccupancy& occupancy, int8_t section_y, ColumnSurfaces& surfaces) {
+	if (occupancy.count == 0)
+		return;
+	for (uint32_t column = 0; column < 256; column++) {
+		for (int32_t y = 15; y >= 0; y--) {
+			if (occupancy.occupied(uint32_t(y) * 256 + column)) {
+				surfaces[column] = std::max(surfaces[column], int16_t(section_y * 16 + y));
+				break;
+			}
+		}
+	}
+}
+
+void includeSolidSectionSurfaces(int8_t section_y, ColumnSurfaces& surfaces) {
+	for (int16_t& surface : surfaces)
+		surface = std::max(surface, int16_t(section_y * 16 + 15));
+}
+
+ChunkHeights summarizeSurfaces(const ColumnSurfaces& surfaces) {
+	ChunkHeights heights;
+	for (int16_t surface : surfaces) {
+		heights.min_surface = std::min(heights.min_surface, surface);
+		heights.max_surface = std::max(heights.max_surface, surface);
+	}
+	return heights;
+}
+
+uint32_t RegionHeightPyramid::cellIndex(uint32_t level, uint32_t x, uint32_t z) {
+	uint32_t offset = 0;
+	for (uint32_t l = 0; l < level; l++)
+		offset += (32u >> l) * (32u >> l);
+	return offset + z * (32u >> level) + x;
+}
+
+void RegionHeightPyramid::set(uint32_t chunk_x, uint32_t chunk_z, const ChunkHeights& chunk) {
+	this->heights[cellIndex(0, chunk_x, chunk_z)] = chunk;
+	for (uint32_t level = 1; level < levels; level++) {
+		uint32_t x = chunk_x >> level;
+		uint32_t z = chunk_z >> level;
+		ChunkHeights combined;
+		for (uint32_t i = 0; i < 4; i++)
+			combined.include(this->heights[cellIndex(level - 1, x * 2 + (i & 1), z * 2 + (i >> 1))]);
+		this->heights[cellIndex(level, x, z)] = combined;
+	}
+}
+
+const ChunkHeights& RegionHeightPyramid::get(uint32_t level, uint32_t chunk_x, uint32_t chunk_z) const {
+	return this->heights[cellIndex(level, chunk_x >> level, chunk_z >> level)];
+}
+
+void HeightPyramid::set(int32_t chunk_x, int32_t chunk_z, const ChunkHeights& chunk) {
+	uint64_t region = ColumnKey::pack(chunk_x >> 5, chunk_z >> 5);
+	RegionHeightPyramid* pyramid = this->regions.find(region);
+	if (!pyramid) {
+		if (!chunk.known())
+			return;
+		pyramid = &this->regions.insertOrAssign(region, RegionHeightPyramid());
+	}
+	pyramid->set(uint32_t(chunk_x & 31), uint32_t(chunk_z & 31), chunk);
+}
+
+ChunkHeights HeightPyramid::get(uint32_t level, int32_t chunk_x, int32_t chunk_z) const {
+	const RegionHeightPyramid* pyramid = this->regions.find(ColumnKey::pack(chunk_x >> 5, chunk_z >> 5));
+	if (!pyramid || level >= RegionHeightPyramid::levels)
+		return ChunkHeights();
+	return pyramid->get(level, uint32_t(chunk_x & 31), uint32_t(chunk_z & 31));
+}
+
+void HeightPyramid::eraseRegion(int32_t region_x, int32_t region_z) {
+	this->regions.erase(ColumnKey::pack(region_x, region_z));
+}
+
+} // namespace minecraft
+} // namespace kayo
+
+using namespace emscripten;
+EMSCRIPTEN_BINDINGS(KayoWasmMinecraftOccupancy) {
+	value_object<kayo::minecraft::ChunkHeights>("MinecraftChunkHeights")
+		.field("minSurface", &kayo::minecraft::ChunkHeights::min_surface)
+		.field("maxSurface", &kayo::minecraft::ChunkHeights::max_surface);
+}
\ No newline at end of file
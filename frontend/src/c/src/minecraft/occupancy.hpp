@@ -0,0 +1,87 @@
+#pragma once
+#include "sectionStore.hpp"
+#include "spatialHash.hpp"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace kayo {
+namespace minecraft {
+
+/**
+ * Which blocks of a non uniform section are not air, one bit per block in YZX order.
+ */
+struct SectionOccupancy {
+	std::array<uint64_t, blocks_per_section / 64> bits{};
+	uint16_t count = 0;
+
+	bool occupied(uint32_t index) const { return (bits[index >> 6] >> (index & 63)) & 1; }
+};
+
+/**
+ * The highest and lowest surface, i.e. the topmost non air block, of the block columns of a chunk.
+ * Columns without any block count as lowest possible surface.
+ */
+struct ChunkHeights {
+	int16_t min_surface = INT16_MAX;
+	int16_t max_surface = INT16_MIN;
+
+	bool known() const { return min_surface <= max_surface; }
+	void include(const ChunkHeights& other);
+};
+
+/**
+ * The topmost non air block of every column of a chunk (ZX order), or INT16_MIN.
+ */
+typedef std::array<int16_t, 16 * 16> ColumnSurfaces;
+
+/**
+ * Computes the occupancy of a non uniform section.
+ * @param air Whether a palette entry is air, indexed like the palette of the section.
+ */
+void buildSectionOccupancy(const PackedSection& section, const std::vector<uint8_t>& air, SectionOccupancy& out);
+void includeSectionSurfaces(const SectionOccupancy& occupancy, int8_t section_y, ColumnSurfaces& surfaces);
+void includeSolidSectionSurfaces(int8_t section_y, ColumnSurfaces& surfaces);
+ChunkHeights summarizeSurfaces(const ColumnSurfaces& surfaces);
+
+/**
+ * The {@link ChunkHeights} of a region at six levels of detail: level 0 holds single chunks,
+ * every further level combines 2x2 cells of the level below, up to the whole region at level 5.
+ */
+class RegionHeightPyramid {
+  public:
+	static constexpr uint32_t levels = 6;
+
+  private:
+	static constexpr uint32_t cells = 32 * 32 + 16 * 16 + 8 * 8 + 4 * 4 + 2 * 2 + 1;
+	std::array<ChunkHeights, cells> heights;
+
+	static uint32_t cellIndex(uint32_t level, uint32_t x, uint32_t z);
+
+  public:
+	/**
+	 * Sets the heights of a chunk (local coordinates within the region) and updates all coarser levels.
+	 */
+	void set(uint32_t chunk_x, uint32_t chunk_z, const ChunkHeights& chunk);
+	const ChunkHeights& get(uint32_t level, uint32_t chunk_x, uint32_t chunk_z) const;
+};
+
+/**
+ * The {@link RegionHeightPyramid}s of all regions of a dimension.
+ */
+class HeightPyramid {
+  private:
+	SpatialHashMap<ColumnKey, RegionHeightPyramid> regions;
+
+  public:
+	void set(int32_t chunk_x, int32_t chunk_z, const ChunkHeights& chunk);
+	/**
+	 * The heights of the cell of a level containing a chunk. Unknown areas report heights that are not {@link ChunkHeights::known}.
+	 */
+	ChunkHeights get(uint32_t level, int32_t chunk_x, int32_t chunk_z) const;
+	void eraseRegion(int32_t region_x, int32_t region_z);
+	size_t byteSize() const { return this->regions.byteSize(); }
+};
+
+} // namespace minecraft
+} // namespace kayo
\ No newline at end of file
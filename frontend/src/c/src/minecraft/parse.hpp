@@ -1,5 +1,6 @@
 #pragma once
 #include <cstdint>
+#include <string>
 #include <vector>
 #define CHAR_TO_U32(c) (static_cast<uint32_t>(static_cast<unsigned char>(c)))
 #define CHAR_TO_U64(c) (static_cast<uint64_t>(static_cast<unsigned char>(c)))
@@ -0,0 +1,59 @@
+#include "sectionStore.hpp"
+#include "bitUnpack.hpp"
+
+namespace kayo {
+namespace minecraft {
+
+void unpackSection(const PackedSection& section, uint16_t* out) {
+	unpackIndices(section.data.data(), section.bits_per_index, PackedLayout::Padded, out, blocks_per_section);
+}
+
+ExpandedSectionCache::ExpandedSectionCache(uint32_t capacity) : entries(capacity) {}
+
+const uint16_t* ExpandedSectionCache::get(uint64_t key, const PackedSection& section) {
+	tick++;
+	if (uint32_t* slot = index.find(key)) {
+		entries[*slot].last_used = tick;
+		return entries[*slot].indices.data();
+	}
+
+	uint32_t victim = 0;
+	for (uint32_t i = 0; i < entries.size(); i++) {
+		if (!entries[i].used) {
+			victim = i;
+			break;
+		}
+		if (entries[i].last_used < entries[victim].last_used)
+			victim = i;
+	}
+
+	Entry& entry = entries[victim];
+	if (entry.used)
+		index.erase(entry.key);
+	unpackSection(section, entry.indices.data());
+	entry.key = key;
+	entry.last_used = tick;
+	entry.used = true;
+	index.insertOrAssign(key, victim);
+	return entry.indices.data();
+}
+
+void ExpandedSectionCache::invalidate(uint64_t key) {
+	if (uint32_t* slot = index.find(key)) {
+		entries[*slot].used = false;
+		index.erase(key);
+	}
+}
+
+void ExpandedSectionCache::clear() {
+	for (Entry& entry : entries)
+		entry.used = false;
+	index.clear();
+}
+
+size_t ExpandedSectionCache::byteSize() const {
+	return entries.size() * sizeof(Entry);
+}
+
+} // namespace minecraft
+} // namespace kayo
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+#include "spatialHash.hpp"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace kayo {
+namespace minecraft {
+
+constexpr uint32_t blocks_per_section = 16 * 16 * 16;
+
+/**
+ * The block states of a section in their native bit packed form (one palette index per bitsPerIndex bits).
+ * Sections with a single palette entry are uniform and are not stored at all.
+ */
+struct PackedSection {
+	uint8_t bits_per_index = 0;
+	uint16_t palette_size = 0;
+	std::vector<uint64_t> data;
+	/**
+	 * The {@link BlockStateRegistry} id of every palette entry.
+	 */
+	std::vector<uint32_t> palette;
+};
+
+/**
+ * Expands the palette indices of a section into out, which has to hold {@link blocks_per_section} elements (YZX order).
+ */
+void unpackSection(const PackedSection& section, uint16_t* out);
+
+/**
+ * A least recently used cache of expanded sections.
+ * A returned pointer stays valid until capacity other sections have been requested.
+ */
+class ExpandedSectionCache {
+  private:
+	struct Entry {
+		uint64_t key;
+		uint64_t last_used;
+		bool used;
+		std::array<uint16_t, blocks_per_section> indices;
+	};
+	std::vector<Entry> entries;
+	SpatialHashMap<SectionKey, uint32_t> index;
+	uint64_t tick = 0;
+
+  public:
+	ExpandedSectionCache(uint32_t capacity);
+	/**
+	 * Returns the expanded indices of the section at key, unpacking it into the least recently used slot on a miss.
+	 */
+	const uint16_t* get(uint64_t key, const PackedSection& section);
+	void invalidate(uint64_t key);
+	void clear();
+	size_t byteSize() const;
+};
+
+} // namespace minecraft
+} // namespace kayo
\ No newline at end of file
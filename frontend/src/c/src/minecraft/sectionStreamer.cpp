@@ -0,0 +1,352 @@
+#include "sectionStreamer.hpp"
+#include "../task/workerPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <emscripten/bind.h>
+#include <emscripten/em_asm.h>
+#include <iostream>
+
+namespace kayo {
+namespace minecraft {
+
+/**
+ * Resident chunks are only evicted this many chunks beyond the view distance, so moving along the border does not thrash.
+ */
+constexpr float eviction_margin = 2.0f;
+/**
+ * Chunks outside the frustum are prioritized as if they were this many times farther away.
+ */
+constexpr float invisible_distance_factor = 2.0f;
+/**
+ * The assumed size of a chunk before any chunk is resident.
+ */
+constexpr size_t default_chunk_bytes = 128 * 1024;
+
+static size_t chunkBytes(const DecodedChunk& chunk) {
+	size_t bytes = chunk.nbt ? chunk.nbt->byteSize() : 0;
+	for (const auto& [key, section] : chunk.sections)
+		bytes += sizeof(PackedSection) + section.data.size() * sizeof(uint64_t) + section.palette.size() * sizeof(uint32_t);
+	bytes += chunk.occupancy.size() * sizeof(SectionOccupancy) + chunk.biomes.size() * sizeof(SectionBiomes);
+	bytes += (chunk.block_light.size() + chunk.sky_light.size()) * sizeof(NibbleArray);
+	return bytes + chunk.uniform_sections.size() * sizeof(std::pair<uint64_t, uint32_t>);
+}
+
+static void appendSectionCoordinates(const std::vector<uint64_t>& keys, std::vector<int32_t>& out) {
+	out.reserve(keys.size() * 3);
+	for (uint64_t key : keys) {
+		out.push_back(SectionKey::x(key));
+		out.push_back(SectionKey::y(key));
+		out.push_back(SectionKey::z(key));
+	}
+}
+
+SectionStreamer::SectionStreamer(DimensionData* dimension, uint32_t view_distance, uint32_t memory_budget)
+	: dimension(dimension), view_distance(view_distance), memory_budget(memory_budget) {}
+
+void SectionStreamer::setCamera(float x, float y, float z) {
+	this->camera = {x, y, z};
+}
+
+void SectionStreamer::setViewProjection(uintptr_t matrix) {
+	const float* m = reinterpret_cast<const float*>(matrix);
+	// Gribb/Hartmann: the planes are the sums and differences of the last and the other rows.
+	for (uint32_t i = 0; i < 3; i++) {
+		for (uint32_t c = 0; c < 4; c++) {
+			this->planes[i * 2][c] = m[c * 4 + 3] + m[c * 4 + i];
+			this->planes[i * 2 + 1][c] = m[c * 4 + 3] - m[c * 4 + i];
+		}
+	}
+	this->has_frustum = true;
+}
+
+void SectionStreamer::setView(const Projection* projection, uintptr_t view_matrix) {
+	const float* p = reinterpret_cast<const float*>(&projection->getMatrix());
+	const float* v = reinterpret_cast<const float*>(view_matrix);
+	float viewProjection[16];
+	for (uint32_t c = 0; c < 4; c++) {
+		for (uint32_t r = 0; r < 4; r++) {
+			float sum = 0.0f;
+			for (uint32_t k = 0; k < 4; k++)
+				sum += p[k * 4 + r] * v[c * 4 + k];
+			viewProjection[c * 4 + r] = sum;
+		}
+	}
+	this->setViewProjection(reinterpret_cast<uintptr_t>(viewProjection));
+}
+
+bool SectionStreamer::columnVisible(int32_t chunk_x, int32_t chunk_z) const {
+	if (!this->has_frustum)
+		return true;
+	float min[3] = {float(chunk_x * 16), float(this->min_y), float(chunk_z * 16)};
+	float max[3] = {min[0] + 16.0f, float(this->max_y), min[2] + 16.0f};
+	for (const std::array<float, 4>& plane : this->planes) {
+		float x = plane[0] >= 0.0f ? max[0] : min[0];
+		float y = plane[1] >= 0.0f ? max[1] : min[1];
+		float z = plane[2] >= 0.0f ? max[2] : min[2];
+		if (plane[0] * x + plane[1] * y + plane[2] * z + plane[3] < 0.0f)
+			return false;
+	}
+	return true;
+}
+
+void SectionStreamer::evict(uint64_t column, std::vector<uint64_t>& removed) {
+	const ResidentChunk* chunk = this->resident.find(column);
+	if (!chunk)
+		return;
+	this->resident_bytes -= chunk->bytes;
+	this->resident.erase(column);
+	this->dimension->removeChunk(ColumnKey::x(column), ColumnKey::z(column), &removed);
+}
+
+uint32_t SectionStreamer::update() {
+	float cameraChunkX = this->camera[0] / 16.0f;
+	float cameraChunkZ = this->camera[2] / 16.0f;
+	auto priority = [&](int32_t chunk_x, int32_t chunk_z, float& distance2) {
+		float dx = float(chunk_x) + 0.5f - cameraChunkX;
+		float dz = float(chunk_z) + 0.5f - cameraChunkZ;
+		distance2 = dx * dx + dz * dz;
+		float factor = this->columnVisible(chunk_x, chunk_z) ? 1.0f : invisible_distance_factor * invisible_distance_factor;
+		return distance2 * factor;
+	};
+	float viewDistance = float(this->view_distance);
+	float keepDistance = viewDistance + eviction_margin;
+
+	std::vector<uint64_t> added;
+	std::vector<uint64_t> removed;
+	std::vector<std::pair<int, DecodedChunk>> arrived;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		arrived.swap(this->delivered);
+		for (const auto& [status, chunk] : arrived)
+			this->in_flight.erase(ColumnKey::pack(chunk.chunk_x, chunk.chunk_z));
+	}
+	auto requested = [this](int32_t chunk_x, int32_t chunk_z) { return this->external_pending.find(ColumnKey::pack(chunk_x, chunk_z)) != nullptr; };
+	for (DecodedChunk& chunk : this->dimension->takeExternalChunks(requested)) {
+		this->external_pending.erase(ColumnKey::pack(chunk.chunk_x, chunk.chunk_z));
+		arrived.emplace_back(0, std::move(chunk));
+	}
+	this->external_chunks.clear();
+	for (auto& [status, chunk] : arrived) {
+		uint64_t column = ColumnKey::pack(chunk.chunk_x, chunk.chunk_z);
+		if (status == -4) {
+			this->dimension->markExternalChunk(chunk);
+			this->external_pending.insertOrAssign(column, uint8_t(1));
+			this->external_chunks.push_back(chunk.chunk_x);
+			this->external_chunks.push_back(chunk.chunk_z);
+			continue;
+		}
+		// The region was released while the chunk was queued, it is requested again once the region is opened.
+		if (status == -5)
+			continue;
+		if (status != 0) {
+			this->absent.insertOrAssign(column, uint8_t(1));
+			continue;
+		}
+		float distance2;
+		priority(chunk.chunk_x, chunk.chunk_z, distance2);
+		if (distance2 > keepDistance * keepDistance)
+			continue;
+		size_t bytes = chunkBytes(chunk);
+		if (const ResidentChunk* previous = this->resident.find(column))
+			this->resident_bytes -= previous->bytes;
+		this->dimension->insertChunk(chunk, &added);
+		this->resident.insertOrAssign(column, ResidentChunk{bytes});
+		this->resident_bytes += bytes;
+	}
+
+	struct Candidate {
+		float priority;
+		uint64_t column;
+		size_t bytes;
+		bool resident;
+	};
+	std::vector<Candidate> candidates;
+	std::vector<uint64_t> outOfRange;
+	this->resident.forEach([&](uint64_t column, const ResidentChunk& chunk) {
+		float distance2;
+		float p = priority(ColumnKey::x(column), ColumnKey::z(column), distance2);
+		if (distance2 > keepDistance * keepDistance)
+			outOfRange.push_back(column);
+		else
+			candidates.push_back({p, column, chunk.bytes, true});
+	});
+	for (uint64_t column : outOfRange)
+		this->evict(column, removed);
+
+	int32_t centerX = int32_t(std::floor(cameraChunkX));
+	int32_t centerZ = int32_t(std::floor(cameraChunkZ));
+	int32_t radius = int32_t(this->view_distance);
+	std::vector<uint64_t> released;
+	for (int32_t dz = -radius; dz <= radius; dz++) {
+		for (int32_t dx = -radius; dx <= radius; dx++) {
+			int32_t chunk_x = centerX + dx;
+			int32_t chunk_z = centerZ + dz;
+			uint64_t column = ColumnKey::pack(chunk_x, chunk_z);
+			if (this->resident.find(column) || this->absent.find(column) || this->external_pending.find(column))
+				continue;
+			uint64_t regionKey = ColumnKey::pack(chunk_x >> 5, chunk_z >> 5);
+			const RegionFile* region = this->dimension->regionsRawData.find(regionKey);
+			if (!region)
+				continue;
+			float distance2;
+			float p = priority(chunk_x, chunk_z, distance2);
+			if (distance2 > viewDistance * viewDistance)
+				continue;
+			if (!region->hasChunkData()) {
+				if (!this->dimension->hasChunk(chunk_x, chunk_z))
+					this->absent.insertOrAssign(column, uint8_t(1));
+				else
+					released.push_back(regionKey);
+				continue;
+			}
+			candidates.push_back({p, column, 0, false});
+		}
+	}
+
+	// Fill the budget in order of priority. Chunks that are not decoded yet are assumed to be of average size.
+	// Everything after the first chunk that does not fit is evicted or not requested, so freed memory is not refilled with the same chunks.
+	std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) { return a.priority < b.priority; });
+	size_t estimate = this->resident.empty() ? default_chunk_bytes : this->resident_bytes / this->resident.size();
+	size_t planned = 0;
+	bool full = false;
+	std::vector<uint64_t> wanted;
+	for (const Candidate& candidate : candidates) {
+		size_t bytes = candidate.resident ? candidate.bytes : estimate;
+		full = full || planned + bytes > this->memory_budget;
+		if (!full) {
+			planned += bytes;
+			if (!candidate.resident)
+				wanted.push_back(candidate.column);
+		} else if (candidate.resident) {
+			this->evict(candidate.column, removed);
+		}
+	}
+
+	uint32_t pending;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->queue.clear();
+		for (auto it = wanted.rbegin(); it != wanted.rend(); it++) {
+			if (!this->in_flight.find(*it))
+				this->queue.push_back(*it);
+		}
+		pending = uint32_t(this->queue.size() + this->in_flight.size() + this->external_pending.size());
+	}
+
+	this->added_sections.clear();
+	this->removed_sections.clear();
+	appendSectionCoordinates(added, this->added_sections);
+	appendSectionCoordinates(removed, this->removed_sections);
+	std::sort(released.begin(), released.end());
+	released.erase(std::unique(released.begin(), released.end()), released.end());
+	this->released_regions.clear();
+	for (uint64_t region : released) {
+		this->released_regions.push_back(ColumnKey::x(region));
+		this->released_regions.push_back(ColumnKey::z(region));
+	}
+	return pending;
+}
+
+memUtils::KayoPointer SectionStreamer::addedSectionsJS() const {
+	return {reinterpret_cast<uintptr_t>(this->added_sections.data()), uint32_t(this->added_sections.size() * sizeof(int32_t))};
+}
+
+memUtils::KayoPointer SectionStreamer::removedSectionsJS() const {
+	return {reinterpret_cast<uintptr_t>(this->removed_sections.data()), uint32_t(this->removed_sections.size() * sizeof(int32_t))};
+}
+
+memUtils::KayoPointer SectionStreamer::releasedRegionsJS() const {
+	return {reinterpret_cast<uintptr_t>(this->released_regions.data()), uint32_t(this->released_regions.size() * sizeof(int32_t))};
+}
+
+memUtils::KayoPointer SectionStreamer::externalChunksJS() const {
+	return {reinterpret_cast<uintptr_t>(this->external_chunks.data()), uint32_t(this->external_chunks.size() * sizeof(int32_t))};
+}
+
+void SectionStreamer::markAbsent(int32_t chunk_x, int32_t chunk_z) {
+	uint64_t column = ColumnKey::pack(chunk_x, chunk_z);
+	this->external_pending.erase(column);
+	this->absent.insertOrAssign(column, uint8_t(1));
+}
+
+uint32_t SectionStreamer::residentChunks() const {
+	return uint32_t(this->resident.size());
+}
+
+uint32_t SectionStreamer::residentBytes() const {
+	return uint32_t(this->resident_bytes);
+}
+
+std::vector<uint64_t> SectionStreamer::takeBatch(uint32_t max_chunks) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	std::vector<uint64_t> batch;
+	while (batch.size() < max_chunks && !this->queue.empty()) {
+		uint64_t column = this->queue.back();
+		this->queue.pop_back();
+		this->in_flight.insertOrAssign(column, uint8_t(1));
+		batch.push_back(column);
+	}
+	return batch;
+}
+
+void SectionStreamer::deliver(std::vector<std::pair<int, DecodedChunk>>& chunks) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	for (auto& chunk : chunks)
+		this->delivered.push_back(std::move(chunk));
+	chunks.clear();
+}
+
+static void streamChunks(StreamChunksTask* task) {
+	task->chunks = task->streamer->takeBatch(task->max_chunks);
+	uint32_t numChunks = uint32_t(task->chunks.size());
+	std::vector<std::pair<int, DecodedChunk>> results(numChunks);
+	const DimensionData& dimension = *task->streamer->dimension;
+	WorkerPool::shared().parallelFor(numChunks, [task, &results, &dimension](uint32_t n) {
+		auto& [status, decoded] = results[n];
+		decoded.chunk_x = ColumnKey::x(task->chunks[n]);
+		decoded.chunk_z = ColumnKey::z(task->chunks[n]);
+		try {
+			status = dimension.decodeChunk(decoded.chunk_x, decoded.chunk_z, decoded);
+		} catch (const std::exception& e) {
+			std::cerr << "Could not decode chunk " << decoded.chunk_x << ", " << decoded.chunk_z << ": " << e.what() << std::endl;
+			status = -3;
+		}
+	});
+	task->streamer->deliver(results);
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdollar-in-identifier-extension"
+	MAIN_THREAD_ASYNC_EM_ASM({ window.kayo.taskQueue.wasmTaskFinished($0, {decodedChunks : $1}); }, task->task_id, numChunks);
+#pragma GCC diagnostic pop
+}
+
+StreamChunksTask::StreamChunksTask(uint32_t task_id, SectionStreamer* streamer, uint32_t max_chunks)
+	: Task(task_id), streamer(streamer), max_chunks(max_chunks) {}
+
+void StreamChunksTask::run() {
+	WorkerPool::shared().submit([this] { streamChunks(this); });
+}
+
+} // namespace minecraft
+} // namespace kayo
+
+using namespace emscripten;
+EMSCRIPTEN_BINDINGS(KayoSectionStreamer) {
+	class_<kayo::minecraft::SectionStreamer>("KayoWASMMinecraftSectionStreamer")
+		.constructor<kayo::minecraft::DimensionData*, uint32_t, uint32_t>()
+		.property("viewDistance", &kayo::minecraft::SectionStreamer::view_distance)
+		.function("setCamera", &kayo::minecraft::SectionStreamer::setCamera)
+		.function("setViewProjection", &kayo::minecraft::SectionStreamer::setViewProjection)
+		.function("setView", &kayo::minecraft::SectionStreamer::setView, allow_raw_pointers())
+		.function("update", &kayo::minecraft::SectionStreamer::update)
+		.function("residentChunks", &kayo::minecraft::SectionStreamer::residentChunks)
+		.function("residentBytes", &kayo::minecraft::SectionStreamer::residentBytes)
+		.property("addedSections", &kayo::minecraft::SectionStreamer::addedSectionsJS)
+		.property("removedSections", &kayo::minecraft::SectionStreamer::removedSectionsJS)
+		.property("releasedRegions", &kayo::minecraft::SectionStreamer::releasedRegionsJS)
+		.property("externalChunks", &kayo::minecraft::SectionStreamer::externalChunksJS)
+		.function("markAbsent", &kayo::minecraft::SectionStreamer::markAbsent);
+	class_<kayo::minecraft::StreamChunksTask, base<kayo::Task>>("WasmStreamChunksTask")
+		.constructor<uint32_t, kayo::minecraft::SectionStreamer*, uint32_t>()
+		.function("run", &kayo::minecraft::StreamChunksTask::run);
+}
\ No newline at end of file
@@ -0,0 +1,143 @@
+#pragma once
+#include "../kayoCore/r3/projection.hpp"
+#include "../task/task.hpp"
+#include "../utils/memUtils.hpp"
+#include "context.hpp"
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace kayo {
+namespace minecraft {
+
+/**
+ * Keeps the chunks around the camera of a dimension resident, decoding them from its opened regions on demand.
+ * Chunks in the view frustum come first, then by distance. Chunks beyond the view distance
+ * and the farthest chunks exceeding the memory budget are evicted.
+ * Regions whose chunk data was released, e.g. by a {@link BuildRegionTask}, are reported through {@link releasedRegionsJS}
+ * instead of treating their chunks as absent, so the host can open them again once it wants their chunks.
+ * Chunks stored in external .mcc files are reported through {@link externalChunksJS}. The host decodes their files
+ * with a {@link DecodeExternalChunkTask} and the next update inserts them, or reports a missing file with {@link markAbsent}.
+ * All methods except {@link takeBatch} and {@link deliver} have to be called from the same thread,
+ * regions must not be opened or released while a {@link StreamChunksTask} is running.
+ * Positions are in blocks.
+ */
+class SectionStreamer {
+  private:
+	struct ResidentChunk {
+		size_t bytes;
+	};
+
+	std::array<float, 3> camera{0.0f, 0.0f, 0.0f};
+	/**
+	 * The frustum planes (a, b, c, d) with ax + by + cz + d >= 0 inside. Without a view projection everything is visible.
+	 */
+	std::array<std::array<float, 4>, 6> planes{};
+	bool has_frustum = false;
+
+	SpatialHashMap<ColumnKey, ResidentChunk> resident;
+	/**
+	 * Chunks that are not stored in their region or could not be decoded. They are not requested again.
+	 */
+	SpatialHashMap<ColumnKey, uint8_t> absent;
+	size_t resident_bytes = 0;
+
+	std::mutex mutex;
+	/**
+	 * The chunks to decode next, most important last.
+	 */
+	std::vector<uint64_t> queue;
+	SpatialHashMap<ColumnKey, uint8_t> in_flight;
+	/**
+	 * External chunks requested from the host that were not delivered yet.
+	 */
+	SpatialHashMap<ColumnKey, uint8_t> external_pending;
+	std::vector<std::pair<int, DecodedChunk>> delivered;
+
+	std::vector<int32_t> added_sections;
+	std::vector<int32_t> removed_sections;
+	std::vector<int32_t> released_regions;
+	std::vector<int32_t> external_chunks;
+
+	bool columnVisible(int32_t chunk_x, int32_t chunk_z) const;
+	void evict(uint64_t column, std::vector<uint64_t>& removed);
+
+  public:
+	DimensionData* dimension;
+	/**
+	 * The radius of the resident area in chunks.
+	 */
+	uint32_t view_distance;
+	/**
+	 * The maximum memory of resident chunks (NBT and packed sections) in bytes.
+	 */
+	size_t memory_budget;
+	int32_t min_y = -64;
+	int32_t max_y = 320;
+
+	SectionStreamer(DimensionData* dimension, uint32_t view_distance, uint32_t memory_budget);
+	void setCamera(float x, float y, float z);
+	/**
+	 * Sets the view projection matrix (16 floats, column major) the host wrote to the WASM heap.
+	 */
+	void setViewProjection(uintptr_t matrix);
+	/**
+	 * Combines the matrix of a projection with a view matrix (16 floats, column major) the host wrote to the WASM heap.
+	 */
+	void setView(const Projection* projection, uintptr_t view_matrix);
+	/**
+	 * Inserts the chunks decoded since the last update, evicts chunks and reprioritizes the chunks to decode.
+	 * Replaces the added and removed sections of the previous update.
+	 * @returns The number of chunks waiting to be decoded.
+	 */
+	uint32_t update();
+	/**
+	 * The chunk x, section y and chunk z of the sections that became resident in the last update.
+	 */
+	kayo::memUtils::KayoPointer addedSectionsJS() const;
+	/**
+	 * The chunk x, section y and chunk z of the sections that were evicted in the last update.
+	 */
+	kayo::memUtils::KayoPointer removedSectionsJS() const;
+	/**
+	 * The region x and z of the regions with wanted chunks in the last update whose chunk data is not loaded.
+	 * Their chunks are requested again once the regions are opened.
+	 */
+	kayo::memUtils::KayoPointer releasedRegionsJS() const;
+	/**
+	 * The chunk x and z of the chunks stored in external .mcc files that were found in the last update.
+	 * The host loads their files and decodes them with a {@link DecodeExternalChunkTask} without merging them.
+	 */
+	kayo::memUtils::KayoPointer externalChunksJS() const;
+	/**
+	 * Stops waiting for an external chunk whose file does not exist or could not be decoded, it is not requested again.
+	 */
+	void markAbsent(int32_t chunk_x, int32_t chunk_z);
+	uint32_t residentChunks() const;
+	uint32_t residentBytes() const;
+	/**
+	 * Removes up to max_chunks of the most important chunks from the queue. Thread safe.
+	 */
+	std::vector<uint64_t> takeBatch(uint32_t max_chunks);
+	/**
+	 * Hands decoded chunks and their {@link DimensionData::decodeChunk} status to the next update. Thread safe.
+	 */
+	void deliver(std::vector<std::pair<int, DecodedChunk>>& chunks);
+};
+
+/**
+ * Decodes the most important chunks of a {@link SectionStreamer} on the {@link WorkerPool}.
+ * The chunks are inserted into the dimension by the next {@link SectionStreamer::update}.
+ */
+class StreamChunksTask : public Task {
+  public:
+	SectionStreamer* streamer;
+	const uint32_t max_chunks;
+	std::vector<uint64_t> chunks;
+	StreamChunksTask(uint32_t task_id, SectionStreamer* streamer, uint32_t max_chunks);
+	void run() override;
+};
+
+} // namespace minecraft
+} // namespace kayo
\ No newline at end of file
@@ -0,0 +1,331 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace kayo {
+namespace minecraft {
+
+/**
+ * Spreads the lower 32 bits of v so that there is a zero bit between each of them.
+ */
+constexpr uint64_t spreadBits(uint64_t v) {
+	v &= 0xFFFFFFFFull;
+	v = (v | (v << 16)) & 0x0000FFFF0000FFFFull;
+	v = (v | (v << 8)) & 0x00FF00FF00FF00FFull;
+	v = (v | (v << 4)) & 0x0F0F0F0F0F0F0F0Full;
+	v = (v | (v << 2)) & 0x3333333333333333ull;
+	v = (v | (v << 1)) & 0x5555555555555555ull;
+	return v;
+}
+
+/**
+ * A x/z coordinate pair (regions, chunks) packed into 64 bits.
+ */
+struct ColumnKey {
+	static constexpr uint64_t pack(int32_t x, int32_t z) {
+		return (uint64_t(uint32_t(x)) << 32) | uint64_t(uint32_t(z));
+	}
+	static constexpr int32_t x(uint64_t key) { return int32_t(uint32_t(key >> 32)); }
+	static constexpr int32_t z(uint64_t key) { return int32_t(uint32_t(key)); }
+	/**
+	 * The position of the key on the Z-order curve over x and z.
+	 */
+	static constexpr uint64_t morton(uint64_t key) {
+		uint64_t ux = uint64_t(uint32_t(x(key)) ^ 0x80000000u);
+		uint64_t uz = uint64_t(uint32_t(z(key)) ^ 0x80000000u);
+		return spreadBits(ux) | (spreadBits(uz) << 1);
+	}
+};
+
+/**
+ * A section coordinate packed into 64 bits: 28 bits x, 8 bits y and 28 bits z.
+ * This covers ±134M chunks horizontally, far beyond the world border.
+ */
+struct SectionKey {
+	static constexpr uint64_t coordinate_mask = (uint64_t(1) << 28) - 1;
+	static constexpr uint64_t pack(int32_t x, int8_t y, int32_t z) {
+		return ((uint64_t(uint32_t(x)) & coordinate_mask) << 36) | (uint64_t(uint8_t(y)) << 28) | (uint64_t(uint32_t(z)) & coordinate_mask);
+	}
+	static constexpr int32_t x(uint64_t key) { return int32_t(uint32_t(key >> 36) << 4) >> 4; }
+	static constexpr int8_t y(uint64_t key) { return int8_t(uint8_t(key >> 28)); }
+	static constexpr int32_t z(uint64_t key) { return int32_t(uint32_t(key & coordinate_mask) << 4) >> 4; }
+	/**
+	 * The position of the key on the Z-order curve over x and z, with the sections of a column kept together.
+	 */
+	static constexpr uint64_t morton(uint64_t key) {
+		uint64_t ux = (uint64_t(uint32_t(x(key))) + (uint64_t(1) << 27)) & coordinate_mask;
+		uint64_t uz = (uint64_t(uint32_t(z(key))) + (uint64_t(1) << 27)) & coordinate_mask;
+		uint64_t uy = uint64_t(uint8_t(y(key)) ^ 0x80u);
+		return ((spreadBits(ux) | (spreadBits(uz) << 1)) << 8) | uy;
+	}
+};
+
+/**
+ * An open addressing hash map with linear probing, keyed by packed 64 bit coordinates.
+ * Lookups are O(1) and report a miss as nullptr. Erasing uses backward shifting, so there are no tombstones.
+ * @tparam K The key layout ({@link ColumnKey} or {@link SectionKey}), used for Morton ordered iteration.
+ */
+template <typename K, typename V>
+class SpatialHashMap {
+  private:
+	struct Slot {
+		uint64_t key;
+		V value;
+		bool used;
+	};
+	std::vector<Slot> slots;
+	size_t count = 0;
+
+	static constexpr uint64_t hash(uint64_t key) {
+		key ^= key >> 33;
+		key *= 0xFF51AFD7ED558CCDull;
+		key ^= key >> 33;
+		key *= 0xC4CEB9FE1A85EC53ull;
+		key ^= key >> 33;
+		return key;
+	}
+
+	size_t slotOf(uint64_t key) const {
+		return static_cast<size_t>(hash(key)) & (slots.size() - 1);
+	}
+
+	void rehash(size_t num_slots) {
+		std::vector<Slot> old = std::move(slots);
+		// Value initialized slots are unused, so move-only values work as well.
+		slots = std::vector<Slot>(num_slots);
+		count = 0;
+		for (Slot& slot : old) {
+			if (slot.used)
+				insertOrAssign(slot.key, std::move(slot.value));
+		}
+	}
+
+  public:
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+	/**
+	 * The memory of the slot table. Memory the values own is not included.
+	 */
+	size_t byteSize() const { return slots.capacity() * sizeof(Slot); }
+
+	V* find(uint64_t key) {
+		return const_cast<V*>(static_cast<const SpatialHashMap*>(this)->find(key));
+	}
+
+	const V* find(uint64_t key) const {
+		if (slots.empty())
+			return nullptr;
+		size_t mask = slots.size() - 1;
+		for (size_t i = slotOf(key);; i = (i + 1) & mask) {
+			const Slot& slot = slots[i];
+			if (!slot.used)
+				return nullptr;
+			if (slot.key == key)
+				return &slot.value;
+		}
+	}
+
+	bool contains(uint64_t key) const { return find(key) != nullptr; }
+
+	V& insertOrAssign(uint64_t key, V value) {
+		// Keep the load factor below 3/4.
+		if ((count + 1) * 4 > slots.size() * 3)
+			rehash(slots.empty() ? 64 : slots.size() * 2);
+		size_t mask = slots.size() - 1;
+		for (size_t i = slotOf(key);; i = (i + 1) & mask) {
+			Slot& slot = slots[i];
+			if (!slot.used) {
+				slot = Slot{key, std::move(value), true};
+				count++;
+				return slot.value;
+			}
+			if (slot.key == key) {
+				slot.value = std::move(value);
+				return slot.value;
+			}
+		}
+	}
+
+	V& operator[](uint64_t key) {
+		if (V* value = find(key))
+			return *value;
+		return insertOrAssign(key, V());
+	}
+
+	bool erase(uint64_t key) {
+		if (slots.empty())
+			return false;
+		size_t mask = slots.size() - 1;
+		size_t i = slotOf(key);
+		while (true) {
+			if (!slots[i].used)
+				return false;
+			if (slots[i].key == key)
+				break;
+			i = (i + 1) & mask;
+		}
+		// Shift following entries of the probe sequence back into the hole.
+		size_t hole = i;
+		for (size_t j = (hole + 1) & mask; slots[j].used; j = (j + 1) & mask) {
+			size_t home = slotOf(slots[j].key);
+			if (((j - home) & mask) >= ((j - hole) & mask)) {
+				slots[hole] = std::move(slots[j]);
+				hole = j;
+			}
+		}
+		slots[hole] = Slot{0, V(), false};
+		count--;
+		// Shrink below a load factor of 1/8, so unloaded areas give their memory back.
+		if (count == 0)
+			clear();
+		else if (slots.size() > 64 && count * 8 < slots.size())
+			rehash(slots.size() / 2);
+		return true;
+	}
+
+	void clear() {
+		std::vector<Slot>().swap(slots);
+		count = 0;
+	}
+
+	/**
+	 * Calls f(key, value) for every entry in unspecified order.
+	 */
+	template <typename F>
+	void forEach(F&& f) const {
+		for (const Slot& slot : slots) {
+			if (slot.used)
+				f(slot.key, slot.value);
+		}
+	}
+
+	/**
+	 * Calls f(key, value) for every entry in Morton order of the keys, so spatially close entries are visited together.
+	 */
+	template <typename F>
+	void forEachMorton(F&& f) const {
+		std::vector<std::pair<uint64_t, const Slot*>> order;
+		order.reserve(count);
+		for (const Slot& slot : slots) {
+			if (slot.used)
+				order.emplace_back(K::morton(slot.key), &slot);
+		}
+		std::sort(order.begin(), order.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+		for (const auto& [morton, slot] : order)
+			f(slot->key, slot->value);
+	}
+};
+
+/**
+ * A {@link SpatialHashMap} for large values, which stores the values densely in fixed size pages and only their indices in the hash table.
+ * With inline values, the unused slots that keep the load factor low would cost as much as the values themselves,
+ * and pages avoid the same overhead from the growth of a single vector.
+ * Inserting keeps pointers to values valid. Erasing moves the last value into the gap, so it invalidates the pointer to that value.
+ */
+template <typename K, typename V>
+class DenseSpatialHashMap {
+  private:
+	static constexpr uint32_t values_per_page = sizeof(V) >= 64 * 1024 ? 1 : uint32_t(64 * 1024 / sizeof(V));
+	SpatialHashMap<K, uint32_t> indices;
+	std::vector<uint64_t> keys;
+	std::vector<std::unique_ptr<V[]>> pages;
+
+	V& at(uint32_t i) { return pages[i / values_per_page][i % values_per_page]; }
+	const V& at(uint32_t i) const { return pages[i / values_per_page][i % values_per_page]; }
+
+  public:
+	size_t size() const { return keys.size(); }
+	bool empty() const { return keys.empty(); }
+	/**
+	 * The memory of the hash table, the keys and the pages. Memory the values own is not included.
+	 */
+	size_t byteSize() const {
+		return indices.byteSize() + keys.capacity() * sizeof(uint64_t) + pages.capacity() * sizeof(std::unique_ptr<V[]>) + pages.size() * values_per_page * sizeof(V);
+	}
+
+	V* find(uint64_t key) {
+		const uint32_t* i = indices.find(key);
+		return i ? &at(*i) : nullptr;
+	}
+
+	const V* find(uint64_t key) const {
+		const uint32_t* i = indices.find(key);
+		return i ? &at(*i) : nullptr;
+	}
+
+	bool contains(uint64_t key) const { return indices.contains(key); }
+
+	V& insertOrAssign(uint64_t key, V value) {
+		if (uint32_t* i = indices.find(key))
+			return at(*i) = std::move(value);
+		uint32_t i = uint32_t(keys.size());
+		if (i == pages.size() * values_per_page)
+			pages.push_back(std::make_unique<V[]>(values_per_page));
+		indices.insertOrAssign(key, i);
+		keys.push_back(key);
+		return at(i) = std::move(value);
+	}
+
+	V& operator[](uint64_t key) {
+		if (V* value = find(key))
+			return *value;
+		return insertOrAssign(key, V());
+	}
+
+	bool erase(uint64_t key) {
+		const uint32_t* found = indices.find(key);
+		if (!found)
+			return false;
+		uint32_t i = *found;
+		indices.erase(key);
+		uint32_t last = uint32_t(keys.size() - 1);
+		if (i != last) {
+			keys[i] = keys[last];
+			at(i) = std::move(at(last));
+			*indices.find(keys[i]) = i;
+		}
+		at(last) = V();
+		keys.pop_back();
+		if (keys.empty())
+			clear();
+		else if (keys.size() <= (pages.size() - 1) * values_per_page)
+			pages.pop_back();
+		return true;
+	}
+
+	void clear() {
+		indices.clear();
+		std::vector<uint64_t>().swap(keys);
+		std::vector<std::unique_ptr<V[]>>().swap(pages);
+	}
+
+	/**
+	 * Calls f(key, value) for every entry in unspecified order.
+	 */
+	template <typename F>
+	void forEach(F&& f) const {
+		for (uint32_t i = 0; i < keys.size(); i++)
+			f(keys[i], at(i));
+	}
+
+	/**
+	 * Calls f(key, value) for every entry in Morton order of the keys, so spatially close entries are visited together.
+	 */
+	template <typename F>
+	void forEachMorton(F&& f) const {
+		std::vector<std::pair<uint64_t, uint32_t>> order;
+		order.reserve(keys.size());
+		for (uint32_t i = 0; i < keys.size(); i++)
+			order.emplace_back(K::morton(keys[i]), i);
+		std::sort(order.begin(), order.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+		for (const auto& [morton, i] : order)
+			f(keys[i], at(i));
+	}
+};
+
+} // namespace minecraft
+} // namespace kayo
\ No newline at end of file
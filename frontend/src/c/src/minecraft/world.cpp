@@ -0,0 +1,221 @@
+#include "world.hpp"
+#include "../task/workerPool.hpp"
+#include "../utils/zlibUtil.hpp"
+#include <algorithm>
+#include <emscripten/bind.h>
+#include <emscripten/em_asm.h>
+#include <iostream>
+#include <memory>
+
+namespace kayo {
+namespace minecraft {
+
+struct VanillaDimension {
+	const char* name;
+	int32_t index;
+	const char* region_directory;
+};
+
+static constexpr VanillaDimension vanilla_dimensions[] = {
+	{"minecraft:overworld", 0, "region"},
+	{"minecraft:the_nether", -1, "DIM-1/region"},
+	{"minecraft:the_end", 1, "DIM1/region"},
+};
+
+/**
+ * The tags of level.dat that are used. The generator settings of the dimensions are skipped.
+ */
+static const NBT::PathSet levelPaths{
+	"Data.LevelName",
+	"Data.DataVersion",
+	"Data.Version.Name",
+	"Data.SpawnX",
+	"Data.SpawnY",
+	"Data.SpawnZ",
+	"Data.WorldGenSettings.dimensions.*.type",
+};
+
+WorldData::WorldData(std::string world_name) : name(world_name) {}
+
+template <typename T>
+static bool readLevelTag(const NBT::TagTable& level, const std::string& path, int8_t id, T& out) {
+	const NBT::FlatTag* tag = NBT::getTag(level, level.root(), path);
+	if (!tag || tag->id != id)
+		return false;
+	out = T(tag->get<std::conditional_t<std::is_same_v<T, std::string>, std::string_view, T>>());
+	return true;
+}
+
+bool WorldData::loadLevel(uintptr_t byte_offset, uint32_t byte_length) {
+	std::unique_ptr<uint8_t[]> file(reinterpret_cast<uint8_t*>(byte_offset));
+	const uint8_t* data = file.get();
+	size_t length = byte_length;
+	// level.dat is gzip compressed, but some tools write it uncompressed.
+	uint8_t* inflated = nullptr;
+	if (length >= 2 && data[0] == 0x1f && data[1] == 0x8b) {
+		inflated = kayo::zlib::Inflater::local().decompress(data, length, kayo::zlib::Format::gzip, &length);
+		if (!inflated) {
+			std::cerr << "Could not decompress level.dat." << std::endl;
+			return false;
+		}
+		data = inflated;
+	}
+
+	try {
+		NBT::TagTable level(data, length, levelPaths, inflated != nullptr);
+		readLevelTag(level, "Data.LevelName", 8, this->name);
+		readLevelTag(level, "Data.DataVersion", 3, this->data_version);
+		readLevelTag(level, "Data.Version.Name", 8, this->version_name);
+		readLevelTag(level, "Data.SpawnX", 3, this->spawn_x);
+		readLevelTag(level, "Data.SpawnY", 3, this->spawn_y);
+		readLevelTag(level, "Data.SpawnZ", 3, this->spawn_z);
+
+		for (const VanillaDimension& dimension : vanilla_dimensions)
+			this->addDimension(dimension.name);
+		const NBT::FlatTag* dimensions = NBT::getTag(level, level.root(), "Data.WorldGenSettings.dimensions");
+		if (dimensions && dimensions->id == 10) {
+			for (const NBT::FlatTag* dimension = level.firstChild(dimensions); dimension; dimension = level.nextSibling(dimension))
+				this->addDimension(std::string(dimension->name));
+		}
+	} catch (const std::exception& e) {
+		std::cerr << "Could not read level.dat: " << e.what() << std::endl;
+		return false;
+	}
+	return true;
+}
+
+DimensionData* WorldData::addDimension(std::string dimension_name) {
+	if (DimensionData* dimension = this->getDimension(dimension_name))
+		return dimension;
+	int32_t index = this->next_custom_index;
+	for (const VanillaDimension& vanilla : vanilla_dimensions) {
+		if (dimension_name == vanilla.name)
+			index = vanilla.index;
+	}
+	if (index == this->next_custom_index)
+		this->next_custom_index++;
+	return &this->dimensions.try_emplace(index, dimension_name, index).first->second;
+}
+
+DimensionData* WorldData::getDimension(std::string dimension_name) {
+	for (auto& [index, dimension] : this->dimensions) {
+		if (dimension.name == dimension_name)
+			return &dimension;
+	}
+	return nullptr;
+}
+
+DimensionData* WorldData::getDimensionByIndex(int32_t index) {
+	auto it = this->dimensions.find(index);
+	return it == this->dimensions.end() ? nullptr : &it->second;
+}
+
+std::vector<std::string> WorldData::dimensionNames() const {
+	std::vector<std::string> names;
+	for (const auto& [index, dimension] : this->dimensions)
+		names.push_back(dimension.name);
+	return names;
+}
+
+MemoryUsage WorldData::memoryUsage() const {
+	MemoryUsage usage;
+	for (const auto& [index, dimension] : this->dimensions)
+		usage += dimension.memoryUsage();
+	usage.registries = BlockStateRegistry::global().byteSize() + BiomeRegistry::global().byteSize();
+	return usage;
+}
+
+std::string WorldData::regionDirectory(std::string dimension_name) {
+	for (const VanillaDimension& vanilla : vanilla_dimensions) {
+		if (dimension_name == vanilla.name)
+			return vanilla.region_directory;
+	}
+	// Datapack dimensions live in dimensions/<namespace>/<path>/region.
+	size_t colon = dimension_name.find(':');
+	std::string nameSpace = colon == std::string::npos ? "minecraft" : dimension_name.substr(0, colon);
+	std::string path = colon == std::string::npos ? dimension_name : dimension_name.substr(colon + 1);
+	return "dimensions/" + nameSpace + "/" + path + "/region";
+}
+
+std::string WorldData::dimensionOfRegionPath(std::string path) {
+	std::replace(path.begin(), path.end(), '\\', '/');
+	std::vector<std::string> segments;
+	for (size_t start = 0; start <= path.size();) {
+		size_t end = std::min(path.find('/', start), path.size());
+		if (end > start)
+			segments.push_back(path.substr(start, end - start));
+		start = end + 1;
+	}
+	if (!segments.empty() && segments.back().ends_with(".mca"))
+		segments.pop_back();
+	if (segments.empty() || segments.back() != "region")
+		return "";
+	segments.pop_back();
+
+	auto dimensionsFolder = std::find(segments.rbegin(), segments.rend(), "dimensions");
+	if (dimensionsFolder != segments.rend() && std::distance(segments.rbegin(), dimensionsFolder) >= 2) {
+		auto nameSpace = dimensionsFolder.base();
+		std::string name = *nameSpace + ":";
+		for (auto it = nameSpace + 1; it != segments.end(); it++)
+			name += (it == nameSpace + 1 ? "" : "/") + *it;
+		return name;
+	}
+	if (!segments.empty() && segments.back() == "DIM-1")
+		return "minecraft:the_nether";
+	if (!segments.empty() && segments.back() == "DIM1")
+		return "minecraft:the_end";
+	return "minecraft:overworld";
+}
+
+static void indexWorld(IndexWorldTask* task) {
+	task->regions.clear();
+	uint32_t numDimensions = 0;
+	task->world->forEachDimension([task, &numDimensions](DimensionData& dimension) {
+		numDimensions++;
+		dimension.regionsRawData.forEach([task, &dimension](uint64_t key, const RegionFile& region) { task->regions.push_back({&dimension, key, region.data.get(), {}}); });
+	});
+	WorkerPool::shared().parallelFor(uint32_t(task->regions.size()), [task](uint32_t i) { task->regions[i].index = RegionIndex::fromHeader(task->regions[i].header); });
+
+	uint32_t numChunks = 0;
+	for (const IndexedRegion& region : task->regions) {
+		region.dimension->regionIndex.insertOrAssign(region.key, region.index);
+		numChunks += region.index.num_chunks;
+	}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdollar-in-identifier-extension"
+	MAIN_THREAD_ASYNC_EM_ASM({ window.kayo.taskQueue.wasmTaskFinished($0, {dimensions : $1, regions : $2, chunks : $3}); }, task->task_id, numDimensions, uint32_t(task->regions.size()), numChunks);
+#pragma GCC diagnostic pop
+}
+
+IndexWorldTask::IndexWorldTask(uint32_t task_id, WorldData* world) : Task(task_id), world(world) {}
+
+void IndexWorldTask::run() {
+	WorkerPool::shared().submit([this] { indexWorld(this); });
+}
+
+} // namespace minecraft
+} // namespace kayo
+
+using namespace emscripten;
+EMSCRIPTEN_BINDINGS(KayoWasmMinecraftWorld) {
+	class_<kayo::minecraft::WorldData>("KayoWASMMinecraftWorld")
+		.constructor<std::string>()
+		.property("name", &kayo::minecraft::WorldData::name)
+		.property("dataVersion", &kayo::minecraft::WorldData::data_version)
+		.property("versionName", &kayo::minecraft::WorldData::version_name)
+		.property("spawnX", &kayo::minecraft::WorldData::spawn_x)
+		.property("spawnY", &kayo::minecraft::WorldData::spawn_y)
+		.property("spawnZ", &kayo::minecraft::WorldData::spawn_z)
+		.function("loadLevel", &kayo::minecraft::WorldData::loadLevel)
+		.function("addDimension", &kayo::minecraft::WorldData::addDimension, allow_raw_pointers())
+		.function("getDimension", &kayo::minecraft::WorldData::getDimension, allow_raw_pointers())
+		.function("getDimensionByIndex", &kayo::minecraft::WorldData::getDimensionByIndex, allow_raw_pointers())
+		.function("dimensionNames", &kayo::minecraft::WorldData::dimensionNames)
+		.function("memoryUsage", &kayo::minecraft::WorldData::memoryUsage)
+		.class_function("regionDirectory", &kayo::minecraft::WorldData::regionDirectory)
+		.class_function("dimensionOfRegionPath", &kayo::minecraft::WorldData::dimensionOfRegionPath);
+	class_<kayo::minecraft::IndexWorldTask, base<kayo::Task>>("WasmIndexWorldTask")
+		.constructor<uint32_t, kayo::minecraft::WorldData*>()
+		.function("run", &kayo::minecraft::IndexWorldTask::run);
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+#pragma once
+#include "../task/task.hpp"
+#include "context.hpp"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace kayo {
+namespace minecraft {
+
+/**
+ * A save folder with all of its dimensions.
+ * Vanilla dimensions keep their historic indices (overworld 0, nether -1, end 1),
+ * dimensions added by datapacks are numbered from 2 in the order they are registered.
+ */
+class WorldData {
+  private:
+	std::map<int32_t, DimensionData> dimensions;
+	int32_t next_custom_index = 2;
+
+  public:
+	std::string name;
+	/**
+	 * The data version and game version the world was last saved with, from level.dat.
+	 */
+	int32_t data_version = 0;
+	std::string version_name;
+	int32_t spawn_x = 0;
+	int32_t spawn_y = 0;
+	int32_t spawn_z = 0;
+	WorldData(std::string world_name);
+	/**
+	 * Reads level.dat from a buffer obtained from allocArrayUint8 and takes ownership of it.
+	 * Registers the vanilla dimensions and all dimensions listed in the world generation settings.
+	 * @returns false if the file could not be read.
+	 */
+	bool loadLevel(uintptr_t byte_offset, uint32_t byte_length);
+	/**
+	 * Returns the dimension with the given id (e.g. "minecraft:the_nether"), creating it if it is not known yet.
+	 */
+	DimensionData* addDimension(std::string dimension_name);
+	DimensionData* getDimension(std::string dimension_name);
+	DimensionData* getDimensionByIndex(int32_t index);
+	/**
+	 * The ids of all dimensions, ordered by their index.
+	 */
+	std::vector<std::string> dimensionNames() const;
+	/**
+	 * The memory of all dimensions of the world and the shared registries.
+	 */
+	MemoryUsage memoryUsage() const;
+	template <typename F>
+	void forEachDimension(F&& f) {
+		for (auto& [index, dimension] : this->dimensions)
+			f(dimension);
+	}
+	/**
+	 * The folder of a dimension's region files relative to the save folder, e.g. "DIM-1/region".
+	 */
+	static std::string regionDirectory(std::string dimension_name);
+	/**
+	 * The id of the dimension a region file belongs to, derived from its path within the save folder.
+	 * @returns An empty string if the path does not lead to a region folder.
+	 */
+	static std::string dimensionOfRegionPath(std::string path);
+};
+
+struct IndexedRegion {
+	DimensionData* dimension;
+	uint64_t key;
+	const uint8_t* header;
+	RegionIndex index;
+};
+
+/**
+ * Indexes the headers of all opened regions of all dimensions of a world on the {@link WorkerPool},
+ * so which chunks exist is known before any of them is decoded.
+ * The world must not be modified until the task finished.
+ */
+class IndexWorldTask : public Task {
+  public:
+	WorldData* world;
+	std::vector<IndexedRegion> regions;
+	IndexWorldTask(uint32_t task_id, WorldData* world);
+	void run() override;
+};
+
+} // namespace minecraft
+} // namespace kayo
\ No newline at end of file
@@ -0,0 +1,418 @@
+#include "worldCache.hpp"
+#include "bitUnpack.hpp"
+#include <algorithm>
+#include <cstring>
+#include <emscripten/bind.h>
+#include <iostream>
+
+namespace kayo {
+namespace minecraft {
+
+static constexpr char world_cache_magic[8] = {'K', 'A', 'Y', 'O', 'W', 'L', 'D', '\0'};
+
+static inline uint64_t align8(uint64_t offset) {
+	return (offset + 7) & ~uint64_t(7);
+}
+
+/**
+ * Numbers the registry ids a file refers to in the order they are encountered, so only the used keys are written.
+ */
+struct CacheIds {
+	std::vector<uint32_t> registry_ids;
+	std::vector<uint32_t> cache_ids;
+
+	uint32_t operator()(uint32_t id) {
+		if (id >= cache_ids.size())
+			cache_ids.resize(id + 1, UINT32_MAX);
+		if (cache_ids[id] == UINT32_MAX) {
+			cache_ids[id] = uint32_t(registry_ids.size());
+			registry_ids.push_back(id);
+		}
+		return cache_ids[id];
+	}
+	std::vector<std::string> keys(const KeyRegistry& registry) const {
+		std::vector<std::string> out;
+		out.reserve(registry_ids.size());
+		for (uint32_t id : registry_ids)
+			out.push_back(registry.key(id));
+		return out;
+	}
+};
+
+static uint64_t keyTableBytes(const std::vector<std::string>& keys) {
+	uint64_t bytes = (keys.size() + 1) * sizeof(uint32_t);
+	for (const std::string& key : keys)
+		bytes += key.size();
+	return bytes;
+}
+
+static void writeKeyTable(uint8_t* out, const std::vector<std::string>& keys) {
+	uint32_t* keyOffsets = reinterpret_cast<uint32_t*>(out);
+	char* keyData = reinterpret_cast<char*>(keyOffsets + keys.size() + 1);
+	uint32_t keyOffset = 0;
+	for (size_t i = 0; i < keys.size(); i++) {
+		keyOffsets[i] = keyOffset;
+		std::memcpy(keyData + keyOffset, keys[i].data(), keys[i].size());
+		keyOffset += uint32_t(keys[i].size());
+	}
+	keyOffsets[keys.size()] = keyOffset;
+}
+
+/**
+ * Interns the keys of a key table of a file into a registry.
+ * @returns false if the table does not fit into the file.
+ */
+template <typename Registry>
+static bool readKeyTable(const uint8_t* file, uint32_t length, uint32_t offset, uint32_t count, Registry& registry, std::vector<uint32_t>& out) {
+	uint64_t keysStart = uint64_t(offset) + (uint64_t(count) + 1) * sizeof(uint32_t);
+	if (offset % 8 != 0 || keysStart > length)
+		return false;
+	const uint32_t* keyOffsets = reinterpret_cast<const uint32_t*>(file + offset);
+	if (keysStart + keyOffsets[count] > length)
+		return false;
+	const char* keyData = reinterpret_cast<const char*>(keyOffsets + count + 1);
+	out.resize(count);
+	for (uint32_t i = 0; i < count; i++) {
+		if (keyOffsets[i] > keyOffsets[i + 1])
+			return false;
+		out[i] = registry.intern(std::string(keyData + keyOffsets[i], keyOffsets[i + 1] - keyOffsets[i]));
+	}
+	return true;
+}
+
+memUtils::KayoPointer writeWorldCacheRegion(const DimensionData& dimension, int32_t region_x, int32_t region_z) {
+	auto inRegion = [region_x, region_z](uint64_t key) { return (SectionKey::x(key) >> 5) == region_x && (SectionKey::z(key) >> 5) == region_z; };
+	std::vector<std::pair<uint64_t, const PackedSection*>> sections;
+	std::vector<std::pair<uint64_t, uint32_t>> uniformSections;
+	std::vector<std::pair<uint64_t, const SectionBiomes*>> biomeSections;
+	std::vector<std::pair<uint64_t, const NibbleArray*>> blockLight;
+	std::vector<std::pair<uint64_t, const NibbleArray*>> skyLight;
+	dimension.sectionBlockIndices.forEach([&](uint64_t key, const PackedSection& section) {
+		if (inRegion(key))
+			sections.emplace_back(key, &section);
+	});
+	dimension.uniformSections.forEach([&](uint64_t key, uint32_t state) {
+		if (inRegion(key))
+			uniformSections.emplace_back(key, state);
+	});
+	dimension.sectionBiomes.forEach([&](uint64_t key, const SectionBiomes& biomes) {
+		if (inRegion(key))
+			biomeSections.emplace_back(key, &biomes);
+	});
+	dimension.blockLight.forEach([&](uint64_t key, const NibbleArray& light) {
+		if (inRegion(key))
+			blockLight.emplace_back(key, &light);
+	});
+	dimension.skyLight.forEach([&](uint64_t key, const NibbleArray& light) {
+		if (inRegion(key))
+			skyLight.emplace_back(key, &light);
+	});
+	if (sections.empty() && uniformSections.empty())
+		return {0, 0};
+	std::sort(sections.begin(), sections.end());
+	std::sort(uniformSections.begin(), uniformSections.end());
+	std::sort(biomeSections.begin(), biomeSections.end());
+	std::sort(blockLight.begin(), blockLight.end());
+	std::sort(skyLight.begin(), skyLight.end());
+
+	CacheIds states;
+	CacheIds biomes;
+	for (auto& [key, section] : sections) {
+		for (uint32_t state : section->palette)
+			states(state);
+	}
+	for (auto& [key, state] : uniformSections)
+		states(state);
+	for (auto& [key, section] : biomeSections) {
+		for (uint32_t biome : *section)
+			biomes(biome);
+	}
+	std::vector<std::string> stateKeys = states.keys(dimension.blockStates);
+	std::vector<std::string> biomeKeys = biomes.keys(dimension.biomes);
+
+	uint64_t size = sizeof(WorldCacheHeader);
+	uint64_t statesOffset = size;
+	size = align8(size + keyTableBytes(stateKeys));
+	uint64_t biomesOffset = size;
+	size = align8(size + keyTableBytes(biomeKeys));
+	uint64_t sectionsOffset = size;
+	size += sections.size() * sizeof(WorldCacheSection);
+	uint64_t uniformSectionsOffset = size;
+	size += uniformSections.size() * sizeof(WorldCacheUniformSection);
+	uint64_t biomeSectionsOffset = size;
+	size += biomeSections.size() * sizeof(WorldCacheBiomeSection);
+	uint64_t blockLightOffset = size;
+	size += blockLight.size() * sizeof(WorldCacheLightSection);
+	uint64_t skyLightOffset = size;
+	size += skyLight.size() * sizeof(WorldCacheLightSection);
+	for (auto& [key, section] : sections)
+		size = align8(size + section->data.size() * sizeof(uint64_t) + section->palette.size() * sizeof(uint32_t));
+	if (size > UINT32_MAX) {
+		std::cerr << "The world cache of region " << region_x << ", " << region_z << " of dimension " << dimension.name << " exceeds 4 GiB." << std::endl;
+		return {0, 0};
+	}
+
+	uint8_t* out = new uint8_t[size]();
+	WorldCacheHeader* header = reinterpret_cast<WorldCacheHeader*>(out);
+	std::memcpy(header->magic, world_cache_magic, sizeof(world_cache_magic));
+	header->version = world_cache_version;
+	header->region_x = region_x;
+	header->region_z = region_z;
+	header->num_states = uint32_t(stateKeys.size());
+	header->num_biomes = uint32_t(biomeKeys.size());
+	header->num_sections = uint32_t(sections.size());
+	header->num_uniform_sections = uint32_t(uniformSections.size());
+	header->num_biome_sections = uint32_t(biomeSections.size());
+	header->num_block_light = uint32_t(blockLight.size());
+	header->num_sky_light = uint32_t(skyLight.size());
+	header->states_offset = uint32_t(statesOffset);
+	header->biomes_offset = uint32_t(biomesOffset);
+	header->sections_offset = uint32_t(sectionsOffset);
+	header->uniform_sections_offset = uint32_t(uniformSectionsOffset);
+	header->biome_sections_offset = uint32_t(biomeSectionsOffset);
+	header->block_light_offset = uint32_t(blockLightOffset);
+	header->sky_light_offset = uint32_t(skyLightOffset);
+	writeKeyTable(out + statesOffset, stateKeys);
+	writeKeyTable(out + biomesOffset, biomeKeys);
+
+	WorldCacheUniformSection* uniformTable = reinterpret_cast<WorldCacheUniformSection*>(out + uniformSectionsOffset);
+	for (auto& [key, state] : uniformSections)
+		*uniformTable++ = {key, states.cache_ids[state], 0};
+
+	WorldCacheBiomeSection* biomeTable = reinterpret_cast<WorldCacheBiomeSection*>(out + biomeSectionsOffset);
+	for (auto& [key, section] : biomeSections) {
+		WorldCacheBiomeSection& entry = *biomeTable++;
+		entry.key = key;
+		for (uint32_t i = 0; i < biomes_per_section; i++)
+			entry.biomes[i] = biomes.cache_ids[(*section)[i]];
+	}
+
+	auto writeLight = [out](uint64_t offset, const std::vector<std::pair<uint64_t, const NibbleArray*>>& light) {
+		WorldCacheLightSection* lightTable = reinterpret_cast<WorldCacheLightSection*>(out + offset);
+		for (auto& [key, section] : light) {
+			lightTable->key = key;
+			std::memcpy(lightTable->light, section->data(), light_bytes_per_section);
+			lightTable++;
+		}
+	};
+	writeLight(blockLightOffset, blockLight);
+	writeLight(skyLightOffset, skyLight);
+
+	WorldCacheSection* sectionTable = reinterpret_cast<WorldCacheSection*>(out + sectionsOffset);
+	uint64_t offset = skyLightOffset + skyLight.size() * sizeof(WorldCacheLightSection);
+	for (auto& [key, section] : sections) {
+		*sectionTable++ = {key, uint32_t(offset), uint32_t(section->data.size()), uint16_t(section->palette.size()), section->bits_per_index, 0, 0};
+		std::memcpy(out + offset, section->data.data(), section->data.size() * sizeof(uint64_t));
+		offset += section->data.size() * sizeof(uint64_t);
+		uint32_t* palette = reinterpret_cast<uint32_t*>(out + offset);
+		for (uint32_t state : section->palette)
+			*palette++ = states.cache_ids[state];
+		offset = align8(offset + section->palette.size() * sizeof(uint32_t));
+	}
+	return {reinterpret_cast<uintptr_t>(out), uint32_t(size)};
+}
+
+bool WorldCache::openRegion(uintptr_t byte_offset, uint32_t byte_length) {
+	RegionFile file;
+	file.data.reset(reinterpret_cast<uint8_t*>(byte_offset));
+	file.length = byte_length;
+	const WorldCacheHeader& header = file.header();
+	if (byte_length < sizeof(WorldCacheHeader) || std::memcmp(header.magic, world_cache_magic, sizeof(world_cache_magic)) != 0) {
+		std::cerr << "Not a world cache file." << std::endl;
+		return false;
+	}
+	if (header.version != world_cache_version) {
+		std::cerr << "Unsupported world cache version " << header.version << "." << std::endl;
+		return false;
+	}
+
+	auto tableFits = [byte_length](uint32_t offset, uint32_t count, size_t entry_size) {
+		return offset % 8 == 0 && uint64_t(offset) + uint64_t(count) * entry_size <= byte_length;
+	};
+	bool valid = tableFits(header.sections_offset, header.num_sections, sizeof(WorldCacheSection)) &&
+				 tableFits(header.uniform_sections_offset, header.num_uniform_sections, sizeof(WorldCacheUniformSection)) &&
+				 tableFits(header.biome_sections_offset, header.num_biome_sections, sizeof(WorldCacheBiomeSection)) &&
+				 tableFits(header.block_light_offset, header.num_block_light, sizeof(WorldCacheLightSection)) &&
+				 tableFits(header.sky_light_offset, header.num_sky_light, sizeof(WorldCacheLightSection)) &&
+				 readKeyTable(file.data.get(), byte_length, header.states_offset, header.num_states, BlockStateRegistry::global(), file.states) &&
+				 readKeyTable(file.data.get(), byte_length, header.biomes_offset, header.num_biomes, BiomeRegistry::global(), file.biomes);
+	if (!valid) {
+		std::cerr << "The world cache file is corrupted." << std::endl;
+		return false;
+	}
+	int32_t regionX = header.region_x;
+	int32_t regionZ = header.region_z;
+	this->regions.insertOrAssign(ColumnKey::pack(regionX, regionZ), std::move(file));
+	return true;
+}
+
+void WorldCache::closeRegion(int32_t region_x, int32_t region_z) {
+	this->regions.erase(ColumnKey::pack(region_x, region_z));
+}
+
+bool WorldCache::hasRegion(int32_t region_x, int32_t region_z) const {
+	return this->regions.contains(ColumnKey::pack(region_x, region_z));
+}
+
+/**
+ * Registers the chunk of a restored section without NBT, so {@link DimensionData::removeChunk} frees its sections.
+ */
+static void restoreChunk(DimensionData& dimension, uint64_t section_key) {
+	uint64_t column = ColumnKey::pack(SectionKey::x(section_key), SectionKey::z(section_key));
+	if (!dimension.nbtChunks.find(column))
+		dimension.nbtChunks.insertOrAssign(column, nullptr);
+}
+
+bool WorldCache::loadPackedSection(DimensionData& dimension, const RegionFile& file, const WorldCacheSection& section) const {
+	uint64_t dataBytes = uint64_t(section.num_longs) * sizeof(uint64_t);
+	if (section.data_offset % 8 != 0 || section.data_offset + dataBytes + section.palette_size * sizeof(uint32_t) > file.length ||
+		section.bits_per_index == 0 || section.bits_per_index > 16 ||
+		section.num_longs < packedLongCount(section.bits_per_index, PackedLayout::Padded, blocks_per_section)) {
+		std::cerr << "Section " << SectionKey::x(section.key) << ", " << int(SectionKey::y(section.key)) << ", " << SectionKey::z(section.key) << " of the world cache is corrupted." << std::endl;
+		return false;
+	}
+
+	PackedSection packed;
+	packed.bits_per_index = section.bits_per_index;
+	packed.palette_size = section.palette_size;
+	packed.data.resize(section.num_longs);
+	std::memcpy(packed.data.data(), file.data.get() + section.data_offset, dataBytes);
+	const uint32_t* palette = file.table<uint32_t>(uint32_t(section.data_offset + dataBytes));
+	packed.palette.resize(section.palette_size);
+	for (uint16_t i = 0; i < section.palette_size; i++)
+		packed.palette[i] = palette[i] < file.states.size() ? file.states[palette[i]] : 0;
+
+	dimension.expandedSections.invalidate(section.key);
+	dimension.uniformSections.erase(section.key);
+	dimension.sectionBlockIndices.insertOrAssign(section.key, std::move(packed));
+	restoreChunk(dimension, section.key);
+	return true;
+}
+
+static void loadBiomes(DimensionData& dimension, const std::vector<uint32_t>& biomes, const WorldCacheBiomeSection& section) {
+	SectionBiomes values;
+	for (uint32_t i = 0; i < biomes_per_section; i++)
+		values[i] = section.biomes[i] < biomes.size() ? biomes[section.biomes[i]] : 0;
+	dimension.sectionBiomes.insertOrAssign(section.key, values);
+	restoreChunk(dimension, section.key);
+}
+
+static void loadLight(DimensionData& dimension, DenseSpatialHashMap<SectionKey, NibbleArray>& light, const WorldCacheLightSection& section) {
+	NibbleArray values;
+	std::memcpy(values.data(), section.light, light_bytes_per_section);
+	light.insertOrAssign(section.key, values);
+	restoreChunk(dimension, section.key);
+}
+
+template <typename T>
+static const T* findCached(const T* entries, uint32_t count, uint64_t key) {
+	const T* end = entries + count;
+	const T* entry = std::lower_bound(entries, end, key, [](const T& e, uint64_t k) { return e.key < k; });
+	return entry != end && entry->key == key ? entry : nullptr;
+}
+
+void WorldCache::loadSectionExtras(DimensionData& dimension, const RegionFile& file, uint64_t key) const {
+	const WorldCacheHeader& header = file.header();
+	if (const WorldCacheBiomeSection* biomes = findCached(file.table<WorldCacheBiomeSection>(header.biome_sections_offset), header.num_biome_sections, key))
+		loadBiomes(dimension, file.biomes, *biomes);
+	else
+		dimension.sectionBiomes.erase(key);
+	if (const WorldCacheLightSection* light = findCached(file.table<WorldCacheLightSection>(header.block_light_offset), header.num_block_light, key))
+		loadLight(dimension, dimension.blockLight, *light);
+	else
+		dimension.blockLight.erase(key);
+	if (const WorldCacheLightSection* light = findCached(file.table<WorldCacheLightSection>(header.sky_light_offset), header.num_sky_light, key))
+		loadLight(dimension, dimension.skyLight, *light);
+	else
+		dimension.skyLight.erase(key);
+}
+
+uint32_t WorldCache::loadRegion(DimensionData* dimension, int32_t region_x, int32_t region_z) const {
+	const RegionFile* file = this->regions.find(ColumnKey::pack(region_x, region_z));
+	if (!file)
+		return 0;
+	const WorldCacheHeader& header = file->header();
+	// The chunks of a region are stored completely, so their heights follow from the loaded sections alone.
+	SpatialHashMap<ColumnKey, ColumnSurfaces> surfaces;
+	auto includeSection = [dimension, &surfaces](uint64_t key) {
+		uint64_t column = ColumnKey::pack(SectionKey::x(key), SectionKey::z(key));
+		ColumnSurfaces* columnSurfaces = surfaces.find(column);
+		if (!columnSurfaces) {
+			columnSurfaces = &surfaces.insertOrAssign(column, ColumnSurfaces());
+			columnSurfaces->fill(INT16_MIN);
+		}
+		dimension->updateSectionOccupancy(key, *columnSurfaces);
+	};
+
+	uint32_t loaded = 0;
+	const WorldCacheSection* sections = file->table<WorldCacheSection>(header.sections_offset);
+	for (uint32_t i = 0; i < header.num_sections; i++) {
+		if (!this->loadPackedSection(*dimension, *file, sections[i]))
+			continue;
+		includeSection(sections[i].key);
+		loaded++;
+	}
+	const WorldCacheUniformSection* uniformSections = file->table<WorldCacheUniformSection>(header.uniform_sections_offset);
+	for (uint32_t i = 0; i < header.num_uniform_sections; i++) {
+		const WorldCacheUniformSection& section = uniformSections[i];
+		if (section.state >= file->states.size())
+			continue;
+		dimension->expandedSections.invalidate(section.key);
+		dimension->sectionBlockIndices.erase(section.key);
+		dimension->uniformSections.insertOrAssign(section.key, file->states[section.state]);
+		restoreChunk(*dimension, section.key);
+		includeSection(section.key);
+		loaded++;
+	}
+	const WorldCacheBiomeSection* biomeSections = file->table<WorldCacheBiomeSection>(header.biome_sections_offset);
+	for (uint32_t i = 0; i < header.num_biome_sections; i++)
+		loadBiomes(*dimension, file->biomes, biomeSections[i]);
+	const WorldCacheLightSection* blockLight = file->table<WorldCacheLightSection>(header.block_light_offset);
+	for (uint32_t i = 0; i < header.num_block_light; i++)
+		loadLight(*dimension, dimension->blockLight, blockLight[i]);
+	const WorldCacheLightSection* skyLight = file->table<WorldCacheLightSection>(header.sky_light_offset);
+	for (uint32_t i = 0; i < header.num_sky_light; i++)
+		loadLight(*dimension, dimension->skyLight, skyLight[i]);
+	surfaces.forEach([dimension](uint64_t column, const ColumnSurfaces& columnSurfaces) { dimension->setChunkHeights(ColumnKey::x(column), ColumnKey::z(column), summarizeSurfaces(columnSurfaces)); });
+	return loaded;
+}
+
+bool WorldCache::loadSection(DimensionData* dimension, int32_t chunk_x, int8_t section_y, int32_t chunk_z) const {
+	const RegionFile* file = this->regions.find(ColumnKey::pack(chunk_x >> 5, chunk_z >> 5));
+	if (!file)
+		return false;
+	const WorldCacheHeader& header = file->header();
+	uint64_t key = SectionKey::pack(chunk_x, section_y, chunk_z);
+
+	if (const WorldCacheSection* section = findCached(file->table<WorldCacheSection>(header.sections_offset), header.num_sections, key)) {
+		if (!this->loadPackedSection(*dimension, *file, *section))
+			return false;
+	} else {
+		const WorldCacheUniformSection* uniform = findCached(file->table<WorldCacheUniformSection>(header.uniform_sections_offset), header.num_uniform_sections, key);
+		if (!uniform || uniform->state >= file->states.size())
+			return false;
+		dimension->expandedSections.invalidate(key);
+		dimension->sectionBlockIndices.erase(key);
+		dimension->uniformSections.insertOrAssign(key, file->states[uniform->state]);
+		restoreChunk(*dimension, key);
+	}
+	this->loadSectionExtras(*dimension, *file, key);
+	dimension->updateChunkOccupancy(chunk_x, chunk_z);
+	return true;
+}
+
+} // namespace minecraft
+} // namespace kayo
+
+using namespace emscripten;
+EMSCRIPTEN_BINDINGS(KayoWasmMinecraftWorldCache) {
+	function("writeMinecraftWorldCacheRegion", &kayo::minecraft::writeWorldCacheRegion);
+	class_<kayo::minecraft::WorldCache>("KayoWASMMinecraftWorldCache")
+		.constructor<>()
+		.function("openRegion", &kayo::minecraft::WorldCache::openRegion)
+		.function("closeRegion", &kayo::minecraft::WorldCache::closeRegion)
+		.function("numRegions", &kayo::minecraft::WorldCache::numRegions)
+		.function("hasRegion", &kayo::minecraft::WorldCache::hasRegion)
+		.function("loadRegion", &kayo::minecraft::WorldCache::loadRegion, allow_raw_pointers())
+		.function("loadSection", &kayo::minecraft::WorldCache::loadSection, allow_raw_pointers());
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+#pragma once
+#include "../utils/memUtils.hpp"
+#include "context.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace kayo {
+namespace minecraft {
+
+/**
+ * The data of one region of a dimension in a Kayo specific file, which opens without inflating or parsing any NBT.
+ * Every region is a file of its own, so the host can read, replace and drop them one at a time.
+ * All values are little endian, all offsets are relative to the start of the file and every table and section blob is 8 byte aligned,
+ * so the file can be read into the WASM heap as is. The file consists of
+ * - a {@link WorldCacheHeader},
+ * - the block state table: num_states + 1 uint32 offsets into the following UTF-8 {@link blockStateKey}s,
+ * - the biome table: num_biomes + 1 uint32 offsets into the following UTF-8 biome names,
+ * - the {@link WorldCacheSection}s, {@link WorldCacheUniformSection}s, {@link WorldCacheBiomeSection}s
+ *   and the {@link WorldCacheLightSection}s of the block and the sky light, each sorted by {@link SectionKey},
+ * - per section a blob with the packed block indices (uint64) followed by the palette (uint32 block state table indices).
+ */
+struct WorldCacheHeader {
+	char magic[8];
+	uint32_t version;
+	int32_t region_x;
+	int32_t region_z;
+	uint32_t num_states;
+	uint32_t num_biomes;
+	uint32_t num_sections;
+	uint32_t num_uniform_sections;
+	uint32_t num_biome_sections;
+	uint32_t num_block_light;
+	uint32_t num_sky_light;
+	uint32_t states_offset;
+	uint32_t biomes_offset;
+	uint32_t sections_offset;
+	uint32_t uniform_sections_offset;
+	uint32_t biome_sections_offset;
+	uint32_t block_light_offset;
+	uint32_t sky_light_offset;
+	uint32_t reserved;
+};
+
+struct WorldCacheSection {
+	uint64_t key;
+	uint32_t data_offset;
+	uint32_t num_longs;
+	uint16_t palette_size;
+	uint8_t bits_per_index;
+	uint8_t reserved;
+	uint32_t reserved2;
+};
+
+struct WorldCacheUniformSection {
+	uint64_t key;
+	uint32_t state;
+	uint32_t reserved;
+};
+
+struct WorldCacheBiomeSection {
+	uint64_t key;
+	/**
+	 * Indices into the biome table.
+	 */
+	uint32_t biomes[biomes_per_section];
+};
+
+struct WorldCacheLightSection {
+	uint64_t key;
+	uint8_t light[light_bytes_per_section];
+};
+
+constexpr uint32_t world_cache_version = 2;
+
+/**
+ * Serializes the sections of a region of a dimension into a world cache file.
+ * @returns A buffer to be freed with deleteArrayUint8, empty if the dimension has no sections in the region.
+ */
+kayo::memUtils::KayoPointer writeWorldCacheRegion(const DimensionData& dimension, int32_t region_x, int32_t region_z);
+
+/**
+ * The opened world cache files of the regions of a dimension. Only the headers and tables are validated on opening,
+ * sections are copied into a dimension when they are requested.
+ */
+class WorldCache {
+  private:
+	struct RegionFile {
+		std::unique_ptr<uint8_t[]> data;
+		uint32_t length = 0;
+		/**
+		 * The {@link BlockStateRegistry} id of every entry of the block state table of the file.
+		 */
+		std::vector<uint32_t> states;
+		/**
+		 * The {@link BiomeRegistry} id of every entry of the biome table of the file.
+		 */
+		std::vector<uint32_t> biomes;
+		const WorldCacheHeader& header() const { return *reinterpret_cast<const WorldCacheHeader*>(data.get()); }
+		template <typename T>
+		const T* table(uint32_t offset) const { return reinterpret_cast<const T*>(data.get() + offset); }
+	};
+	SpatialHashMap<ColumnKey, RegionFile> regions;
+
+	bool loadPackedSection(DimensionData& dimension, const RegionFile& file, const WorldCacheSection& section) const;
+	void loadSectionExtras(DimensionData& dimension, const RegionFile& file, uint64_t key) const;
+
+  public:
+	/**
+	 * Takes ownership of the cache file of a region the host wrote into a buffer obtained from allocArrayUint8,
+	 * replacing the file opened for the same region before.
+	 * @returns false if the file is invalid, which is freed.
+	 */
+	bool openRegion(uintptr_t byte_offset, uint32_t byte_length);
+	void closeRegion(int32_t region_x, int32_t region_z);
+	uint32_t numRegions() const { return uint32_t(this->regions.size()); }
+	bool hasRegion(int32_t region_x, int32_t region_z) const;
+	/**
+	 * Inserts all sections of a region into the dimension.
+	 * @returns The number of sections with block data loaded.
+	 */
+	uint32_t loadRegion(DimensionData* dimension, int32_t region_x, int32_t region_z) const;
+	/**
+	 * Inserts a single section with its biomes and light into the dimension.
+	 * @returns false if the cache does not contain the blocks of the section.
+	 */
+	bool loadSection(DimensionData* dimension, int32_t chunk_x, int8_t section_y, int32_t chunk_z) const;
+};
+
+} // namespace minecraft
+} // namespace kayo
\ No newline at end of file
@@ -1,5 +1,8 @@
 #pragma once
+#include <array>
+#include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <iomanip>
 #include <sstream>
 #include <string>
@@ -8,7 +8,6 @@
 #include <ranges>
 #include <string>
 #include <string_view>
-#include <unordered_set>
 
 namespace kayo {
 namespace parser {
@@ -243,98 +242,99 @@ std::vector<kayo::mesh::Mesh*> objBinaryToMesh(ParseResult const& parsed) {
 	using namespace kayo::mesh;
 	std::vector<Mesh*> meshes;
 
+	// Obj indices to mesh indices, only the entries of the current object are set.
+	std::vector<uint32_t> uv_index_map(parsed.texture_coordinates.size(), invalid_index);
+	std::vector<uint32_t> vertex_index_map(parsed.vertices.size(), invalid_index);
+
 	for (auto const& obj : parsed.objects) {
 		Mesh* mesh = new Mesh();
 		mesh->name = obj.name;
-		uint32_t attr_smooth = mesh->ensureFaceAttribute("smooth_group");
-		uint32_t attr_sharp = mesh->ensureEdgeAttribute("sharp");
+		uint32_t attr_smooth = mesh->ensureFaceAttribute("smooth_group", AttributeType::int32);
+		uint32_t attr_sharp = mesh->ensureEdgeAttribute("sharp", AttributeType::boolean);
 
-		// Get texture coordinates of this object.
-		std::map<uint32_t, UvCoordinate*> uv_index_map;
+		// Get texture coordinates and vertices used in this object.
+		UvMap* uv_map = nullptr;
+		std::vector<uint32_t> uv_indices;
+		std::vector<uint32_t> vertex_indices;
+		std::vector<uint32_t> face_vertices;
+		std::vector<uint32_t> face_sizes;
+		face_sizes.reserve(obj.faces.size());
 		for (auto const& obj_face : obj.faces) {
 			for (int32_t uv_index : obj_face.texture_coordinate_indices) {
-				if (uv_index != -1) {
-					uint32_t uv_index_u = static_cast<uint32_t>(uv_index);
-					uv_index_map[uv_index_u] = new UvCoordinate(parsed.texture_coordinates[uv_index_u]);
-				}
+				if (uv_index == -1 || uv_index_map[static_cast<uint32_t>(uv_index)] != invalid_index)
+					continue;
+				if (!uv_map)
+					uv_map = mesh->createUvMap("uv_map_1");
+				uv_index_map[static_cast<uint32_t>(uv_index)] = static_cast<uint32_t>(uv_map->uv_coordinates.size());
+				uv_map->uv_coordinates.push_back(parsed.texture_coordinates[static_cast<uint32_t>(uv_index)]);
+				uv_indices.push_back(static_cast<uint32_t>(uv_index));
 			}
-		}
-
-		UvMap* uv_map = nullptr;
-		if (uv_index_map.size() > 0)
-			uv_map = mesh->createUvMap("uv_map_1");
-
-		if (uv_map) {
-			for (const auto& [key, value] : uv_index_map)
-				uv_map->uv_coordinates.push_back(value);
-		}
-
-		// Get vertices used in this object.
-		std::map<uint32_t, SharedVertex*> vertex_index_map;
-		for (auto const& obj_face : obj.faces) {
-			std::vector<SharedVertex*> face_shared_vertices;
-			face_shared_vertices.reserve(obj_face.vertex_indices.size());
 
 			for (uint32_t vert_index : obj_face.vertex_indices) {
-				SharedVertex* sv;
-				if (vertex_index_map.contains(vert_index)) {
-					sv = vertex_index_map.at(vert_index);
-				} else {
-					sv = new SharedVertex();
-					sv->position = parsed.vertices[vert_index];
-					mesh->addSharedVertex(sv);
-					vertex_index_map[vert_index] = sv;
+				if (vertex_index_map[vert_index] == invalid_index) {
+					vertex_index_map[vert_index] = mesh->addVertex(parsed.vertices[vert_index]);
+					vertex_indices.push_back(vert_index);
 				}
-				face_shared_vertices.push_back(sv);
+				face_vertices.push_back(vertex_index_map[vert_index]);
 			}
+			face_sizes.push_back(static_cast<uint32_t>(obj_face.vertex_indices.size()));
+		}
 
-			kayo::mesh::Face* mesh_face = mesh->fillSharedVertices(face_shared_vertices);
-			if (!mesh_face)
+		std::vector<uint32_t> mesh_faces = mesh->fillFaces(face_vertices.data(), face_sizes.data(), static_cast<uint32_t>(face_sizes.size()));
+		std::vector<uint32_t> material_index_map(parsed.material_names.size(), invalid_index);
+		int32_t* smooth_groups = mesh->face_attributes[attr_smooth].data<int32_t>();
+		for (size_t f = 0; f < obj.faces.size(); f++) {
+			auto const& obj_face = obj.faces[f];
+			uint32_t mesh_face = mesh_faces[f];
+			if (mesh_face == invalid_index)
 				continue;
 
 			if (obj_face.material_index >= 0 && static_cast<size_t>(obj_face.material_index) < parsed.material_names.size()) {
-				const std::string& mname = parsed.material_names[static_cast<size_t>(obj_face.material_index)];
-				uint32_t mat_index = mesh->addMaterial(mname);
-				mesh_face->material_index = mat_index;
+				uint32_t& mat_index = material_index_map[static_cast<size_t>(obj_face.material_index)];
+				if (mat_index == invalid_index)
+					mat_index = mesh->addMaterial(parsed.material_names[static_cast<size_t>(obj_face.material_index)]);
+				mesh->face_materials[mesh_face] = mat_index;
 			}
 
-			mesh_face->attributes[attr_smooth] = obj_face.smooth_group;
+			smooth_groups[mesh_face] = obj_face.smooth_group;
 
-			size_t n = mesh_face->edges.size();
+			uint32_t first_corner = mesh->face_corners[mesh_face];
+			size_t n = obj_face.vertex_indices.size();
 			for (size_t i = 0; i < n; ++i) {
-				Vertex* vert = mesh_face->edges[i]->in;
+				uint32_t corner = first_corner + static_cast<uint32_t>(i);
 				int32_t norm_index = obj_face.normal_index[i];
 				if (norm_index >= 0)
-					vert->normal = parsed.normals[static_cast<uint32_t>(norm_index)];
+					mesh->corner_normals[corner] = parsed.normals[static_cast<uint32_t>(norm_index)];
 
 				if (uv_map) {
 					int32_t tc_index = obj_face.texture_coordinate_indices[i];
 					if (tc_index >= 0) {
-						vert->uvs[0] = uv_index_map[static_cast<uint32_t>(tc_index)];
+						uv_map->corner_uvs[corner] = uv_index_map[static_cast<uint32_t>(tc_index)];
 					}
 				}
 			}
 		}
 
-		for (SharedEdge* e : mesh->getSharedEdges()) {
-			std::unordered_set<int32_t> groups;
-			for (Edge* ed : e->edges) {
-				if (!ed->face)
-					continue;
-				int32_t g = -1;
-				auto it = ed->face->attributes.find(attr_smooth);
-				if (it != ed->face->attributes.end())
-					g = std::any_cast<int32_t>(it->second);
-				groups.insert(g);
-			}
-
-			bool sharp = (groups.size() > 1);
-			e->attributes[attr_sharp] = sharp;
+		for (uint32_t uv_index : uv_indices)
+			uv_index_map[uv_index] = invalid_index;
+		for (uint32_t vert_index : vertex_indices)
+			vertex_index_map[vert_index] = invalid_index;
+
+		// An edge is sharp if the faces using it are in different smoothing groups.
+		std::vector<int32_t> corner_groups(mesh->numCorners());
+		for (uint32_t c = 0; c < mesh->numCorners(); c++)
+			corner_groups[c] = smooth_groups[mesh->corner_faces[c]];
+
+		AttributeColumn& sharp = mesh->edge_attributes[attr_sharp];
+		for (uint32_t e = 0; e < mesh->numSharedEdges(); e++) {
+			uint32_t first = mesh->edge_corners[e];
+			bool is_sharp = false;
+			for (uint32_t c = mesh->corner_next_at_edge[first]; c != invalid_index; c = mesh->corner_next_at_edge[c])
+				is_sharp |= corner_groups[c] != corner_groups[first];
+			sharp.setBool(e, is_sharp);
 		}
 
-		for (kayo::mesh::Face* f : mesh->getFaces()) {
-			f->attributes.erase(attr_smooth);
-		}
+		mesh->face_attributes.remove("smooth_group");
 
 		meshes.push_back(mesh);
 	}
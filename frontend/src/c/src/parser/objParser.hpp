@@ -34,6 +34,7 @@ struct ParseResult {
 	std::vector<Object> objects;
 };
 
+ParseResult parseObj(std::string const& contents);
 std::vector<kayo::mesh::Mesh*> objBinaryToMesh(ParseResult const& parsed);
 
 class ParseTask : public kayo::Task {
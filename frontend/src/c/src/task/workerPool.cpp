@@ -0,0 +1,100 @@
+#include "workerPool.hpp"
+#include <algorithm>
+#include <iostream>
+#include <pthread.h>
+#include <thread>
+
+namespace kayo {
+
+WorkerPool::WorkerPool(uint32_t num_threads) {
+	for (uint32_t i = 0; i < num_threads; i++) {
+		pthread_t thread;
+		int result = pthread_create(&thread, nullptr, &WorkerPool::threadMain, this);
+		if (result != 0) {
+			std::cerr << "Error: Unable to create worker pool thread, " << result << std::endl;
+			break;
+		}
+		pthread_detach(thread);
+		this->num_threads++;
+	}
+}
+
+WorkerPool& WorkerPool::shared() {
+	// Never destroyed, the threads keep running until the module is torn down.
+	static WorkerPool* pool = new WorkerPool(std::max(std::thread::hardware_concurrency(), 1u));
+	return *pool;
+}
+
+void* WorkerPool::threadMain(void* arg) {
+	WorkerPool* pool = reinterpret_cast<WorkerPool*>(arg);
+	std::unique_lock<std::mutex> lock(pool->mutex);
+	while (true) {
+		pool->wake.wait(lock, [pool] { return !pool->jobs.empty() || !pool->tasks.empty(); });
+		// Helping a running parallelFor comes first, its caller is waiting for it.
+		if (!pool->jobs.empty()) {
+			ParallelJob* job = pool->jobs.back();
+			job->helpers++;
+			lock.unlock();
+			runItems(*job);
+			lock.lock();
+			pool->removeJob(job);
+			job->helpers--;
+			pool->job_finished.notify_all();
+			continue;
+		}
+		std::function<void()> body = std::move(pool->tasks.front());
+		pool->tasks.pop_front();
+		lock.unlock();
+		body();
+		lock.lock();
+	}
+	return nullptr;
+}
+
+void WorkerPool::runItems(ParallelJob& job) {
+	for (uint32_t i = job.next_item++; i < job.num_items; i = job.next_item++) {
+		(*job.body)(i);
+		job.finished_items++;
+	}
+}
+
+void WorkerPool::removeJob(ParallelJob* job) {
+	auto it = std::find(this->jobs.begin(), this->jobs.end(), job);
+	if (it != this->jobs.end())
+		this->jobs.erase(it);
+}
+
+void WorkerPool::submit(std::function<void()> body) {
+	if (this->num_threads == 0) {
+		body();
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->tasks.push_back(std::move(body));
+	}
+	this->wake.notify_one();
+}
+
+void WorkerPool::parallelFor(uint32_t num_items, const std::function<void(uint32_t)>& body) {
+	if (num_items == 0)
+		return;
+	ParallelJob job;
+	job.body = &body;
+	job.num_items = num_items;
+	if (num_items > 1 && this->num_threads > 0) {
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->jobs.push_back(&job);
+		}
+		this->wake.notify_all();
+	}
+	runItems(job);
+
+	// The job lives on this stack, so no helper may still hold it when returning.
+	std::unique_lock<std::mutex> lock(this->mutex);
+	this->removeJob(&job);
+	this->job_finished.wait(lock, [&job] { return job.finished_items == job.num_items && job.helpers == 0; });
+}
+
+} // namespace kayo
\ No newline at end of file
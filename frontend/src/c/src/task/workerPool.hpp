@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace kayo {
+
+/**
+ * The threads that tasks do their work on, so concurrent tasks share the hardware threads instead of each starting their own.
+ * A task queues its body with {@link submit}. A body that splits its work into items calls {@link parallelFor},
+ * which runs the items on the calling thread and on idle pool threads. As the caller takes items as well,
+ * parallelFor finishes even if all pool threads are busy, so bodies may use it without risking a deadlock.
+ * Only {@link submit} may be called on the browser main thread, which must not block.
+ */
+class WorkerPool {
+  private:
+	struct ParallelJob {
+		const std::function<void(uint32_t)>* body;
+		uint32_t num_items;
+		std::atomic<uint32_t> next_item = 0;
+		std::atomic<uint32_t> finished_items = 0;
+		/**
+		 * The pool threads currently running items of the job, guarded by the mutex of the pool.
+		 */
+		uint32_t helpers = 0;
+	};
+
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable job_finished;
+	std::deque<std::function<void()>> tasks;
+	/**
+	 * The jobs of running parallelFor calls that still have unclaimed items.
+	 */
+	std::vector<ParallelJob*> jobs;
+	uint32_t num_threads = 0;
+
+	WorkerPool(uint32_t num_threads);
+	static void* threadMain(void* arg);
+	static void runItems(ParallelJob& job);
+	void removeJob(ParallelJob* job);
+
+  public:
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+	/**
+	 * The pool of the module with one thread per hardware thread, started on first use.
+	 */
+	static WorkerPool& shared();
+	uint32_t size() const { return num_threads; }
+	/**
+	 * Runs a task body on a pool thread. Bodies start in the order they were submitted.
+	 */
+	void submit(std::function<void()> body);
+	/**
+	 * Calls body(i) for every i below num_items on the calling thread and idle pool threads and returns once all calls returned.
+	 * The body must not throw.
+	 */
+	void parallelFor(uint32_t num_items, const std::function<void(uint32_t)>& body);
+};
+
+} // namespace kayo
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#elif defined(__SSSE3__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/**
+ * Bulk conversion of big endian arrays (as stored in NBT) into native little endian arrays.
+ * Uses wasm SIMD128 on the WASM build, SSSE3/AVX2 on native x86 builds and a scalar fallback otherwise.
+ * Source and destination may be unaligned but must not overlap.
+ */
+namespace kayo {
+namespace byteSwap {
+
+inline void copyBigEndian32Scalar(const uint8_t* src, int32_t* dst, size_t count) {
+	for (size_t i = 0; i < count; i++) {
+		uint32_t v;
+		std::memcpy(&v, src + i * 4, 4);
+		v = __builtin_bswap32(v);
+		std::memcpy(dst + i, &v, 4);
+	}
+}
+
+inline void copyBigEndian64Scalar(const uint8_t* src, int64_t* dst, size_t count) {
+	for (size_t i = 0; i < count; i++) {
+		uint64_t v;
+		std::memcpy(&v, src + i * 8, 8);
+		v = __builtin_bswap64(v);
+		std::memcpy(dst + i, &v, 8);
+	}
+}
+
+inline void copyBigEndian32(const uint8_t* src, int32_t* dst, size_t count) {
+	size_t i = 0;
+#if defined(__wasm_simd128__)
+	const v128_t mask = wasm_i8x16_const(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+	for (; i + 4 <= count; i += 4)
+		wasm_v128_store(dst + i, wasm_i8x16_swizzle(wasm_v128_load(src + i * 4), mask));
+#elif defined(__AVX2__)
+	const __m256i mask = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+	for (; i + 8 <= count; i += 8) {
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_shuffle_epi8(v, mask));
+	}
+#elif defined(__SSSE3__)
+	const __m128i mask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+	for (; i + 4 <= count; i += 4) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_shuffle_epi8(v, mask));
+	}
+#endif
+	copyBigEndian32Scalar(src + i * 4, dst + i, count - i);
+}
+
+inline void copyBigEndian64(const uint8_t* src, int64_t* dst, size_t count) {
+	size_t i = 0;
+#if defined(__wasm_simd128__)
+	const v128_t mask = wasm_i8x16_const(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+	for (; i + 2 <= count; i += 2)
+		wasm_v128_store(dst + i, wasm_i8x16_swizzle(wasm_v128_load(src + i * 8), mask));
+#elif defined(__AVX2__)
+	const __m256i mask = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+	for (; i + 4 <= count; i += 4) {
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 8));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_shuffle_epi8(v, mask));
+	}
+#elif defined(__SSSE3__)
+	const __m128i mask = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+	for (; i + 2 <= count; i += 2) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 8));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_shuffle_epi8(v, mask));
+	}
+#endif
+	copyBigEndian64Scalar(src + i * 8, dst + i, count - i);
+}
+
+inline void copyBytes(const uint8_t* src, int8_t* dst, size_t count) {
+	std::memcpy(dst, src, count);
+}
+
+} // namespace byteSwap
+} // namespace kayo
\ No newline at end of file
@@ -0,0 +1,73 @@
+#include "lz4Util.hpp"
+#include <cstring>
+
+namespace kayo {
+namespace lz4 {
+
+constexpr size_t min_match = 4;
+
+/**
+ * Reads the continuation bytes of a literal or match length.
+ */
+static bool readLength(const uint8_t*& in, const uint8_t* end, size_t& length) {
+	uint8_t next;
+	do {
+		if (in >= end)
+			return false;
+		next = *in++;
+		length += next;
+	} while (next == 255);
+	return true;
+}
+
+int64_t decompressBlock(const uint8_t* input, size_t input_length, uint8_t* output, size_t output_capacity) {
+	const uint8_t* in = input;
+	const uint8_t* const inEnd = input + input_length;
+	uint8_t* out = output;
+	uint8_t* const outEnd = output + output_capacity;
+
+	while (in < inEnd) {
+		const uint8_t token = *in++;
+
+		size_t literals = token >> 4;
+		if (literals == 15 && !readLength(in, inEnd, literals))
+			return -1;
+		if (literals > size_t(inEnd - in) || literals > size_t(outEnd - out))
+			return -1;
+		std::memcpy(out, in, literals);
+		in += literals;
+		out += literals;
+
+		// The last sequence consists of literals only.
+		if (in == inEnd)
+			break;
+
+		if (inEnd - in < 2)
+			return -1;
+		size_t offset = size_t(in[0]) | (size_t(in[1]) << 8);
+		in += 2;
+		if (offset == 0 || offset > size_t(out - output))
+			return -1;
+
+		size_t match = token & 15;
+		if (match == 15 && !readLength(in, inEnd, match))
+			return -1;
+		match += min_match;
+		if (match > size_t(outEnd - out))
+			return -1;
+
+		const uint8_t* from = out - offset;
+		if (offset >= match) {
+			std::memcpy(out, from, match);
+			out += match;
+		} else {
+			// Overlapping matches repeat the last offset bytes.
+			for (size_t i = 0; i < match; i++)
+				*out++ = from[i];
+		}
+	}
+	return int64_t(out - output);
+}
+
+} // namespace lz4
+} // namespace kayo
\ No newline at end of file
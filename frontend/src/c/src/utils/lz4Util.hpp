@@ -0,0 +1,16 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace kayo {
+namespace lz4 {
+
+/**
+ * Decompresses a single LZ4 block (without any frame) into output.
+ * All reads and writes are bounds checked, so corrupt input can not overrun either buffer.
+ * @returns The number of bytes written or -1 if the block is corrupt or does not fit into output.
+ */
+int64_t decompressBlock(const uint8_t* input, size_t input_length, uint8_t* output, size_t output_capacity);
+
+} // namespace lz4
+} // namespace kayo
\ No newline at end of file
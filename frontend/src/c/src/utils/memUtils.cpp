@@ -1,15 +1,24 @@
 #include "memUtils.hpp"
 #include "../numerics/fixedMath.hpp"
 #include <emscripten/bind.h>
+#include <emscripten/heap.h>
+#include <malloc.h>
 
 namespace kayo {
 namespace memUtils {
+KayoPointer allocArrayUint8(uint32_t num_elements) {
+	return allocKayoArray<uint8_t>(num_elements);
+}
 void deleteArrayUint8(uintptr_t offset) {
 	delete[] reinterpret_cast<uint8_t*>(offset);
 }
 void deleteArrayDouble(uintptr_t byteOffset) {
 	delete[] reinterpret_cast<double*>(byteOffset);
 }
+HeapUsage getHeapUsage() {
+	struct mallinfo info = mallinfo();
+	return {emscripten_get_heap_size(), size_t(info.uordblks)};
+}
 FixedPoint::NumberWire readFixedPointFromHeap(uintptr_t ptr) {
 	return static_cast<FixedPoint::NumberWire>(reinterpret_cast<FixedPoint::Number*>(ptr)[0]);
 }
@@ -18,9 +27,14 @@ FixedPoint::NumberWire readFixedPointFromHeap(uintptr_t ptr) {
 
 using namespace emscripten;
 EMSCRIPTEN_BINDINGS(MemUtilsWasm) {
+	function("allocArrayUint8", &kayo::memUtils::allocArrayUint8);
 	function("deleteArrayUint8", &kayo::memUtils::deleteArrayUint8);
 	function("deleteArrayDouble", &kayo::memUtils::deleteArrayDouble);
 	function("readFixedPointFromHeap", &kayo::memUtils::readFixedPointFromHeap);
+	function("getHeapUsage", &kayo::memUtils::getHeapUsage);
+	value_object<kayo::memUtils::HeapUsage>("HeapUsage")
+		.field("heapSize", &kayo::memUtils::HeapUsage::heap_size)
+		.field("allocated", &kayo::memUtils::HeapUsage::allocated);
 	value_object<kayo::memUtils::KayoPointer>("KayoPointer")
 		.field("byteOffset", &kayo::memUtils::KayoPointer::byteOffset)
 		.field("byteLength", &kayo::memUtils::KayoPointer::byteLength);
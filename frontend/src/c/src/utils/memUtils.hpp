@@ -1,4 +1,5 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
 
 namespace kayo {
@@ -14,6 +15,19 @@ struct KayoPointer {
 	uint32_t byteLength;
 };
 
+struct HeapUsage {
+	/**
+	 * The size of the WASM memory.
+	 */
+	size_t heap_size;
+	/**
+	 * The bytes currently allocated by malloc, including its bookkeeping.
+	 */
+	size_t allocated;
+};
+
+HeapUsage getHeapUsage();
+
 template <typename T>
 inline KayoPointer allocKayoArray(uint32_t num_elements) {
 	return KayoPointer(reinterpret_cast<uintptr_t>(new T[num_elements]), num_elements * sizeof(T));
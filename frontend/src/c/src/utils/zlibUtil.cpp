@@ -0,0 +1,112 @@
+#include "zlibUtil.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+
+namespace kayo {
+namespace zlib {
+
+/**
+ * The largest output that is accepted, the same limit as for LZ4 chunks.
+ * Chunks and level.dat files stay far below it, so a stream that inflates to more is corrupt or malicious and would exhaust the heap.
+ */
+constexpr size_t max_inflated_bytes = size_t(256) << 20;
+
+static int windowBits(Format format) {
+	switch (format) {
+	case Format::gzip:
+		return MAX_WBITS + 16;
+	case Format::zlib:
+		return MAX_WBITS;
+	case Format::raw:
+		return -MAX_WBITS;
+	}
+	return MAX_WBITS;
+}
+
+Inflater::~Inflater() {
+	if (this->initialized)
+		inflateEnd(&this->stream);
+}
+
+bool Inflater::reset(Format format) {
+	int result;
+	if (!this->initialized) {
+		result = inflateInit2_(&this->stream, windowBits(format), ZLIB_VERSION, int(sizeof(z_stream)));
+		this->initialized = result == Z_OK;
+	} else {
+		result = inflateReset2(&this->stream, windowBits(format));
+	}
+	if (result != Z_OK)
+		std::cerr << "Error: Unable to initialize inflate, " << result << std::endl;
+	return result == Z_OK;
+}
+
+bool Inflater::run(const uint8_t* input, size_t input_length, Format format, uint8_t*& buffer, size_t& capacity, size_t& size) {
+	if (!this->reset(format))
+		return false;
+	this->stream.next_in = const_cast<Bytef*>(input);
+	this->stream.avail_in = uInt(input_length);
+
+	const size_t start = size;
+	// Chunk NBT typically compresses 3-6x; the buffer doubles from there.
+	size_t required = size + std::max<size_t>(input_length * 4, 256);
+	while (true) {
+		if (capacity < required) {
+			if (capacity >= max_inflated_bytes) {
+				std::cerr << "Error: Inflated data exceeds " << max_inflated_bytes << " bytes." << std::endl;
+				size = start;
+				return false;
+			}
+			required = std::min(required, max_inflated_bytes);
+			uint8_t* resized = static_cast<uint8_t*>(std::realloc(buffer, required));
+			if (!resized) {
+				size = start;
+				return false;
+			}
+			buffer = resized;
+			capacity = required;
+		}
+		uInt available = uInt(std::min<size_t>(capacity - size, UINT_MAX));
+		this->stream.next_out = buffer + size;
+		this->stream.avail_out = available;
+		int result = ::inflate(&this->stream, Z_NO_FLUSH);
+		size += available - this->stream.avail_out;
+		if (result == Z_STREAM_END)
+			return true;
+		// Z_BUF_ERROR with a full output only means there was no room to make progress.
+		if (result == Z_OK || (result == Z_BUF_ERROR && this->stream.avail_out == 0)) {
+			if (this->stream.avail_out == 0)
+				required = capacity * 2;
+			continue;
+		}
+		size = start;
+		return false;
+	}
+}
+
+uint8_t* Inflater::decompress(const uint8_t* input, size_t input_length, Format format, size_t* output_length) {
+	uint8_t* buffer = nullptr;
+	size_t capacity = 0;
+	size_t size = 0;
+	if (!this->run(input, input_length, format, buffer, capacity, size)) {
+		std::free(buffer);
+		return nullptr;
+	}
+	// Give back the unused part of the buffer, the result may be kept for a long time.
+	if (size > 0 && size < capacity) {
+		if (uint8_t* shrunk = static_cast<uint8_t*>(std::realloc(buffer, size)))
+			buffer = shrunk;
+	}
+	*output_length = size;
+	return buffer;
+}
+
+Inflater& Inflater::local() {
+	static thread_local Inflater inflater;
+	return inflater;
+}
+
+} // namespace zlib
+} // namespace kayo
\ No newline at end of file
@@ -1,32 +1,52 @@
 #pragma once
 #include "../../zlib/zlib.h"
-#include <iostream>
-#include <stdexcept>
-#include <vector>
+#include <cstddef>
+#include <cstdint>
 
-inline Bytef* zlib_decompress(const Bytef* input, size_t input_length, size_t* output_length) {
-	// Initial output buffer size
-	size_t buffer_size = input_length * 4; // Starting size, can adjust if needed
-	Bytef* output = static_cast<Bytef*>(malloc(buffer_size));
-	if (!output) {
-		return NULL; // Memory allocation failed
-	}
+namespace kayo {
+namespace zlib {
 
-	int result;
-	while ((result = uncompress(output, &buffer_size, input, input_length)) == Z_BUF_ERROR) {
-		// Buffer too small, increase its size and try again
-		buffer_size *= 2;
-		output = static_cast<Bytef*>(realloc(output, buffer_size));
-		if (!output) {
-			return NULL; // Memory reallocation failed
-		}
-	}
+enum class Format : uint8_t {
+	/**
+	 * gzip header and trailer, as used by level.dat and chunk compression type 1.
+	 */
+	gzip,
+	/**
+	 * zlib header and trailer, as used by chunk compression type 2.
+	 */
+	zlib,
+	/**
+	 * A deflate stream without any header.
+	 */
+	raw,
+};
 
-	if (result != Z_OK) {
-		free(output); // Free memory on failure
-		return NULL;
-	}
+/**
+ * A reusable inflate stream. The stream state and window are allocated once and reset for every input.
+ * The output grows in place, so nothing is decompressed twice.
+ */
+class Inflater {
+  private:
+	z_stream stream{};
+	bool initialized = false;
+	bool reset(Format format);
+	bool run(const uint8_t* input, size_t input_length, Format format, uint8_t*& buffer, size_t& capacity, size_t& size);
 
-	*output_length = buffer_size; // Set the actual decompressed size
-	return output;
-}
\ No newline at end of file
+  public:
+	Inflater() = default;
+	Inflater(const Inflater&) = delete;
+	Inflater& operator=(const Inflater&) = delete;
+	~Inflater();
+	/**
+	 * Decompresses input into a new buffer allocated with malloc.
+	 * @returns The buffer, which the caller has to free, or nullptr if the input is corrupt or inflates to more than 256 MiB.
+	 */
+	uint8_t* decompress(const uint8_t* input, size_t input_length, Format format, size_t* output_length);
+	/**
+	 * The inflater of the calling thread.
+	 */
+	static Inflater& local();
+};
+
+} // namespace zlib
+} // namespace kayo
\ No newline at end of file
@@ -1,4 +1,4 @@
-import { RealtimeData } from "../../c/KayoCorePP";
+import { KayoPointer, RealtimeData } from "../../c/KayoCorePP";
 import { Kayo } from "../Kayo";
 import { Representation } from "../project/Representation";
 import RealtimeRenderable from "../rendering/RealtimeRenderable";
@@ -6,6 +6,17 @@ import RealtimeRenderer from "../rendering/RealtimeRenderer";
 import { MaterialRealtimeRenderingRepresentation } from "./MaterialRealtimeRenderingRepresentation";
 import { MeshObject } from "./MeshObject";
 import { MeshObjectRealtimeRenderingPipeline } from "./MeshObjectRealtimeRenderingPipeline";
+import { BuildRealtimeDataTask } from "../ressourceManagement/wasmTasks/BuildRealtimeDataTask";
+
+type DrawRange = { material: number; first: number; count: number };
+
+/**
+ * The indexed output of RealtimeData, missing in modules built before it was added.
+ */
+type IndexedRealtimeData = {
+	indices?: { format: string; numIndices: number; bytesTotal: number; data: KayoPointer };
+	drawRanges?: { size(): number; get(index: number): DrawRange | undefined };
+};
 
 export class MeshObjectRealtimeRenderingRepresentation
 	extends Representation<RealtimeRenderer, MeshObject>
@@ -15,9 +26,17 @@ export class MeshObjectRealtimeRenderingRepresentation
 	private _positionBuffer: GPUBuffer | null = null;
 	private _tangentSpaceBuffer: GPUBuffer | null = null;
 	private _uvsBuffer: GPUBuffer | null = null;
+	private _indexBuffer: GPUBuffer | null = null;
+	private _indexFormat: GPUIndexFormat = "uint32";
+	private _drawRanges: DrawRange[] = [];
 	private _realtimeData!: RealtimeData;
+	/**
+	 * Counts the rebuilds, so an indexed build that finishes after the next rebuild is dropped.
+	 */
+	private _buildGeneration = 0;
 	private _vertexBufferLayout: GPUVertexBufferLayout[];
 	private _pipeline!: MeshObjectRealtimeRenderingPipeline;
+	private _pipelines: MeshObjectRealtimeRenderingPipeline[] = [];
 
 	public constructor(kayo: Kayo, representationConcept: RealtimeRenderer, representationSubject: MeshObject) {
 		super(representationConcept, representationSubject);
@@ -55,10 +74,36 @@ export class MeshObjectRealtimeRenderingRepresentation
 				continue;
 			}
 			this._pipeline = materialRealtimeRepresentation.getOrCreatePipelineFor(this);
+			this._pipelines[i] = this._pipeline;
 		}
 	}
 
 	private _rebuildBuffers() {
+		if (this._realtimeData) this._realtimeData.delete();
+		const mesh = this._representationSubject.mesh;
+		const generation = ++this._buildGeneration;
+		if (!BuildRealtimeDataTask.indexInTask(this._kayo.wasmx, mesh)) {
+			this._realtimeData = new this._kayo.wasmx.wasm.RealtimeData(mesh);
+			this._uploadBuffers();
+			return;
+		}
+
+		// Large meshes are drawn without indices until the worker indexed them.
+		this._realtimeData = BuildRealtimeDataTask.buildUnindexed(this._kayo.wasmx, mesh);
+		this._uploadBuffers();
+		const onIndexed = (realtimeData: RealtimeData) => {
+			if (generation !== this._buildGeneration) {
+				realtimeData.delete();
+				return;
+			}
+			this._realtimeData.delete();
+			this._realtimeData = realtimeData;
+			this._uploadBuffers();
+		};
+		this._kayo.taskQueue.queueWasmTask(new BuildRealtimeDataTask(this._kayo.wasmx, mesh, onIndexed));
+	}
+
+	private _uploadBuffers() {
 		const gpuDevice = this._kayo.gpux.gpuDevice;
 		if (this._positionBuffer) this._positionBuffer.destroy();
 		this._positionBuffer = null;
@@ -66,7 +111,9 @@ export class MeshObjectRealtimeRenderingRepresentation
 		this._uvsBuffer = null;
 		if (this._tangentSpaceBuffer) this._tangentSpaceBuffer.destroy();
 		this._tangentSpaceBuffer = null;
-		this._realtimeData = new this._kayo.wasmx.wasm.RealtimeData(this._representationSubject.mesh);
+		if (this._indexBuffer) this._indexBuffer.destroy();
+		this._indexBuffer = null;
+		this._drawRanges = [];
 		this._positionBuffer = gpuDevice.createBuffer({
 			label: "Mesh Realtime Position",
 			size: this._realtimeData.position.bytesTotal,
@@ -113,6 +160,29 @@ export class MeshObjectRealtimeRenderingRepresentation
 				uvPtr.byteLength,
 			);
 		}
+
+		const indexed = this._realtimeData as RealtimeData & IndexedRealtimeData;
+		if (indexed.indices && indexed.drawRanges && indexed.indices.numIndices > 0) {
+			this._indexFormat = indexed.indices.format as GPUIndexFormat;
+			this._indexBuffer = gpuDevice.createBuffer({
+				label: "Mesh Realtime Indices",
+				size: indexed.indices.bytesTotal,
+				usage: GPUBufferUsage.COPY_DST | GPUBufferUsage.INDEX,
+			});
+			const indexPtr = indexed.indices.data;
+
+			gpuDevice.queue.writeBuffer(
+				this._indexBuffer,
+				0,
+				this._kayo.wasmx.memory,
+				indexPtr.byteOffset,
+				indexPtr.byteLength,
+			);
+			for (let i = 0; i < indexed.drawRanges.size(); i++) {
+				const range = indexed.drawRanges.get(i);
+				if (range) this._drawRanges.push(range);
+			}
+		}
 	}
 
 	private _updateVertexBufferLayout() {
@@ -154,10 +224,19 @@ export class MeshObjectRealtimeRenderingRepresentation
 
 	public recordForwardRendering(renderPassEncoder: GPURenderPassEncoder) {
 		renderPassEncoder.setBindGroup(0, this.representationConcept.bindGroup0);
-		renderPassEncoder.setPipeline(this._pipeline.gpuPipeline);
 		renderPassEncoder.setVertexBuffer(0, this._positionBuffer);
 		renderPassEncoder.setVertexBuffer(1, this._tangentSpaceBuffer);
 		renderPassEncoder.setVertexBuffer(2, this._uvsBuffer);
-		renderPassEncoder.draw(this._realtimeData.position.numVertices);
+		if (!this._indexBuffer) {
+			renderPassEncoder.setPipeline(this._pipeline.gpuPipeline);
+			renderPassEncoder.draw(this._realtimeData.position.numVertices);
+			return;
+		}
+		renderPassEncoder.setIndexBuffer(this._indexBuffer, this._indexFormat);
+		for (const range of this._drawRanges) {
+			const pipeline = this._pipelines[range.material] ?? this._pipeline;
+			renderPassEncoder.setPipeline(pipeline.gpuPipeline);
+			renderPassEncoder.drawIndexed(range.count, 1, range.first);
+		}
 	}
 }
@@ -0,0 +1,61 @@
+import type { ClassHandle, KayoPointer } from "../../c/KayoCorePP";
+import WASMX from "../WASMX";
+import { PaletteEntry } from "./MinecraftWorld";
+
+type KayoWASMMinecraftBlockStates = ClassHandle & { readonly keys: KayoPointer; readonly offsets: KayoPointer };
+type BlockStateBindings = { KayoWASMMinecraftBlockStates?: { global(): KayoWASMMinecraftBlockStates } };
+
+/**
+ * Turns ids of the global block state registry into palette entries, using the keys and offsets views of the registry.
+ * Ids are never reused, so every entry is only decoded once.
+ */
+export class BlockStateKeys {
+	private _wasmx: WASMX;
+	private _registry: KayoWASMMinecraftBlockStates;
+	private _entries: PaletteEntry[] = [];
+	private _decoder = new TextDecoder();
+
+	private constructor(wasmx: WASMX, registry: KayoWASMMinecraftBlockStates) {
+		this._wasmx = wasmx;
+		this._registry = registry;
+	}
+
+	/**
+	 * Undefined if the wasm module was built before the block state registry was bound.
+	 */
+	public static create(wasmx: WASMX): BlockStateKeys | undefined {
+		const blockStates = (wasmx.wasm as unknown as BlockStateBindings).KayoWASMMinecraftBlockStates;
+		return blockStates ? new BlockStateKeys(wasmx, blockStates.global()) : undefined;
+	}
+
+	public palette(ids: Uint32Array): PaletteEntry[] {
+		const entries: PaletteEntry[] = [];
+		for (const id of ids) entries.push(this.entry(id));
+		return entries;
+	}
+
+	public entry(id: number): PaletteEntry {
+		const cached = this._entries[id];
+		if (cached) return cached;
+
+		// The views are fetched for every new id, as the registry moves them when it grows.
+		const offsetsPtr = this._registry.offsets;
+		const offsets = new Uint32Array(this._wasmx.memory, offsetsPtr.byteOffset, offsetsPtr.byteLength / 4);
+		const keysPtr = this._registry.keys;
+		const keyBytes = this._wasmx.getUint8View(keysPtr.byteOffset + offsets[id], offsets[id + 1] - offsets[id]);
+		// TextDecoder does not accept views of shared memory.
+		const key = this._decoder.decode(keyBytes.slice());
+
+		const bracket = key.indexOf("[");
+		const entry: PaletteEntry = { Name: bracket < 0 ? key : key.substring(0, bracket) };
+		if (bracket >= 0) {
+			entry.Properties = {};
+			for (const property of key.substring(bracket + 1, key.length - 1).split(",")) {
+				const equals = property.indexOf("=");
+				entry.Properties[property.substring(0, equals)] = property.substring(equals + 1);
+			}
+		}
+		this._entries[id] = entry;
+		return entry;
+	}
+}
@@ -2,6 +2,7 @@ export abstract class WasmTask {
 	public abstract run(taskID: number): void;
 	public abstract progressCallback(progress: number, maximum: number): void;
 	public abstract finishedCallback(returnValue: any): void;
+	public externalChunkCallback?(chunkX: number, chunkZ: number): void;
 }
 
 export abstract class FSTask {
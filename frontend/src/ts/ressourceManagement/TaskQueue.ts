@@ -207,6 +207,15 @@ export class TaskQueue {
 		task.progressCallback(progress, maximum);
 	}
 
+	public wasmTaskRequestExternalChunk(taskID: number, chunkX: number, chunkZ: number) {
+		const task = this._wasmTaskMap[taskID];
+		if (!task || !task.externalChunkCallback) {
+			console.log(`Task with id ${taskID} can not load the external chunk ${chunkX}, ${chunkZ}.`);
+			return;
+		}
+		task.externalChunkCallback(chunkX, chunkZ);
+	}
+
 	public wasmTaskFinished(taskID: number, returnValue: any) {
 		const taskEntry = this._wasmTaskMap[taskID];
 		if (!taskEntry) {
@@ -0,0 +1,64 @@
+import { ClassHandle, Mesh, RealtimeData } from "../../../c/KayoCorePP";
+import WASMX from "../../WASMX";
+import { WasmTask } from "../Task";
+
+type WasmBuildRealtimeDataTask = ClassHandle & { run(): void; takeRealtimeData(): RealtimeData };
+
+/**
+ * The task and the parts of RealtimeData it relies on, missing in modules built before they were added.
+ */
+type RealtimeDataTaskBindings = {
+	WasmBuildRealtimeDataTask?: new (taskID: number, mesh: Mesh) => WasmBuildRealtimeDataTask;
+	RealtimeData: { new (mesh: Mesh, indexed: boolean): RealtimeData; indexInTask?: (mesh: Mesh) => boolean };
+};
+
+/**
+ * Builds the indexed RealtimeData of a large Mesh on a worker, see {@link BuildRealtimeDataTask.indexInTask}.
+ * The finished callback takes ownership of the RealtimeData. The Mesh must not be modified until then.
+ */
+export class BuildRealtimeDataTask extends WasmTask {
+	private _wasmx: WASMX;
+	private _taskID!: number;
+	private _wasmTask!: WasmBuildRealtimeDataTask;
+	private _mesh: Mesh;
+	private _callback: (realtimeData: RealtimeData) => void;
+
+	public constructor(wasmx: WASMX, mesh: Mesh, finishedCallback: (realtimeData: RealtimeData) => void) {
+		super();
+		this._wasmx = wasmx;
+		this._mesh = mesh;
+		this._callback = finishedCallback;
+	}
+
+	/**
+	 * Whether the Mesh should be drawn without indices until a BuildRealtimeDataTask indexed it,
+	 * as indexing it on the main thread would take longer than a frame.
+	 */
+	public static indexInTask(wasmx: WASMX, mesh: Mesh): boolean {
+		const bindings = wasmx.wasm as unknown as RealtimeDataTaskBindings;
+		return bindings.WasmBuildRealtimeDataTask !== undefined && bindings.RealtimeData.indexInTask?.(mesh) === true;
+	}
+
+	/**
+	 * The RealtimeData drawn until the task finished, which has one vertex per triangle corner.
+	 */
+	public static buildUnindexed(wasmx: WASMX, mesh: Mesh): RealtimeData {
+		return new (wasmx.wasm as unknown as RealtimeDataTaskBindings).RealtimeData(mesh, false);
+	}
+
+	public run(taskID: number): void {
+		this._taskID = taskID;
+		const WasmBuildRealtimeDataTask = (this._wasmx.wasm as unknown as RealtimeDataTaskBindings)
+			.WasmBuildRealtimeDataTask;
+		if (!WasmBuildRealtimeDataTask) throw new Error("The wasm module does not export WasmBuildRealtimeDataTask.");
+		this._wasmTask = new WasmBuildRealtimeDataTask(taskID, this._mesh);
+		this._wasmTask.run();
+	}
+	public progressCallback(progress: number, maximum: number): void {
+		console.log(this._taskID, progress, maximum);
+	}
+	public finishedCallback(_: any): void {
+		this._callback(this._wasmTask.takeRealtimeData());
+		this._wasmTask.delete();
+	}
+}
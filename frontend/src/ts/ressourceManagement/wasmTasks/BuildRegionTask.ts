@@ -0,0 +1,107 @@
+import WASMX from "../../WASMX";
+import { WasmTask } from "../Task";
+import { TaskQueue } from "../TaskQueue";
+import { DecodeExternalChunkTask } from "./DecodeExternalChunkTask";
+import { MinecraftDimension, minecraftTaskBinding, WasmBuildRegionTaskHandle } from "./MinecraftTaskBindings";
+
+export type BuildRegionResult = { builtChunks: number; failedChunks: number; externalChunks: number };
+
+/**
+ * What the worker reports once all chunks are decoded, before they are merged.
+ */
+type DecodeRegionResult = { numChunks: number; failedChunks: number };
+
+/**
+ * Loads the contents of the .mcc file of a chunk, undefined if the file does not exist.
+ */
+export type ExternalChunkLoader = (chunkX: number, chunkZ: number) => Promise<Uint8Array | undefined>;
+
+/**
+ * Decodes all chunks of a region opened with openRegion on workers and merges them into the dimension
+ * on the main thread once they are decoded.
+ * Chunks stored in .mcc files are loaded with the loader and decoded by a {@link DecodeExternalChunkTask} each,
+ * externalChunkMerged is called once such a chunk is merged.
+ */
+export class BuildRegionTask extends WasmTask {
+	protected _wasmx: WASMX;
+	protected _taskID!: number;
+	protected _wasmTask!: WasmBuildRegionTaskHandle;
+	protected _dimension: MinecraftDimension;
+	protected _regionX: number;
+	protected _regionZ: number;
+	private _taskQueue: TaskQueue;
+	private _loadExternalChunk: ExternalChunkLoader;
+	private _externalChunkMerged: (chunkX: number, chunkZ: number, changedSections: Int32Array) => void;
+	private _callback: (ret: any) => void;
+
+	public constructor(
+		wasmx: WASMX,
+		taskQueue: TaskQueue,
+		dimension: MinecraftDimension,
+		regionX: number,
+		regionZ: number,
+		loadExternalChunk: ExternalChunkLoader,
+		externalChunkMerged: (chunkX: number, chunkZ: number, changedSections: Int32Array) => void,
+		finishedCallback: (ret: BuildRegionResult) => void,
+	) {
+		super();
+		this._wasmx = wasmx;
+		this._taskQueue = taskQueue;
+		this._dimension = dimension;
+		this._regionX = regionX;
+		this._regionZ = regionZ;
+		this._loadExternalChunk = loadExternalChunk;
+		this._externalChunkMerged = externalChunkMerged;
+		this._callback = finishedCallback;
+	}
+
+	public run(taskID: number): void {
+		this._taskID = taskID;
+		const WasmBuildRegionTask = minecraftTaskBinding(this._wasmx, "WasmBuildRegionTask");
+		this._wasmTask = new WasmBuildRegionTask(taskID, this._dimension, this._regionX, this._regionZ);
+		this._wasmTask.run();
+	}
+	public progressCallback(progress: number, maximum: number): void {
+		console.log(this._taskID, progress, maximum);
+	}
+	public externalChunkCallback(chunkX: number, chunkZ: number): void {
+		const onDecoded = (status: number, changedSections: Int32Array | undefined) => {
+			if (status !== 0 || !changedSections) {
+				console.log(`The external chunk ${chunkX}, ${chunkZ} could not be decoded: ${status}.`);
+				return;
+			}
+			this._externalChunkMerged(chunkX, chunkZ, changedSections);
+		};
+		const onLoaded = (data: Uint8Array | undefined) => {
+			if (!data) {
+				console.log(`The external chunk ${chunkX}, ${chunkZ} does not exist.`);
+				return;
+			}
+			this._taskQueue.queueWasmTask(
+				new DecodeExternalChunkTask(this._wasmx, this._dimension, chunkX, chunkZ, data, onDecoded),
+			);
+		};
+		const onError = (error: unknown) => console.error(error);
+		this._loadExternalChunk(chunkX, chunkZ).then(onLoaded, onError);
+	}
+	public finishedCallback(returnValue: any): void {
+		const decoded = returnValue as DecodeRegionResult;
+		const externalChunks = this._mergeChunks();
+		this._callback({
+			builtChunks: this._wasmTask.builtChunks,
+			failedChunks: decoded.failedChunks,
+			externalChunks,
+		});
+		this._wasmTask.delete();
+	}
+
+	/**
+	 * Inserts the decoded chunks into the dimension and loads the external chunks.
+	 * @returns The number of external chunks.
+	 */
+	protected _mergeChunks(): number {
+		const external = this._wasmTask.merge();
+		for (let i = 0; i < external.length; i += 2) this.externalChunkCallback(external[i], external[i + 1]);
+		return external.length / 2;
+	}
+}
@@ -0,0 +1,61 @@
+import WASMX from "../../WASMX";
+import { WasmTask } from "../Task";
+import { copyToWasm, MinecraftDimension, minecraftTaskBinding, WasmMinecraftTaskHandle } from "./MinecraftTaskBindings";
+
+/**
+ * Decodes the contents of a .mcc file on a worker and merges the chunk into the dimension on the main thread
+ * once it is decoded. Chunks a section streamer requested are not merged, the next update of the streamer inserts them.
+ */
+export class DecodeExternalChunkTask extends WasmTask {
+	private _wasmx: WASMX;
+	private _taskID!: number;
+	private _wasmTask!: WasmMinecraftTaskHandle;
+	private _dimension: MinecraftDimension;
+	private _chunkX: number;
+	private _chunkZ: number;
+	private _data: Uint8Array;
+	private _callback: (status: number, changedSections: Int32Array | undefined) => void;
+	private _merge: boolean;
+
+	public constructor(
+		wasmx: WASMX,
+		dimension: MinecraftDimension,
+		chunkX: number,
+		chunkZ: number,
+		data: Uint8Array,
+		finishedCallback: (status: number, changedSections: Int32Array | undefined) => void,
+		merge = true,
+	) {
+		super();
+		this._wasmx = wasmx;
+		this._dimension = dimension;
+		this._chunkX = chunkX;
+		this._chunkZ = chunkZ;
+		this._data = data;
+		this._callback = finishedCallback;
+		this._merge = merge;
+	}
+
+	public run(taskID: number): void {
+		this._taskID = taskID;
+		const ptr = copyToWasm(this._wasmx, this._data);
+		const WasmDecodeExternalChunkTask = minecraftTaskBinding(this._wasmx, "WasmDecodeExternalChunkTask");
+		this._wasmTask = new WasmDecodeExternalChunkTask(
+			taskID,
+			this._dimension,
+			this._chunkX,
+			this._chunkZ,
+			ptr.byteOffset,
+			ptr.byteLength,
+		);
+		this._wasmTask.run();
+	}
+	public progressCallback(progress: number, maximum: number): void {
+		console.log(this._taskID, progress, maximum);
+	}
+	public finishedCallback(returnValue: any): void {
+		const status = returnValue as number;
+		this._callback(status, status === 0 && this._merge ? this._dimension.mergeExternalChunks() : undefined);
+		this._wasmTask.delete();
+	}
+}
@@ -0,0 +1,40 @@
+import { KayoWASMMinecraftWorld } from "../../../c/KayoCorePP";
+import WASMX from "../../WASMX";
+import { WasmTask } from "../Task";
+import { minecraftTaskBinding, WasmMinecraftTaskHandle } from "./MinecraftTaskBindings";
+
+/**
+ * Reads the chunk tables of all regions added to a world.
+ */
+export class IndexWorldTask extends WasmTask {
+	private _wasmx: WASMX;
+	private _taskID!: number;
+	private _wasmTask!: WasmMinecraftTaskHandle;
+	private _world: KayoWASMMinecraftWorld;
+	private _callback: (ret: any) => void;
+
+	public constructor(
+		wasmx: WASMX,
+		world: KayoWASMMinecraftWorld,
+		finishedCallback: (ret: { dimensions: number; regions: number; chunks: number }) => void,
+	) {
+		super();
+		this._wasmx = wasmx;
+		this._world = world;
+		this._callback = finishedCallback;
+	}
+
+	public run(taskID: number): void {
+		this._taskID = taskID;
+		const WasmIndexWorldTask = minecraftTaskBinding(this._wasmx, "WasmIndexWorldTask");
+		this._wasmTask = new WasmIndexWorldTask(taskID, this._world);
+		this._wasmTask.run();
+	}
+	public progressCallback(progress: number, maximum: number): void {
+		console.log(this._taskID, progress, maximum);
+	}
+	public finishedCallback(returnValue: any): void {
+		this._callback(returnValue);
+		this._wasmTask.delete();
+	}
+}
@@ -0,0 +1,59 @@
+import WASMX from "../../WASMX";
+import { WasmTask } from "../Task";
+import {
+	MinecraftBlockModels,
+	MinecraftDimension,
+	minecraftTaskBinding,
+	WasmMeshChunkTaskHandle,
+} from "./MinecraftTaskBindings";
+
+/**
+ * Meshes all sections of a chunk. The meshes belong to the task,
+ * so they are only valid during the finished callback.
+ * Not used by the region import yet, which still builds its sections with {@link MinecraftSection.buildGeometry}.
+ * That needs a block model table filled from the resource pack (cube faces per world direction after the
+ * blockstate rotation) and the custom blocks of each mesh built by the host.
+ * The buffers of a SectionMesh already match the vertex layout of the opaque Minecraft pipeline.
+ * Queue it only after the region tasks merged their chunks, the dimension must not change while it runs.
+ */
+export class MeshChunkTask extends WasmTask {
+	private _wasmx: WASMX;
+	private _taskID!: number;
+	private _wasmTask!: WasmMeshChunkTaskHandle;
+	private _dimension: MinecraftDimension;
+	private _blockModels: MinecraftBlockModels;
+	private _chunkX: number;
+	private _chunkZ: number;
+	private _callback: (ret: any, meshes: WasmMeshChunkTaskHandle) => void;
+
+	public constructor(
+		wasmx: WASMX,
+		dimension: MinecraftDimension,
+		blockModels: MinecraftBlockModels,
+		chunkX: number,
+		chunkZ: number,
+		finishedCallback: (ret: { meshedSections: number; quads: number }, meshes: WasmMeshChunkTaskHandle) => void,
+	) {
+		super();
+		this._wasmx = wasmx;
+		this._dimension = dimension;
+		this._blockModels = blockModels;
+		this._chunkX = chunkX;
+		this._chunkZ = chunkZ;
+		this._callback = finishedCallback;
+	}
+
+	public run(taskID: number): void {
+		this._taskID = taskID;
+		const WasmMeshChunkTask = minecraftTaskBinding(this._wasmx, "WasmMeshChunkTask");
+		this._wasmTask = new WasmMeshChunkTask(taskID, this._dimension, this._blockModels, this._chunkX, this._chunkZ);
+		this._wasmTask.run();
+	}
+	public progressCallback(progress: number, maximum: number): void {
+		console.log(this._taskID, progress, maximum);
+	}
+	public finishedCallback(returnValue: any): void {
+		this._callback(returnValue, this._wasmTask);
+		this._wasmTask.delete();
+	}
+}
@@ -0,0 +1,82 @@
+import type {
+	ClassHandle,
+	KayoPointer,
+	KayoWASMMinecraftDimension,
+	KayoWASMMinecraftWorld,
+} from "../../../c/KayoCorePP";
+import WASMX from "../../WASMX";
+
+export type WasmMinecraftTaskHandle = ClassHandle & { run(): void };
+export type WasmBuildRegionTaskHandle = WasmMinecraftTaskHandle & { merge(): Int32Array; readonly builtChunks: number };
+export type WasmReloadRegionTaskHandle = WasmBuildRegionTaskHandle & { readonly changedSections: KayoPointer };
+export type WasmMeshChunkTaskHandle = WasmMinecraftTaskHandle & {
+	numMeshes(): number;
+	getMesh(index: number): ClassHandle;
+};
+export type MinecraftBlockModels = ClassHandle;
+export type MinecraftSectionStreamer = ClassHandle & {
+	readonly externalChunks: KayoPointer;
+	markAbsent(chunkX: number, chunkZ: number): void;
+};
+export type MinecraftDimension = KayoWASMMinecraftDimension & { mergeExternalChunks(): Int32Array };
+
+/**
+ * The minecraft tasks as they are bound in buildRegionTask.cpp, sectionStreamer.cpp, world.cpp and meshChunkTask.cpp.
+ * They are checked at runtime, as a KayoCorePP.d.ts generated before the tasks existed does not declare them.
+ */
+type MinecraftTaskBindings = {
+	allocArrayUint8?: (numElements: number) => KayoPointer;
+	WasmBuildRegionTask?: new (
+		taskID: number,
+		dimension: KayoWASMMinecraftDimension,
+		regionX: number,
+		regionZ: number,
+	) => WasmBuildRegionTaskHandle;
+	WasmReloadRegionTask?: new (
+		taskID: number,
+		dimension: KayoWASMMinecraftDimension,
+		regionX: number,
+		regionZ: number,
+		byteOffset: number,
+		byteLength: number,
+	) => WasmReloadRegionTaskHandle;
+	WasmDecodeExternalChunkTask?: new (
+		taskID: number,
+		dimension: KayoWASMMinecraftDimension,
+		chunkX: number,
+		chunkZ: number,
+		byteOffset: number,
+		byteLength: number,
+	) => WasmMinecraftTaskHandle;
+	WasmStreamChunksTask?: new (
+		taskID: number,
+		streamer: MinecraftSectionStreamer,
+		maxChunks: number,
+	) => WasmMinecraftTaskHandle;
+	WasmIndexWorldTask?: new (taskID: number, world: KayoWASMMinecraftWorld) => WasmMinecraftTaskHandle;
+	WasmMeshChunkTask?: new (
+		taskID: number,
+		dimension: KayoWASMMinecraftDimension,
+		blockModels: MinecraftBlockModels,
+		chunkX: number,
+		chunkZ: number,
+	) => WasmMeshChunkTaskHandle;
+};
+
+export function minecraftTaskBinding<K extends keyof MinecraftTaskBindings>(
+	wasmx: WASMX,
+	name: K,
+): NonNullable<MinecraftTaskBindings[K]> {
+	const binding = (wasmx.wasm as unknown as MinecraftTaskBindings)[name];
+	if (!binding) throw new Error(`The wasm module does not export ${name}.`);
+	return binding as NonNullable<MinecraftTaskBindings[K]>;
+}
+
+/**
+ * Copies a buffer into memory from allocArrayUint8, which the minecraft tasks take ownership of.
+ */
+export function copyToWasm(wasmx: WASMX, data: Uint8Array): KayoPointer {
+	const ptr = minecraftTaskBinding(wasmx, "allocArrayUint8")(data.byteLength);
+	wasmx.getUint8View(ptr.byteOffset, ptr.byteLength).set(data);
+	return ptr;
+}
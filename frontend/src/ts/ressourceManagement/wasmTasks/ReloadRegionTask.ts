@@ -0,0 +1,74 @@
+import WASMX from "../../WASMX";
+import { TaskQueue } from "../TaskQueue";
+import { BuildRegionResult, BuildRegionTask, ExternalChunkLoader } from "./BuildRegionTask";
+import {
+	copyToWasm,
+	MinecraftDimension,
+	minecraftTaskBinding,
+	WasmReloadRegionTaskHandle,
+} from "./MinecraftTaskBindings";
+
+/**
+ * The result of the reload is passed to the callback of the ReloadRegionTask instead.
+ */
+function ignoreBuildResult() {}
+
+export type ReloadRegionResult = BuildRegionResult & { reloadedChunks: number; changedSections: number };
+
+/**
+ * Replaces a region with a newer version of its file and decodes the chunks that changed.
+ * The finished callback receives the x, y and z coordinates of the changed sections,
+ * which are only valid during the call.
+ */
+export class ReloadRegionTask extends BuildRegionTask {
+	private _data: Uint8Array;
+	private _reloadCallback: (ret: ReloadRegionResult, changedSections: Int32Array) => void;
+
+	public constructor(
+		wasmx: WASMX,
+		taskQueue: TaskQueue,
+		dimension: MinecraftDimension,
+		regionX: number,
+		regionZ: number,
+		data: Uint8Array,
+		loadExternalChunk: ExternalChunkLoader,
+		externalChunkMerged: (chunkX: number, chunkZ: number, changedSections: Int32Array) => void,
+		finishedCallback: (ret: ReloadRegionResult, changedSections: Int32Array) => void,
+	) {
+		super(wasmx, taskQueue, dimension, regionX, regionZ, loadExternalChunk, externalChunkMerged, ignoreBuildResult);
+		this._data = data;
+		this._reloadCallback = finishedCallback;
+	}
+
+	public run(taskID: number): void {
+		this._taskID = taskID;
+		const ptr = copyToWasm(this._wasmx, this._data);
+		const WasmReloadRegionTask = minecraftTaskBinding(this._wasmx, "WasmReloadRegionTask");
+		this._wasmTask = new WasmReloadRegionTask(
+			taskID,
+			this._dimension,
+			this._regionX,
+			this._regionZ,
+			ptr.byteOffset,
+			ptr.byteLength,
+		);
+		this._wasmTask.run();
+	}
+	public finishedCallback(returnValue: any): void {
+		const decoded = returnValue as { numChunks: number; failedChunks: number };
+		const externalChunks = this._mergeChunks();
+		const ptr = (this._wasmTask as WasmReloadRegionTaskHandle).changedSections;
+		const changedSections = new Int32Array(this._wasmx.memory, ptr.byteOffset, ptr.byteLength / 4);
+		this._reloadCallback(
+			{
+				reloadedChunks: decoded.numChunks,
+				builtChunks: this._wasmTask.builtChunks,
+				failedChunks: decoded.failedChunks,
+				externalChunks,
+				changedSections: changedSections.length / 3,
+			},
+			changedSections,
+		);
+		this._wasmTask.delete();
+	}
+}
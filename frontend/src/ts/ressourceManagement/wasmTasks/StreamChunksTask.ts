@@ -0,0 +1,87 @@
+import WASMX from "../../WASMX";
+import { WasmTask } from "../Task";
+import { TaskQueue } from "../TaskQueue";
+import { ExternalChunkLoader } from "./BuildRegionTask";
+import { DecodeExternalChunkTask } from "./DecodeExternalChunkTask";
+import {
+	MinecraftDimension,
+	MinecraftSectionStreamer,
+	minecraftTaskBinding,
+	WasmMinecraftTaskHandle,
+} from "./MinecraftTaskBindings";
+
+/**
+ * Decodes the next chunks around the position of a section streamer.
+ * The streamer must not be used until the task finished.
+ */
+export class StreamChunksTask extends WasmTask {
+	private _wasmx: WASMX;
+	private _taskID!: number;
+	private _wasmTask!: WasmMinecraftTaskHandle;
+	private _streamer: MinecraftSectionStreamer;
+	private _maxChunks: number;
+	private _callback: (ret: any) => void;
+
+	public constructor(
+		wasmx: WASMX,
+		streamer: MinecraftSectionStreamer,
+		maxChunks: number,
+		finishedCallback: (ret: { decodedChunks: number }) => void,
+	) {
+		super();
+		this._wasmx = wasmx;
+		this._streamer = streamer;
+		this._maxChunks = maxChunks;
+		this._callback = finishedCallback;
+	}
+
+	public run(taskID: number): void {
+		this._taskID = taskID;
+		const WasmStreamChunksTask = minecraftTaskBinding(this._wasmx, "WasmStreamChunksTask");
+		this._wasmTask = new WasmStreamChunksTask(taskID, this._streamer, this._maxChunks);
+		this._wasmTask.run();
+	}
+	public progressCallback(progress: number, maximum: number): void {
+		console.log(this._taskID, progress, maximum);
+	}
+	public finishedCallback(returnValue: any): void {
+		this._callback(returnValue);
+		this._wasmTask.delete();
+	}
+}
+
+/**
+ * Loads and decodes the .mcc files of the external chunks the last update of a streamer found.
+ * The next update inserts the decoded chunks, chunks without a readable file are marked absent.
+ */
+export function requestStreamedExternalChunks(
+	wasmx: WASMX,
+	taskQueue: TaskQueue,
+	dimension: MinecraftDimension,
+	streamer: MinecraftSectionStreamer,
+	loadExternalChunk: ExternalChunkLoader,
+): void {
+	const ptr = streamer.externalChunks;
+	const chunks = new Int32Array(wasmx.memory, ptr.byteOffset, ptr.byteLength / 4).slice();
+	for (let i = 0; i < chunks.length; i += 2) {
+		const chunkX = chunks[i];
+		const chunkZ = chunks[i + 1];
+		const onDecoded = (status: number) => {
+			if (status !== 0) streamer.markAbsent(chunkX, chunkZ);
+		};
+		const onLoaded = (data: Uint8Array | undefined) => {
+			if (!data) {
+				streamer.markAbsent(chunkX, chunkZ);
+				return;
+			}
+			taskQueue.queueWasmTask(
+				new DecodeExternalChunkTask(wasmx, dimension, chunkX, chunkZ, data, onDecoded, false),
+			);
+		};
+		const onError = (error: unknown) => {
+			console.error(error);
+			streamer.markAbsent(chunkX, chunkZ);
+		};
+		loadExternalChunk(chunkX, chunkZ).then(onLoaded, onError);
+	}
+}
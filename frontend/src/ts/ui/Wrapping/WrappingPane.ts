@@ -4,6 +4,7 @@ import { unzip } from "unzipit";
 import { ResourcePack } from "../../minecraft/ResourcePack";
 import { MinecraftSection } from "../../minecraft/MinecraftSection";
 import { MinecraftWorld, PaletteEntry } from "../../minecraft/MinecraftWorld";
+import { BlockStateKeys } from "../../minecraft/BlockStateKeys";
 import { Kayo } from "../../Kayo";
 import { StoreFileTask } from "../../ressourceManagement/jsTasks/StoreFileTask";
 import { CreateAtlasTask } from "../../ressourceManagement/wasmTasks/CreateAtlasTask";
@@ -14,6 +15,8 @@ import { Material } from "../../mesh/Material";
 
 let ressourecePack!: ResourcePack;
 
+type SectionPaletteIds = { getSectionPaletteIds?(x: number, y: number, z: number): Uint32Array };
+
 export class WrappingPane extends HTMLElement {
 	public baseSplitPaneContainer!: SplitPaneContainer;
 	private _header?: HTMLDivElement;
@@ -127,13 +130,19 @@ export class WrappingPane extends HTMLElement {
 					const dimension = new this._kayo.wasmx.wasm.KayoWASMMinecraftDimension("Overworld", 0);
 					dimension.openRegion(0, 0, fileData);
 					const mWorld = new MinecraftWorld(project, "World", ressourecePack, 16);
+					// Older wasm builds only provide the palettes as JSON.
+					const blockStateKeys = BlockStateKeys.create(this._kayo.wasmx);
+					const paletteIds = dimension as typeof dimension & SectionPaletteIds;
 					for (let x = 0; x < 4; x++) {
 						for (let z = 0; z < 4; z++) {
 							const status = dimension.buildChunk(x, z);
 							if (status !== 0) continue;
 
 							for (let y = -4; y < 15; y++) {
-								const palette = JSON.parse(dimension.getPalette(x, y, z)) as PaletteEntry[];
+								const palette =
+									blockStateKeys && paletteIds.getSectionPaletteIds
+										? blockStateKeys.palette(paletteIds.getSectionPaletteIds(x, y, z))
+										: (JSON.parse(dimension.getPalette(x, y, z)) as PaletteEntry[]);
 								let sectionDataView: any = undefined;
 								if (palette.length > 1) sectionDataView = dimension.getSectionView(x, y, z);
 								else if (palette.length === 1 && palette[0].Name == "minecraft:air") continue;
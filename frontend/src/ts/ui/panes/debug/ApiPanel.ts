@@ -11,6 +11,32 @@ function groupBy(array: any[], key: string) {
 	return array.reduce(reduceCallback, {});
 }
 
+type WasmMemoryBindings = {
+	getHeapUsage?: () => { heapSize: number; allocated: number };
+	getMinecraftMemoryUsage?: () => { [subsystem: string]: number };
+};
+
+function formatBytes(bytes: number) {
+	return `${(bytes / (1024 * 1024)).toFixed(2)} MiB`;
+}
+
+function wasmMemoryUsage(wasm: object) {
+	// The bindings are missing in modules built before the heap accounting was added.
+	const bindings = wasm as WasmMemoryBindings;
+	const usage: { [key: string]: any } = {};
+	if (bindings.getHeapUsage) {
+		const heap = bindings.getHeapUsage();
+		usage["Heap Size"] = formatBytes(heap.heapSize);
+		usage.Allocated = formatBytes(heap.allocated);
+	}
+	if (bindings.getMinecraftMemoryUsage) {
+		const minecraft: { [subsystem: string]: string } = {};
+		for (const [subsystem, bytes] of Object.entries(bindings.getMinecraftMemoryUsage())) minecraft[subsystem] = formatBytes(bytes);
+		usage.Minecraft = minecraft;
+	}
+	return usage;
+}
+
 async function checkPermissions() {
 	// eslint-disable-next-line local/no-await
 	const camera = await navigator.permissions.query({ name: "camera" });
@@ -80,6 +106,7 @@ export default class APIPanel extends HTMLElement {
 			},
 			WASM: {
 				memory: this._kayo.wasmx.heap.byteLength,
+				...wasmMemoryUsage(this._kayo.wasmx.wasm),
 			},
 			Audio: {
 				State: `${audioContext.state}`,